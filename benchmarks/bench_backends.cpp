@@ -0,0 +1,84 @@
+#include <cstdlib>
+
+#include "bench_common.h"
+#include "basic_emulator.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// the same core, with the backend calls resolved at compile time
+	using StaticEmulator = BasicEmulator<bench::NullRenderer, bench::NullInput, bench::FixedRandom>;
+
+	// every other instruction reaches a backend: random bytes, key checks and a draw per loop
+	std::vector<uint8_t> BackendLoopRom()
+	{
+		return
+		{
+			0xC0, 0xFF,     // 0x200: RND V0, 0xFF
+			0xC1, 0x1F,     // 0x202: RND V1, 0x1F
+			0xE0, 0x9E,     // 0x204: SKP V0
+			0xE1, 0xA1,     // 0x206: SKNP V1
+			0x72, 0x01,     // 0x208: ADD V2, 0x01
+			0xA3, 0x00,     // 0x20A: LD I, 0x300
+			0xD0, 0x15,     // 0x20C: DRW V0, V1, 5
+			0x12, 0x00,     // 0x20E: JP 0x200
+		};
+	}
+
+	template<typename Core>
+	double Measure(Core& emulator, const Gamefile* gamefile, const DispatchMode mode, const uint64_t instruction_count)
+	{
+		emulator.HardResetEmulator();
+		emulator.SetDispatchMode(mode);
+		emulator.Load(gamefile);
+
+		const uint64_t start_count = emulator.GetInstructionCount();
+		bench::Stopwatch stopwatch;
+		while (emulator.GetInstructionCount() - start_count < instruction_count)
+		{
+			const uint64_t before = emulator.GetInstructionCount();
+			if (!emulator.RunInstructions(100000) || emulator.GetInstructionCount() == before)
+			{
+				printf("rom stopped on an error or a key wait\n");
+				break;
+			}
+		}
+		const double seconds = stopwatch.ElapsedSeconds();
+		return double(emulator.GetInstructionCount() - start_count) / seconds;
+	}
+}
+
+// usage: Chip8BenchBackends [instruction_count] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint64_t instruction_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000ull;
+	const std::vector<uint8_t> rom = argc > 2 ? bench::ReadRom(argv[2]) : BackendLoopRom();
+	if (rom.empty())
+	{
+		printf("unable to read rom\n");
+		return -1;
+	}
+
+	EmulatorImpl dynamic_emulator(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom());
+	StaticEmulator static_emulator(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom());
+	Gamefile* gamefile = bench::MakeGamefile(rom);
+
+	const std::pair<DispatchMode, const char*> modes[] =
+	{
+		{ DispatchMode::Switch, "switch" },
+		{ DispatchMode::Threaded, "computed goto" },
+		{ DispatchMode::Block, "basic blocks" },
+	};
+	for (const auto& [mode, name] : modes)
+	{
+		const double dynamic_rate = Measure(dynamic_emulator, gamefile, mode, instruction_count);
+		const double static_rate = Measure(static_emulator, gamefile, mode, instruction_count);
+
+		printf("%-16s virtual %8.2f Minstr/s   static %8.2f Minstr/s   speedup %.2fx\n",
+			name, dynamic_rate / 1e6, static_rate / 1e6, static_rate / dynamic_rate);
+	}
+
+	delete gamefile;
+	return 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "gamefile.h"
+#include "iinput_command.h"
+#include "irandom_generator.h"
+#include "renderer.h"
+
+namespace chipotto::bench
+{
+	// renderer that keeps nothing, so the numbers only measure the core
+	// the backends are final, so a BasicEmulator instantiated with them calls them directly
+	class NullRenderer final : public EmuRenderer
+	{
+	public:
+		NullRenderer() : EmuRenderer(64, 32) {}
+
+		virtual void DrawFrame(const Framebuffer& /*rows*/) override {}
+		virtual bool IsValid() override { return true; }
+	};
+
+	class NullInput final : public IInputCommand
+	{
+	public:
+		virtual const uint8_t* GetKeyboardState() override { return nullptr; }
+		virtual bool IsInputPending() override { return false; }
+		virtual EmuKey GetKey() override { return EmuKey::K_NONE; }
+		virtual bool IsKeyPressed(const EmuKey /*key*/) override { return false; }
+		virtual InputType GetInputEventType() override { return InputType::NONE; }
+	};
+
+	class FixedRandom final : public IRandomGenerator
+	{
+	public:
+		virtual uint8_t GetRandomByte() override { return State = State * 37 + 11; }
+
+	private:
+		uint8_t State = 0;
+	};
+
+	// ALU, skips, calls and I arithmetic looping forever, no drawing involved
+	inline std::vector<uint8_t> ComputeLoopRom()
+	{
+		return
+		{
+			0x6A, 0x00,     // 0x200: LD VA, 0x00
+			0x6B, 0x01,     // 0x202: LD VB, 0x01
+			0xA3, 0x00,     // 0x204: LD I, 0x300
+			0x7A, 0x01,     // 0x206: ADD VA, 0x01
+			0x8A, 0xB4,     // 0x208: ADD VA, VB
+			0x8C, 0xA0,     // 0x20A: LD VC, VA
+			0x8C, 0x06,     // 0x20C: SHR VC
+			0x8C, 0xB5,     // 0x20E: SUB VC, VB
+			0x8D, 0xC3,     // 0x210: XOR VD, VC
+			0x3D, 0x00,     // 0x212: SE VD, 0x00
+			0x8D, 0xA1,     // 0x214: OR VD, VA
+			0x22, 0x20,     // 0x216: CALL 0x220
+			0xFB, 0x1E,     // 0x218: ADD I, VB
+			0x4A, 0x00,     // 0x21A: SNE VA, 0x00
+			0xA3, 0x00,     // 0x21C: LD I, 0x300
+			0x12, 0x06,     // 0x21E: JP 0x206
+			0x8E, 0xA2,     // 0x220: AND VE, VA
+			0x8E, 0x0E,     // 0x222: SHL VE
+			0x9A, 0xB0,     // 0x224: SNE VA, VB
+			0x6E, 0x00,     // 0x226: LD VE, 0x00
+			0x00, 0xEE,     // 0x228: RET
+		};
+	}
+
+	inline std::vector<uint8_t> ReadRom(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// copies the rom into a Gamefile owned by the caller
+	inline Gamefile* MakeGamefile(const std::vector<uint8_t>& rom)
+	{
+		Gamefile* gamefile = new Gamefile(rom.size());
+		memcpy(gamefile->bytecode, rom.data(), rom.size());
+		return gamefile;
+	}
+
+	class Stopwatch
+	{
+	public:
+		Stopwatch() : Start(std::chrono::steady_clock::now()) {}
+
+		inline double ElapsedSeconds() const
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point Start;
+	};
+
+	inline void PrintRate(const char* label, const double count, const double seconds, const char* unit)
+	{
+		printf("%-28s %10.2f M%s/s  (%.3f s)\n", label, count / seconds / 1e6, unit, seconds);
+	}
+}
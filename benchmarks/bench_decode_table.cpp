@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <random>
+#include <set>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+
+using namespace chipotto;
+
+namespace
+{
+	constexpr size_t CacheLineSize = 64;
+
+	// straight-line ALU code over every register pair and immediate, so nearly every opcode hits its own table line
+	std::vector<uint8_t> WideRom(const size_t instruction_count)
+	{
+		std::mt19937 rng(0xC8);
+		std::vector<uint8_t> rom;
+		for (size_t i = 0; i < instruction_count; ++i)
+		{
+			static const uint16_t alu[] = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE };
+			const uint16_t x = rng() % 0x10;
+			const uint16_t y = rng() % 0x10;
+			uint16_t opcode = 0;
+			switch (rng() % 3)
+			{
+			case 0: opcode = 0x6000 | (x << 8) | (rng() & 0xFF); break;
+			case 1: opcode = 0x7000 | (x << 8) | (rng() & 0xFF); break;
+			default: opcode = 0x8000 | (x << 8) | (y << 4) | alu[rng() % 9]; break;
+			}
+			rom.push_back(opcode >> 8);
+			rom.push_back(opcode & 0xFF);
+		}
+		rom.push_back(0x12);
+		rom.push_back(0x00);
+		return rom;
+	}
+
+	// cache lines of the opcode table the ROM can reach, assuming every even-aligned word is code
+	size_t TouchedTableLines(const std::vector<uint8_t>& rom)
+	{
+		std::set<size_t> lines;
+		for (size_t i = 0; i + 1 < rom.size(); i += 2)
+		{
+			const uint16_t opcode = (rom[i] << 8) | rom[i + 1];
+			lines.insert(opcode * sizeof(void*) / CacheLineSize);
+		}
+		return lines.size();
+	}
+}
+
+// usage: Chip8BenchDecodeTable [instruction_count] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint64_t instruction_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000ull;
+
+	struct Workload
+	{
+		const char* label;
+		std::vector<uint8_t> rom;
+	};
+	std::vector<Workload> workloads;
+	workloads.push_back({ "compute loop", bench::ComputeLoopRom() });
+	workloads.push_back({ "wide alu", WideRom(1700) });
+	if (argc > 2)
+	{
+		workloads.push_back({ argv[2], bench::ReadRom(argv[2]) });
+	}
+
+	EmulatorImpl emulator(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom());
+	emulator.SetDispatchMode(DispatchMode::Specialized);
+	if (emulator.GetDispatchMode() != DispatchMode::Specialized)
+	{
+		printf("built without CHIP8_CONSTEXPR_DECODE, nothing to compare\n");
+		return 0;
+	}
+	printf("opcode table: %zu KiB, %zu lines\n", EmulatorImpl::GetSpecializedTableSize() / 1024,
+		EmulatorImpl::GetSpecializedTableSize() / CacheLineSize);
+
+	const uint32_t chunk = 100000;
+	for (const Workload& workload : workloads)
+	{
+		if (workload.rom.empty())
+		{
+			printf("%s: unable to read rom\n", workload.label);
+			continue;
+		}
+
+		const size_t touched = TouchedTableLines(workload.rom);
+		printf("\n%s: %zu instructions, table lines reachable %zu (%zu bytes), decode cache %zu bytes\n", workload.label,
+			workload.rom.size() / 2, touched, touched * CacheLineSize, workload.rom.size() / 2 * sizeof(DecodedInstruction));
+
+		Gamefile* gamefile = bench::MakeGamefile(workload.rom);
+		const DispatchMode modes[] = { DispatchMode::Switch, DispatchMode::Specialized };
+		double seconds[2] = {};
+		for (int mode_index = 0; mode_index < 2; ++mode_index)
+		{
+			emulator.HardResetEmulator();
+			emulator.SetDispatchMode(modes[mode_index]);
+			emulator.Load(gamefile);
+			emulator.RunInstructions(chunk);
+
+			bench::Stopwatch stopwatch;
+			for (uint64_t executed = 0; executed < instruction_count; executed += chunk)
+			{
+				if (!emulator.RunInstructions(chunk))
+				{
+					printf("rom stopped on an error\n");
+					break;
+				}
+			}
+			seconds[mode_index] = stopwatch.ElapsedSeconds();
+			bench::PrintRate(mode_index == 0 ? "  switch + decode cache" : "  constexpr opcode table", double(instruction_count), seconds[mode_index], "instr");
+		}
+		printf("  table speedup: %.2fx\n", seconds[0] / seconds[1]);
+		delete gamefile;
+	}
+	return 0;
+}
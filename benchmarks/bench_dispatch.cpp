@@ -0,0 +1,89 @@
+#include <cstdlib>
+#include <iterator>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+
+using namespace chipotto;
+
+// usage: Chip8BenchDispatch [instruction_count] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint64_t instruction_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000000ull;
+	const std::vector<uint8_t> rom = argc > 2 ? bench::ReadRom(argv[2]) : bench::ComputeLoopRom();
+	if (rom.empty())
+	{
+		printf("unable to read rom\n");
+		return -1;
+	}
+
+	EmulatorImpl emulator(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom());
+	Gamefile* gamefile = bench::MakeGamefile(rom);
+
+	const struct
+	{
+		DispatchMode mode;
+		const char* label;
+	} engines[] =
+	{
+		{ DispatchMode::Table, "std::function table" },
+		{ DispatchMode::Switch, "switch" },
+		{ DispatchMode::Threaded, "computed goto" },
+		{ DispatchMode::Block, "basic blocks" },
+		{ DispatchMode::Jit, "x86-64 jit" },
+	};
+	double seconds[std::size(engines)] = {};
+
+	const uint32_t chunk = 100000;
+	for (size_t engine_index = 0; engine_index < std::size(engines); ++engine_index)
+	{
+		const auto& engine = engines[engine_index];
+		emulator.HardResetEmulator();
+		emulator.SetDispatchMode(engine.mode);
+		if (emulator.GetDispatchMode() != engine.mode)
+		{
+			printf("%s: not available in this build\n", engine.label);
+			continue;
+		}
+		emulator.Load(gamefile);
+		emulator.RunInstructions(chunk);
+
+		bench::Stopwatch stopwatch;
+		for (uint64_t executed = 0; executed < instruction_count; executed += chunk)
+		{
+			if (!emulator.RunInstructions(chunk))
+			{
+				printf("%s: rom stopped on an error\n", engine.label);
+				break;
+			}
+		}
+		seconds[engine_index] = stopwatch.ElapsedSeconds();
+		bench::PrintRate(engine.label, double(instruction_count), seconds[engine_index], "instr");
+	}
+	if (seconds[4] > 0.0)
+	{
+		printf("jit speedup: %.2fx over switch, %.2fx over basic blocks\n", seconds[1] / seconds[4], seconds[3] / seconds[4]);
+	}
+
+	// Tick pays for the timers and the input poll once per call, which is once per block in Block mode
+	const uint64_t tick_instruction_count = instruction_count / 10;
+	const DispatchMode tick_modes[] = { DispatchMode::Threaded, DispatchMode::Block };
+	for (const DispatchMode mode : tick_modes)
+	{
+		emulator.HardResetEmulator();
+		emulator.SetDispatchMode(mode);
+		emulator.Load(gamefile);
+
+		const uint64_t start_count = emulator.GetInstructionCount();
+		bench::Stopwatch stopwatch;
+		while (emulator.GetInstructionCount() - start_count < tick_instruction_count)
+		{
+			emulator.Tick(0.0f);
+		}
+		bench::PrintRate(mode == DispatchMode::Block ? "Tick, basic blocks" : "Tick, computed goto",
+			double(emulator.GetInstructionCount() - start_count), stopwatch.ElapsedSeconds(), "instr");
+	}
+
+	delete gamefile;
+	return 0;
+}
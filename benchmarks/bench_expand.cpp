@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "bench_common.h"
+#include "runner/rgba_expander.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// what SDLEmuRenderer did before the expander: one test and one store per pixel, then the same for every scaled pixel
+	void ExpandPerPixel(const Framebuffer& rows, const uint32_t scale, const uint32_t on, const uint32_t off, uint32_t* pixels)
+	{
+		const uint32_t width = 64 * scale;
+		for (uint32_t y = 0; y < 32 * scale; ++y)
+		{
+			const uint64_t row = rows[y / scale];
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				pixels[size_t(y) * width + x] = (row >> (63 - x / scale)) & 1 ? on : off;
+			}
+		}
+	}
+
+	Framebuffer NoiseFrame(uint64_t state)
+	{
+		Framebuffer rows{};
+		for (uint64_t& row : rows)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			row = state;
+		}
+		return rows;
+	}
+}
+
+// usage: Chip8BenchExpand [frame_count]
+int main(int argc, char** argv)
+{
+	const uint32_t frame_count = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 20000;
+	const uint32_t on = PackRgba(0xFF, 0xFF, 0xFF, 0xFF);
+	const uint32_t off = PackRgba(0x00, 0x00, 0x00, 0xFF);
+	// a few different frames, so the branches of the per-pixel loop cannot learn one of them
+	const std::vector<Framebuffer> frames = { NoiseFrame(1), NoiseFrame(2), NoiseFrame(3), NoiseFrame(4) };
+	printf("expander compiled for %s, %u frames per run\n", RgbaExpander::GetInstructionSet(), frame_count);
+
+	for (const uint32_t scale : { 1u, 4u, 10u })
+	{
+		RgbaExpander expander(on, off, scale);
+		std::vector<uint32_t> expected(size_t(expander.GetWidth()) * expander.GetHeight());
+		std::vector<uint32_t> pixels(expected.size());
+		// fewer frames at the bigger scales, so every run takes about as long
+		const uint32_t runs = std::max(1u, frame_count / (scale * scale));
+		const double pixel_count = double(runs) * double(pixels.size());
+
+		bench::Stopwatch per_pixel_watch;
+		for (uint32_t run = 0; run < runs; ++run)
+		{
+			ExpandPerPixel(frames[run % frames.size()], scale, on, off, expected.data());
+		}
+		const double per_pixel_seconds = per_pixel_watch.ElapsedSeconds();
+
+		bench::Stopwatch expander_watch;
+		for (uint32_t run = 0; run < runs; ++run)
+		{
+			expander.Expand(frames[run % frames.size()], pixels.data(), size_t(expander.GetWidth()) * 4);
+		}
+		const double expander_seconds = expander_watch.ElapsedSeconds();
+
+		if (pixels != expected)
+		{
+			printf("scale %u: the expander and the per-pixel loop disagree\n", scale);
+			return -1;
+		}
+
+		char label[64];
+		snprintf(label, sizeof(label), "per pixel, %ux", scale);
+		bench::PrintRate(label, pixel_count, per_pixel_seconds, "pixels");
+		snprintf(label, sizeof(label), "%s, %ux", RgbaExpander::GetInstructionSet(), scale);
+		bench::PrintRate(label, pixel_count, expander_seconds, "pixels");
+		printf("%-28s %10.2fx of the per-pixel loop\n", "", per_pixel_seconds / expander_seconds);
+	}
+	return 0;
+}
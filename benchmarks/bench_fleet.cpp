@@ -0,0 +1,73 @@
+#include <cstdlib>
+#include <thread>
+
+#include "bench_common.h"
+#include "runner/fleet.h"
+
+using namespace chipotto;
+
+// usage: Chip8BenchFleet [job_count] [frame_count] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint32_t job_count = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 256;
+	const uint32_t frame_count = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 600;
+	const std::vector<uint8_t> rom = argc > 3 ? bench::ReadRom(argv[3]) : bench::ComputeLoopRom();
+	if (rom.empty() || job_count == 0)
+	{
+		printf("unable to read rom\n");
+		return -1;
+	}
+
+	Gamefile* gamefile = bench::MakeGamefile(rom);
+	// uneven jobs, from a tenth of the frames to all of them, so the workers have to steal to finish together
+	std::vector<FleetJob> jobs(job_count);
+	uint64_t frames = 0;
+	for (uint32_t i = 0; i < job_count; ++i)
+	{
+		jobs[i].Game = gamefile;
+		jobs[i].Frames = std::max(1u, frame_count * (1 + (i * 7) % 10) / 10);
+		jobs[i].InstructionsPerFrame = 1000;
+		jobs[i].Seed = i;
+		frames += jobs[i].Frames;
+	}
+
+	const uint32_t core_count = std::max(1u, std::thread::hardware_concurrency());
+	printf("%u jobs, %llu frames of 1000 instructions, %u hardware threads\n", job_count, static_cast<unsigned long long>(frames), core_count);
+
+	// powers of two up to the hardware threads, and all of them
+	std::vector<uint32_t> worker_counts;
+	for (uint32_t worker_count = 1; worker_count < core_count; worker_count *= 2)
+	{
+		worker_counts.push_back(worker_count);
+	}
+	worker_counts.push_back(core_count);
+
+	double single_seconds = 0.0;
+	for (const uint32_t worker_count : worker_counts)
+	{
+		for (const bool pin : { false, true })
+		{
+			Chip8Fleet fleet({ worker_count, pin });
+			bench::Stopwatch stopwatch;
+			const std::vector<FleetResult> results = fleet.Run(jobs);
+			const double seconds = stopwatch.ElapsedSeconds();
+
+			uint64_t cycles = 0;
+			for (const FleetResult& result : results)
+			{
+				cycles += result.Cycles;
+			}
+			if (worker_count == 1 && !pin)
+			{
+				single_seconds = seconds;
+			}
+			char label[64];
+			snprintf(label, sizeof(label), "%u workers%s", worker_count, pin ? ", pinned" : "");
+			bench::PrintRate(label, double(cycles), seconds, "cycles");
+			printf("%-28s %10.2fx of one worker, %llu jobs stolen\n", "", single_seconds / seconds, static_cast<unsigned long long>(fleet.GetStolenJobs()));
+		}
+	}
+
+	delete gamefile;
+	return 0;
+}
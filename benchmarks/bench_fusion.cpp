@@ -0,0 +1,100 @@
+#include <cstdlib>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// the idioms the decoder fuses, in a loop that never draws anything visible
+	std::vector<uint8_t> IdiomLoopRom()
+	{
+		return
+		{
+			0x63, 0x02,     // 0x200: LD V3, 0x02
+			0xF3, 0x1E,     // 0x202: ADD I, V3
+			0xA3, 0x00,     // 0x204: LD I, 0x300
+			0xD0, 0x11,     // 0x206: DRW V0, V1, 1
+			0xF4, 0x07,     // 0x208: LD V4, DT
+			0x34, 0x00,     // 0x20A: SE V4, 0x00
+			0x12, 0x08,     // 0x20C: JP 0x208
+			0x75, 0x01,     // 0x20E: ADD V5, 0x01
+			0x45, 0x00,     // 0x210: SNE V5, 0x00
+			0x12, 0x00,     // 0x212: JP 0x200
+			0x35, 0x00,     // 0x214: SE V5, 0x00
+			0x12, 0x00,     // 0x216: JP 0x200
+			0x12, 0x00,     // 0x218: JP 0x200
+		};
+	}
+
+	const char* FusionName(const Instruction fused)
+	{
+		switch (fused)
+		{
+		case Instruction::LD_VX_BYTE_ADD_I_VY: return "6XNN + FY1E";
+		case Instruction::LD_I_ADDR_DRW: return "ANNN + DXYN";
+		case Instruction::SE_VX_BYTE_JP: return "3XNN + 1NNN";
+		case Instruction::SNE_VX_BYTE_JP: return "4XNN + 1NNN";
+		case Instruction::LD_VX_DT_SE_JP: return "FX07 + 3XNN + 1NNN";
+		default: return "?";
+		}
+	}
+}
+
+// usage: Chip8BenchFusion [instruction_count] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint64_t instruction_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000ull;
+	const std::vector<uint8_t> rom = argc > 2 ? bench::ReadRom(argv[2]) : IdiomLoopRom();
+	if (rom.empty())
+	{
+		printf("unable to read rom\n");
+		return -1;
+	}
+
+	EmulatorImpl emulator(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom());
+	Gamefile* gamefile = bench::MakeGamefile(rom);
+
+	const DispatchMode modes[] = { DispatchMode::Switch, DispatchMode::Threaded };
+	for (const DispatchMode mode : modes)
+	{
+		double seconds[2] = {};
+		for (const bool fusion : { false, true })
+		{
+			emulator.HardResetEmulator();
+			emulator.SetDispatchMode(mode);
+			emulator.SetFusionEnabled(fusion);
+			emulator.Load(gamefile);
+
+			// counted in instructions, a fused dispatch retires several
+			const uint64_t start_count = emulator.GetInstructionCount();
+			bench::Stopwatch stopwatch;
+			while (emulator.GetInstructionCount() - start_count < instruction_count)
+			{
+				const uint64_t before = emulator.GetInstructionCount();
+				if (!emulator.RunInstructions(100000) || emulator.GetInstructionCount() == before)
+				{
+					printf("rom stopped on an error or a key wait\n");
+					break;
+				}
+			}
+			seconds[fusion] = stopwatch.ElapsedSeconds();
+
+			char label[64];
+			snprintf(label, sizeof(label), "%s, fusion %s", mode == DispatchMode::Switch ? "switch" : "computed goto", fusion ? "on" : "off");
+			bench::PrintRate(label, double(emulator.GetInstructionCount() - start_count), seconds[fusion], "instr");
+		}
+		printf("  fusion speedup: %.2fx\n", seconds[0] / seconds[1]);
+	}
+
+	printf("\nfusions fired in the last run:\n");
+	for (uint8_t id = FirstFusedInstruction; id < static_cast<uint8_t>(Instruction::Count); ++id)
+	{
+		const Instruction fused = static_cast<Instruction>(id);
+		printf("  %-20s %llu\n", FusionName(fused), static_cast<unsigned long long>(emulator.GetFusionHits(fused)));
+	}
+
+	delete gamefile;
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include <cstdlib>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// a game frame loop: a little work, then a wait on the delay timer for the next frame
+	std::vector<uint8_t> FrameWaitRom()
+	{
+		return
+		{
+			0x60, 0x01,     // 0x200: LD V0, 0x01
+			0xF0, 0x15,     // 0x202: LD DT, V0
+			0x71, 0x01,     // 0x204: ADD V1, 0x01
+			0x82, 0x14,     // 0x206: ADD V2, V1
+			0xF3, 0x07,     // 0x208: LD V3, DT
+			0x33, 0x00,     // 0x20A: SE V3, 0x00
+			0x12, 0x08,     // 0x20C: JP 0x208
+			0x12, 0x00,     // 0x20E: JP 0x200
+		};
+	}
+}
+
+// usage: Chip8BenchIdle [cycle_count] [instructions_per_frame] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint64_t cycle_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000000ull;
+	const uint32_t instructions_per_frame = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1000u;
+	const std::vector<uint8_t> rom = argc > 3 ? bench::ReadRom(argv[3]) : FrameWaitRom();
+	if (rom.empty())
+	{
+		printf("unable to read rom\n");
+		return -1;
+	}
+
+	EmulatorImpl emulator(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom());
+	Gamefile* gamefile = bench::MakeGamefile(rom);
+
+	double seconds[2] = {};
+	for (const bool skip : { false, true })
+	{
+		emulator.HardResetEmulator();
+		emulator.SetIdleSkipEnabled(skip);
+		emulator.SetInstructionsPerFrame(instructions_per_frame);
+		emulator.Load(gamefile);
+
+		// counted in emulated cycles, the skipped ones are never executed
+		const uint64_t start_count = emulator.GetInstructionCount();
+		bench::Stopwatch stopwatch;
+		while (emulator.GetCycles() < cycle_count)
+		{
+			const RunStatus status = emulator.RunCycles(100000);
+			if (status != RunStatus::FrameDone)
+			{
+				printf("rom stopped on an error or a key wait\n");
+				break;
+			}
+		}
+		seconds[skip] = stopwatch.ElapsedSeconds();
+
+		bench::PrintRate(skip ? "idle skip on" : "idle skip off", double(emulator.GetCycles()), seconds[skip], "cycles");
+		printf("  executed %llu instructions for %llu cycles\n", static_cast<unsigned long long>(emulator.GetInstructionCount() - start_count),
+			static_cast<unsigned long long>(emulator.GetCycles()));
+	}
+	printf("  idle skip speedup: %.2fx\n", seconds[0] / seconds[1]);
+
+	delete gamefile;
+	return 0;
+}
@@ -0,0 +1,102 @@
+#include <cstdlib>
+#include <latch>
+#include <memory>
+#include <thread>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// short slices, so every instance is evicted by the others before it runs again
+	constexpr uint32_t SliceLength = 32;
+
+	std::vector<std::unique_ptr<EmulatorImpl>> MakeInstances(const Gamefile* gamefile, const size_t instance_count)
+	{
+		std::vector<std::unique_ptr<EmulatorImpl>> emulators;
+		for (size_t i = 0; i < instance_count; ++i)
+		{
+			emulators.push_back(std::make_unique<EmulatorImpl>(new bench::NullRenderer(), new bench::NullInput(), new bench::FixedRandom()));
+			emulators.back()->SetDispatchMode(DispatchMode::Threaded);
+			emulators.back()->Load(gamefile);
+		}
+		return emulators;
+	}
+
+	// runs the emulators in turn until they retired instruction_count instructions between them
+	uint64_t RunInstances(std::vector<std::unique_ptr<EmulatorImpl>>& emulators, const uint64_t instruction_count)
+	{
+		uint64_t executed = 0;
+		while (executed < instruction_count)
+		{
+			for (std::unique_ptr<EmulatorImpl>& emulator : emulators)
+			{
+				const uint64_t before = emulator->GetInstructionCount();
+				emulator->RunInstructions(SliceLength);
+				executed += emulator->GetInstructionCount() - before;
+			}
+		}
+		return executed;
+	}
+}
+
+// usage: Chip8BenchInstances [instruction_count] [thread_count] [rom_path]
+int main(int argc, char** argv)
+{
+	const uint64_t instruction_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000ull;
+	const unsigned thread_count = argc > 2 ? static_cast<unsigned>(strtoul(argv[2], nullptr, 10)) : std::max(1u, std::thread::hardware_concurrency());
+	const std::vector<uint8_t> rom = argc > 3 ? bench::ReadRom(argv[3]) : bench::ComputeLoopRom();
+	if (rom.empty() || thread_count == 0)
+	{
+		printf("unable to read rom\n");
+		return -1;
+	}
+
+	Gamefile* gamefile = bench::MakeGamefile(rom);
+	printf("EmulatorImpl: %zu bytes, %u threads, %u instructions per slice\n", sizeof(EmulatorImpl), thread_count, SliceLength);
+
+	for (const size_t instance_count : { 1, 16, 256, 1024, 4096 })
+	{
+		// every thread owns its share of the instances, nothing is shared while running
+		const size_t per_thread = std::max<size_t>(1, instance_count / thread_count);
+		std::vector<uint64_t> executed(thread_count);
+		std::vector<std::vector<std::unique_ptr<EmulatorImpl>>> instances(thread_count);
+		std::vector<std::thread> threads;
+
+		// each thread builds its instances on its own, and the clock starts once all of them are loaded
+		std::latch ready(thread_count);
+		std::latch start(1);
+		for (unsigned t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]()
+			{
+				instances[t] = MakeInstances(gamefile, per_thread);
+				ready.count_down();
+				start.wait();
+				executed[t] = RunInstances(instances[t], instruction_count / thread_count);
+			});
+		}
+		ready.wait();
+		bench::Stopwatch stopwatch;
+		start.count_down();
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		const double seconds = stopwatch.ElapsedSeconds();
+
+		uint64_t total = 0;
+		for (const uint64_t count : executed)
+		{
+			total += count;
+		}
+		char label[64];
+		snprintf(label, sizeof(label), "%zu instances", per_thread * thread_count);
+		bench::PrintRate(label, double(total), seconds, "instr");
+	}
+
+	delete gamefile;
+	return 0;
+}
@@ -0,0 +1,124 @@
+#include <array>
+#include <cstdlib>
+#include <memory>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+#include "lockstep/lockstep_emulator.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// a different sequence per lane, so the lanes of the branchy ROM drift apart
+	class LaneRandom final : public IRandomGenerator
+	{
+	public:
+		explicit LaneRandom(const uint32_t seed) : State(seed * 2654435761u + 1) {}
+		virtual uint8_t GetRandomByte() override
+		{
+			State = State * 1664525u + 1013904223u;
+			return static_cast<uint8_t>(State >> 24);
+		}
+
+	private:
+		uint32_t State;
+	};
+
+	// the compute loop behind a random branch, taken by a different subset of lanes every iteration
+	std::vector<uint8_t> BranchyRom()
+	{
+		std::vector<uint8_t> rom = bench::ComputeLoopRom();
+		rom[0x1E] = 0x12;     // 0x21E: JP 0x22A
+		rom[0x1F] = 0x2A;
+		rom.insert(rom.end(),
+		{
+			0xC0, 0x01,     // 0x22A: RND V0, 0x01
+			0x30, 0x00,     // 0x22C: SE V0, 0x00
+			0x71, 0x03,     // 0x22E: ADD V1, 0x03
+			0x81, 0x14,     // 0x230: ADD V1, V1
+			0x12, 0x06,     // 0x232: JP 0x206
+		});
+		return rom;
+	}
+
+	template<size_t Lanes>
+	void RunLanes(const char* rom_name, const Gamefile* gamefile, const uint32_t frame_count, const uint32_t instructions_per_frame)
+	{
+		std::array<IRandomGenerator*, Lanes> generators;
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			generators[lane] = new LaneRandom(static_cast<uint32_t>(lane));
+		}
+		auto lockstep = std::make_unique<LockstepEmulator<Lanes>>(generators);
+		lockstep->SetInstructionsPerFrame(instructions_per_frame);
+		lockstep->Load(gamefile);
+
+		bench::Stopwatch lockstep_watch;
+		for (uint32_t frame = 0; frame < frame_count; ++frame)
+		{
+			lockstep->RunFrame();
+		}
+		const double lockstep_seconds = lockstep_watch.ElapsedSeconds();
+
+		// the same machines one after the other, each frame on every instance in turn
+		std::vector<std::unique_ptr<EmulatorImpl>> cores;
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			cores.push_back(std::make_unique<EmulatorImpl>(new HeadlessRenderer(), new RunnerInput(), new LaneRandom(static_cast<uint32_t>(lane))));
+			cores.back()->SetDispatchMode(DispatchMode::Table);
+			cores.back()->SetInstructionsPerFrame(instructions_per_frame);
+			cores.back()->Load(gamefile);
+		}
+		bench::Stopwatch scalar_watch;
+		for (uint32_t frame = 0; frame < frame_count; ++frame)
+		{
+			for (std::unique_ptr<EmulatorImpl>& core : cores)
+			{
+				core->RunFrame();
+			}
+		}
+		const double scalar_seconds = scalar_watch.ElapsedSeconds();
+
+		uint64_t scalar_instructions = 0;
+		for (std::unique_ptr<EmulatorImpl>& core : cores)
+		{
+			scalar_instructions += core->GetCycles();
+		}
+
+		char label[64];
+		snprintf(label, sizeof(label), "%s, %zu lanes", rom_name, Lanes);
+		bench::PrintRate(label, double(lockstep->GetLaneInstructionCount()), lockstep_seconds, "instr");
+		snprintf(label, sizeof(label), "%s, %zu x Table", rom_name, Lanes);
+		bench::PrintRate(label, double(scalar_instructions), scalar_seconds, "instr");
+		// utilization is the share of the lanes that retired an instruction on an average step
+		const double lanes_per_step = double(lockstep->GetLaneInstructionCount()) / double(lockstep->GetStepCount());
+		printf("%-28s %10.2fx of Table, %.1f of %zu lanes per step\n", "",
+			(lockstep->GetLaneInstructionCount() / lockstep_seconds) / (scalar_instructions / scalar_seconds), lanes_per_step, Lanes);
+	}
+}
+
+// usage: Chip8BenchLockstep [frame_count] [instructions_per_frame]
+int main(int argc, char** argv)
+{
+	const uint32_t frame_count = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 2000;
+	const uint32_t instructions_per_frame = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1000;
+
+	printf("%u frames of %u instructions, lane operations %s\n", frame_count, instructions_per_frame,
+		LockstepEmulator<32>::UsesAvx2() ? "on AVX2" : "in plain loops");
+
+	Gamefile* converged = bench::MakeGamefile(bench::ComputeLoopRom());
+	Gamefile* branchy = bench::MakeGamefile(BranchyRom());
+	RunLanes<8>("compute", converged, frame_count, instructions_per_frame);
+	RunLanes<16>("compute", converged, frame_count, instructions_per_frame);
+	RunLanes<32>("compute", converged, frame_count, instructions_per_frame);
+	RunLanes<8>("branchy", branchy, frame_count, instructions_per_frame);
+	RunLanes<16>("branchy", branchy, frame_count, instructions_per_frame);
+	RunLanes<32>("branchy", branchy, frame_count, instructions_per_frame);
+
+	delete converged;
+	delete branchy;
+	return 0;
+}
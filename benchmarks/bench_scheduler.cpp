@@ -0,0 +1,133 @@
+#include <cstdlib>
+#include <memory>
+
+#include "bench_common.h"
+#include "emulator_impl.h"
+#include "runner/coroutine_scheduler.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+
+using namespace chipotto;
+
+namespace
+{
+	// a menu that waits for a key
+	std::vector<uint8_t> KeyWaitRom()
+	{
+		return
+		{
+			0xF3, 0x0A,     // 0x200: LD V3, K
+			0x12, 0x00,     // 0x202: JP 0x200
+		};
+	}
+
+	// a game loop that works for a frame, then waits 5 frames on the delay timer
+	std::vector<uint8_t> FrameWaitRom()
+	{
+		return
+		{
+			0x60, 0x05,     // 0x200: LD V0, 0x05
+			0xF0, 0x15,     // 0x202: LD DT, V0
+			0x72, 0x01,     // 0x204: ADD V2, 0x01
+			0x83, 0x24,     // 0x206: ADD V3, V2
+			0xF1, 0x07,     // 0x208: LD V1, DT
+			0x31, 0x00,     // 0x20A: SE V1, 0x00
+			0x12, 0x08,     // 0x20C: JP 0x208
+			0x12, 0x00,     // 0x20E: JP 0x200
+		};
+	}
+
+	struct Games
+	{
+		const Gamefile* key_wait;
+		const Gamefile* frame_wait;
+		const Gamefile* busy;
+	};
+
+	// a quarter of the bots sit in a menu, half play a game that waits for the next frame, a quarter never stop computing
+	const Gamefile* MixedFleet(const size_t index, const Games& games)
+	{
+		switch (index % 4)
+		{
+		case 0: return games.key_wait;
+		case 3: return games.busy;
+		default: return games.frame_wait;
+		}
+	}
+
+	// every bot waits in a menu, what is left is the cost of the scheduling itself
+	const Gamefile* MenuFleet(const size_t /*index*/, const Games& games)
+	{
+		return games.key_wait;
+	}
+}
+
+// usage: Chip8BenchScheduler [max_instance_count] [frame_count]
+int main(int argc, char** argv)
+{
+	const size_t max_instance_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+	const uint64_t frame_count = argc > 2 ? strtoull(argv[2], nullptr, 10) : 600;
+
+	Gamefile* key_wait = bench::MakeGamefile(KeyWaitRom());
+	Gamefile* frame_wait = bench::MakeGamefile(FrameWaitRom());
+	Gamefile* busy = bench::MakeGamefile(bench::ComputeLoopRom());
+	const Games games{ key_wait, frame_wait, busy };
+	printf("EmulatorImpl: %zu bytes, %llu frames per run\n", sizeof(EmulatorImpl), static_cast<unsigned long long>(frame_count));
+
+	const struct
+	{
+		const char* name;
+		const Gamefile* (*pick)(const size_t, const Games&);
+	} fleets[] = { { "mixed", MixedFleet }, { "menus", MenuFleet } };
+
+	for (size_t instance_count = 1; instance_count <= max_instance_count; instance_count *= 10)
+	{
+		printf("%zu instances, about %.0f MiB\n", instance_count, double(instance_count) * sizeof(EmulatorImpl) / (1024.0 * 1024.0));
+		for (const auto& fleet : fleets)
+		{
+			double seconds[2] = {};
+			uint64_t resumed = 0;
+			{
+				CoroutineScheduler scheduler;
+				for (size_t i = 0; i < instance_count; ++i)
+				{
+					scheduler.Spawn(fleet.pick(i, games), new bench::FixedRandom());
+				}
+				bench::Stopwatch stopwatch;
+				for (uint64_t frame = 0; frame < frame_count; ++frame)
+				{
+					resumed += scheduler.Tick();
+				}
+				seconds[0] = stopwatch.ElapsedSeconds();
+			}
+
+			// the same bots run round-robin, every instance gets a RunFrame call on every frame
+			{
+				std::vector<std::unique_ptr<EmulatorImpl>> emulators;
+				for (size_t i = 0; i < instance_count; ++i)
+				{
+					emulators.push_back(std::make_unique<EmulatorImpl>(new HeadlessRenderer(), new RunnerInput(), new bench::FixedRandom()));
+					emulators.back()->Load(fleet.pick(i, games));
+				}
+				bench::Stopwatch stopwatch;
+				for (uint64_t frame = 0; frame < frame_count; ++frame)
+				{
+					for (std::unique_ptr<EmulatorImpl>& emulator : emulators)
+					{
+						emulator->RunFrame();
+					}
+				}
+				seconds[1] = stopwatch.ElapsedSeconds();
+			}
+
+			const double instance_frames = double(instance_count) * double(frame_count);
+			printf("  %s: coroutines %8.1f ns, round-robin %8.1f ns per instance and frame, %3.0f%% resumed per frame\n", fleet.name,
+				seconds[0] * 1e9 / instance_frames, seconds[1] * 1e9 / instance_frames, 100.0 * double(resumed) / instance_frames);
+		}
+	}
+
+	delete key_wait;
+	delete frame_wait;
+	delete busy;
+	return 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "export.h"
+#include <cstdint>
+
+#include "emulator_impl.h"
+
+// declares a program generated by Chip8Aot, so it can be handed to SetStaticProgram
+#define CHIP8_DECLARE_STATIC_PROGRAM(Name) \
+	namespace chipotto::aot { extern const chipotto::StaticProgram Name; }
+
+namespace chipotto
+{
+	// the machine state a generated block works on, valid for one ExecuteInstructions call
+	struct CHIP8_API StaticMachine
+	{
+		EmulatorImpl& emulator;
+		uint8_t* V;
+		uint16_t& I;
+		uint16_t& PC;
+		uint8_t& DelayTimer;
+	};
+
+	// runs one basic block that starts at its address, returns the retired status of its terminator
+	using StaticBlockFunction = OpcodeStatus(*)(StaticMachine& machine);
+
+	struct CHIP8_API StaticBlock
+	{
+		uint16_t address;
+		// number of instructions including the terminator
+		uint16_t length;
+		StaticBlockFunction function;
+	};
+
+	/// <summary>
+	/// A ROM translated ahead of time by Chip8Aot.
+	/// The blocks only run while the loaded bytes match rom, anything else is interpreted.
+	/// </summary>
+	struct CHIP8_API StaticProgram
+	{
+		const char* name;
+		const uint8_t* rom;
+		uint16_t rom_size;
+		const StaticBlock* blocks;
+		uint16_t block_count;
+	};
+
+	/// <summary>
+	/// Entry points shared by the generated code and the generator, so both follow the interpreter exactly.
+	/// </summary>
+	class CHIP8_API StaticRuntime
+	{
+	public:
+		// generated blocks are never longer than the interpreter ones, so InvalidateCode covers them
+		static constexpr uint16_t MaxBlockLength = 64;
+
+		static DecodedInstruction Decode(const uint16_t opcode);
+
+		static bool IsBlockTerminator(const Instruction id);
+
+		// executes opcode without touching PC, for body instructions that need the whole emulator
+		static void Execute(StaticMachine& machine, const uint16_t opcode);
+
+		// executes the terminator at address and retires it like the block engine does
+		static OpcodeStatus Terminate(StaticMachine& machine, const uint16_t address, const uint16_t opcode);
+
+		static uint8_t RandomByte(StaticMachine& machine);
+
+		static bool IsKeyPressed(StaticMachine& machine, const uint8_t key);
+	};
+}
@@ -0,0 +1,2064 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
+#include <iostream>
+
+#include "emulator_impl.h"
+#include "aot/static_program.h"
+#include "font.h"
+#include "input_type.h"
+#include "keys.h"
+
+// the member definitions of BasicEmulator, include this instead of emulator_impl.h to instantiate it with your own backends
+
+namespace chipotto
+{
+	template<typename Renderer, typename Input, typename Rng>
+	BasicEmulator<Renderer, Input, Rng>::BasicEmulator(Renderer* renderer, Input* input, Rng* random_generator)
+		: renderer(renderer), input_class(input), random_generator(random_generator)
+	{
+#pragma region OPCODE_BINDINGS
+
+		Opcodes[0x0] = std::bind(&BasicEmulator::Opcode0, this, std::placeholders::_1);
+		Opcodes[0x1] = std::bind(&BasicEmulator::Opcode1, this, std::placeholders::_1);
+		Opcodes[0x2] = std::bind(&BasicEmulator::Opcode2, this, std::placeholders::_1);
+		Opcodes[0x3] = std::bind(&BasicEmulator::Opcode3, this, std::placeholders::_1);
+		Opcodes[0x4] = std::bind(&BasicEmulator::Opcode4, this, std::placeholders::_1);
+		Opcodes[0x5] = std::bind(&BasicEmulator::Opcode5, this, std::placeholders::_1);
+		Opcodes[0x6] = std::bind(&BasicEmulator::Opcode6, this, std::placeholders::_1);
+		Opcodes[0x7] = std::bind(&BasicEmulator::Opcode7, this, std::placeholders::_1);
+		Opcodes[0x8] = std::bind(&BasicEmulator::Opcode8, this, std::placeholders::_1);
+		Opcodes[0x9] = std::bind(&BasicEmulator::Opcode9, this, std::placeholders::_1);
+		Opcodes[0xA] = std::bind(&BasicEmulator::OpcodeA, this, std::placeholders::_1);
+		Opcodes[0xB] = std::bind(&BasicEmulator::OpcodeB, this, std::placeholders::_1);
+		Opcodes[0xC] = std::bind(&BasicEmulator::OpcodeC, this, std::placeholders::_1);
+		Opcodes[0xD] = std::bind(&BasicEmulator::OpcodeD, this, std::placeholders::_1);
+		Opcodes[0xE] = std::bind(&BasicEmulator::OpcodeE, this, std::placeholders::_1);
+		Opcodes[0xF] = std::bind(&BasicEmulator::OpcodeF, this, std::placeholders::_1);
+#pragma endregion //OPCODE_BINDINGS
+
+		SetFonts();
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	BasicEmulator<Renderer, Input, Rng>::~BasicEmulator()
+	{
+		if (renderer)
+		{
+			delete renderer;
+		}
+		if (input_class)
+		{
+			delete input_class;
+		}
+
+		if (random_generator)
+		{
+			delete random_generator;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	bool BasicEmulator<Renderer, Input, Rng>::Load(const Gamefile* gamefile)
+	{
+		memcpy(MemoryMapping.data() + State.PC, gamefile->bytecode, gamefile->size);
+		if (gamefile->size > 0)
+		{
+			InvalidateCode(State.PC, static_cast<uint16_t>(State.PC + gamefile->size - 1));
+		}
+		ActivateStaticProgram();
+		FusionHits.fill(0);
+		return true;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	bool BasicEmulator<Renderer, Input, Rng>::Tick(const float /*deltatime*/)
+	{
+		if (!PollInput())
+			return false;
+
+		if (State.Suspended)
+		{
+			AdvanceClock(1);
+			return true;
+		}
+
+		const uint64_t start_count = InstructionCount;
+		OpcodeStatus status = OpcodeStatus::IncrementPC;
+		InstructionCount += ExecuteInstructions(1, status);
+		AdvanceClock(InstructionCount - start_count);
+		return !IsErrorStatus(status);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	bool BasicEmulator<Renderer, Input, Rng>::RunInstructions(const uint32_t instruction_count)
+	{
+		if (State.Suspended)
+			return true;
+
+		OpcodeStatus status = OpcodeStatus::IncrementPC;
+		InstructionCount += ExecuteInstructions(instruction_count, status);
+		return !IsErrorStatus(status);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	RunStatus BasicEmulator<Renderer, Input, Rng>::RunCycles(const uint32_t cycle_count)
+	{
+		if (!PollInput())
+			return RunStatus::Quit;
+
+		// paying back the last overrun first makes consecutive budgets add up, RunCycles(2 * n) runs like RunCycles(n) twice
+		const uint32_t repaid = std::min(cycle_count, State.OverrunCycles);
+		State.OverrunCycles -= repaid;
+		uint32_t remaining = cycle_count - repaid;
+		while (remaining > 0)
+		{
+			if (IdleSkipEnabled && !State.Suspended)
+			{
+				const uint64_t skipped = SkipIdleLoop(remaining);
+				if (skipped > 0)
+				{
+					IdleCycles += skipped;
+					AdvanceClock(skipped);
+					remaining -= static_cast<uint32_t>(skipped);
+					continue;
+				}
+			}
+
+			// never run across a timer step, so FX07 reads the same value at the same instruction on every run
+			uint32_t slice = std::min(remaining, InstructionsPerFrame - State.CyclesSinceTimerStep);
+			if (IdleSkipEnabled)
+			{
+				// a loop entered mid-slice is caught at the next check
+				slice = std::min(slice, IdleCheckInterval);
+			}
+			uint64_t elapsed = slice;
+			if (!State.Suspended)
+			{
+				const uint64_t start_count = InstructionCount;
+				OpcodeStatus status = OpcodeStatus::IncrementPC;
+				InstructionCount += ExecuteInstructions(slice, status);
+				elapsed = InstructionCount - start_count;
+				if (IsErrorStatus(status))
+				{
+					AdvanceClock(elapsed);
+					return RunStatus::Error;
+				}
+				// a machine that starts waiting idles through the rest of the slice
+				if (State.Suspended)
+				{
+					elapsed = std::max<uint64_t>(elapsed, slice);
+				}
+			}
+			AdvanceClock(elapsed);
+			if (elapsed > remaining)
+			{
+				State.OverrunCycles += static_cast<uint32_t>(elapsed - remaining);
+			}
+			remaining -= static_cast<uint32_t>(std::min<uint64_t>(elapsed, remaining));
+		}
+		return State.Suspended ? RunStatus::WaitingForKey : RunStatus::FrameDone;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	RunStatus BasicEmulator<Renderer, Input, Rng>::RunFrame()
+	{
+		return RunCycles(InstructionsPerFrame);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetInstructionsPerFrame(const uint32_t instructions_per_frame)
+	{
+		InstructionsPerFrame = std::max(instructions_per_frame, 1u);
+		// a shorter period starts counting from its last instruction, the timers step on the next one
+		State.CyclesSinceTimerStep = std::min(State.CyclesSinceTimerStep, InstructionsPerFrame - 1);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	bool BasicEmulator<Renderer, Input, Rng>::PollInput()
+	{
+		while (input_class->IsInputPending())
+		{
+			InputType InputType = input_class->GetInputEventType();
+
+			switch (InputType)
+			{
+			case chipotto::InputType::KEYDOWN:
+				// a key only completes an FX0A that is waiting, presses while running are read by SKP and SKNP
+				if (State.Suspended)
+				{
+					State.Registers[State.WaitForKeyboardRegister_Index] = input_class->GetKey();
+					State.Suspended = false;
+					State.PC += 2;
+				}
+				break;
+			case chipotto::InputType::QUIT:
+				return false;
+			case chipotto::InputType::NONE:
+				break;
+			default:
+				break;
+			}
+		}
+		return true;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::AdvanceClock(const uint64_t cycles)
+	{
+		State.Cycles += cycles;
+		uint64_t since_step = State.CyclesSinceTimerStep + cycles;
+		// a block that ran past the step still steps once per period it covered
+		while (since_step >= InstructionsPerFrame)
+		{
+			StepTimers();
+			since_step -= InstructionsPerFrame;
+		}
+		State.CyclesSinceTimerStep = static_cast<uint32_t>(since_step);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::StepTimers()
+	{
+		if (State.DelayTimer > 0)
+		{
+			State.DelayTimer--;
+		}
+		if (State.SoundTimer > 0)
+		{
+			State.SoundTimer--;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	typename BasicEmulator<Renderer, Input, Rng>::IdleLoop BasicEmulator<Renderer, Input, Rng>::MatchIdleLoop() const
+	{
+		const uint16_t pc = State.PC;
+		if (pc > MemoryMapping.size() - 6)
+			return {};
+
+		// every idle loop starts with a JP, SKP/SKNP or LD VX, DT; anything else is rejected on the first byte
+		const uint16_t first = ReadOpcode(pc);
+		const uint8_t group = first >> 12;
+		if (group != 0x1 && group != 0xE && group != 0xF)
+			return {};
+
+		const uint16_t second = ReadOpcode(pc + 2);
+		const uint16_t third = ReadOpcode(pc + 4);
+		const uint16_t jump_back = 0x1000 | pc;
+		const uint8_t x = (first >> 8) & 0xF;
+
+		// JP to itself
+		if (first == jump_back)
+			return { IdleLoop::Kind::Halt };
+
+		// SKP VX or SKNP VX + JP back
+		if (second == jump_back && group == 0xE && ((first & 0xFF) == 0x9E || (first & 0xFF) == 0xA1))
+			return { IdleLoop::Kind::KeyPoll, x, 0, (first & 0xFF) == 0x9E };
+
+		// LD VX, DT + SE VX, NN + JP back, loops until VX reads NN
+		if (third == jump_back && (first & 0xF0FF) == 0xF007 && (second & 0xF000) == 0x3000 && ((second >> 8) & 0xF) == x)
+			return { IdleLoop::Kind::DelayPoll, x, static_cast<uint8_t>(second & 0xFF) };
+
+		return {};
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	uint64_t BasicEmulator<Renderer, Input, Rng>::SkipIdleLoop(const uint64_t cycle_budget)
+	{
+		const IdleLoop loop = MatchIdleLoop();
+		switch (loop.kind)
+		{
+		case IdleLoop::Kind::Halt:
+			// nothing but time changes until the budget runs out
+			return cycle_budget;
+		case IdleLoop::Kind::KeyPoll:
+		{
+			// the keys only change between calls
+			const bool pressed = input_class->IsKeyPressed(INT_AS_KEY(State.Registers[loop.x]));
+			return pressed != loop.waits_for_press ? cycle_budget - cycle_budget % 2 : 0;
+		}
+		case IdleLoop::Kind::DelayPoll:
+		{
+			const uint64_t period = InstructionsPerFrame;
+			const uint64_t phase = State.CyclesSinceTimerStep;
+			const uint64_t max_iterations = cycle_budget / 3;
+
+			// iteration i reads DT after (phase + 3 * i) / period timer steps
+			auto delay_read = [&](const uint64_t iteration) -> uint8_t
+			{
+				const uint64_t steps = (phase + 3 * iteration) / period;
+				return steps < State.DelayTimer ? static_cast<uint8_t>(State.DelayTimer - steps) : 0;
+			};
+
+			// walks one timer step at a time, the iterations in between all read the same value
+			uint64_t iterations = 0;
+			while (iterations < max_iterations)
+			{
+				const uint8_t value = delay_read(iterations);
+				if (value == loop.nn)
+					break;
+				if (value == 0)
+				{
+					// DT stays 0 and never matches, the loop idles through the budget
+					iterations = max_iterations;
+					break;
+				}
+				const uint64_t next_step = ((phase + 3 * iterations) / period + 1) * period;
+				iterations = std::min(max_iterations, (next_step - phase + 2) / 3);
+			}
+
+			if (iterations == 0)
+				return 0;
+			State.Registers[loop.x] = delay_read(iterations - 1);
+			return iterations * 3;
+		}
+		default:
+			return 0;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::GetIdleFrames() const
+	{
+		if (State.Suspended)
+			return 0;
+
+		const IdleLoop loop = MatchIdleLoop();
+		switch (loop.kind)
+		{
+		case IdleLoop::Kind::Halt:
+			return IdleForever;
+		case IdleLoop::Kind::DelayPoll:
+			// DT never climbs back up to NN, and stays on 0 once there
+			if (State.DelayTimer < loop.nn)
+				return IdleForever;
+			// DT steps at the end of every frame and the loop ends on the frame it reads NN; when a block ran past the end of
+			// the last frame the steps fall inside the frames instead, and the frame that reads NN early is left out
+			if (State.CyclesSinceTimerStep == 0 && State.OverrunCycles == 0)
+				return State.DelayTimer - loop.nn;
+			return State.DelayTimer - loop.nn > 1 ? State.DelayTimer - loop.nn - 1 : 0;
+		default:
+			return 0;
+		}
+	}
+
+#pragma region Dispatch
+
+	namespace detail
+	{
+		inline uint8_t OperandX(const uint16_t opcode) { return (opcode >> 8) & 0xF; }
+		inline uint8_t OperandY(const uint16_t opcode) { return (opcode >> 4) & 0xF; }
+		inline uint8_t OperandN(const uint16_t opcode) { return opcode & 0xF; }
+		inline uint8_t OperandNN(const uint16_t opcode) { return opcode & 0xFF; }
+		inline uint16_t OperandNNN(const uint16_t opcode) { return opcode & 0xFFF; }
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	inline uint16_t BasicEmulator<Renderer, Input, Rng>::ReadOpcode(const uint16_t address) const
+	{
+		return MemoryMapping[address + 1] + (static_cast<uint16_t>(MemoryMapping[address]) << 8);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	uint16_t BasicEmulator<Renderer, Input, Rng>::FetchOpcode() const
+	{
+		uint16_t opcode = ReadOpcode(State.PC);
+#ifdef DEBUG_BUILD
+		std::cout << std::hex << "0x" << State.PC << ": 0x" << opcode << "  -->  ";
+#endif
+		return opcode;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	inline DecodedInstruction& BasicEmulator<Renderer, Input, Rng>::FetchDecoded()
+	{
+#ifdef DEBUG_BUILD
+		std::cout << std::hex << "0x" << State.PC << ": 0x" << ReadOpcode(State.PC) << "  -->  ";
+#endif
+		// odd or out of range addresses are never cached, they are decoded every time
+		if (State.PC & 0xF001)
+		{
+			UncachedInstruction = Decode(ReadOpcode(State.PC));
+			return UncachedInstruction;
+		}
+		return DecodeCache[State.PC >> 1];
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::InvalidateCode(const uint16_t first, const uint16_t last)
+	{
+		const int first_entry = (first >> 1) & 0x7FF;
+		const int last_entry = std::min(last >> 1, 0x7FF);
+		// a superinstruction is cached at its first address, up to MaxFusionLength - 1 entries earlier
+		for (int entry = std::max(first_entry - MaxFusionLength + 1, 0); entry <= last_entry; ++entry)
+		{
+			DecodeCache[entry].id = Instruction::Undecoded;
+		}
+		// any block starting up to MaxBlockLength instructions earlier may run over the written bytes
+		for (int entry = std::max(first_entry - MaxBlockLength + 1, 0); entry <= last_entry; ++entry)
+		{
+			BlockCache[entry] = {};
+			if (!StaticBlocks.empty())
+			{
+				StaticBlocks[entry] = nullptr;
+			}
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	DecodedInstruction BasicEmulator<Renderer, Input, Rng>::Decode(const uint16_t opcode)
+	{
+		DecodedInstruction decoded;
+		decoded.x = detail::OperandX(opcode);
+		decoded.y = detail::OperandY(opcode);
+		decoded.n = detail::OperandN(opcode);
+		decoded.nn = detail::OperandNN(opcode);
+		decoded.nnn = detail::OperandNNN(opcode);
+
+		switch (opcode >> 12)
+		{
+		case 0x0:
+			switch (opcode & 0xFF)
+			{
+			case 0xE0: decoded.id = Instruction::CLS; break;
+			case 0xEE: decoded.id = Instruction::RET; break;
+			default: decoded.id = Instruction::NotImplemented; break;    // SYS addr is ignored
+			}
+			break;
+		case 0x1: decoded.id = Instruction::JP; break;
+		case 0x2: decoded.id = Instruction::CALL; break;
+		case 0x3: decoded.id = Instruction::SE_VX_BYTE; break;
+		case 0x4: decoded.id = Instruction::SNE_VX_BYTE; break;
+		case 0x5: decoded.id = Instruction::SE_VX_VY; break;
+		case 0x6: decoded.id = Instruction::LD_VX_BYTE; break;
+		case 0x7: decoded.id = Instruction::ADD_VX_BYTE; break;
+		case 0x8:
+			switch (opcode & 0xF)
+			{
+			case 0x0: decoded.id = Instruction::LD_VX_VY; break;
+			case 0x1: decoded.id = Instruction::OR_VX_VY; break;
+			case 0x2: decoded.id = Instruction::AND_VX_VY; break;
+			case 0x3: decoded.id = Instruction::XOR_VX_VY; break;
+			case 0x4: decoded.id = Instruction::ADD_VX_VY; break;
+			case 0x5: decoded.id = Instruction::SUB_VX_VY; break;
+			case 0x6: decoded.id = Instruction::SHR_VX_VY; break;
+			case 0x7: decoded.id = Instruction::SUBN_VX_VY; break;
+			case 0xE: decoded.id = Instruction::SHL_VX_VY; break;
+			default: decoded.id = Instruction::NotImplemented; break;
+			}
+			break;
+		case 0x9: decoded.id = Instruction::SNE_VX_VY; break;
+		case 0xA: decoded.id = Instruction::LD_I_ADDR; break;
+		case 0xB: decoded.id = Instruction::JP_V0_ADDR; break;
+		case 0xC: decoded.id = Instruction::RND_VX_BYTE; break;
+		case 0xD: decoded.id = Instruction::DRW_VX_VY_NIBBLE; break;
+		case 0xE:
+			switch (opcode & 0xFF)
+			{
+			case 0x9E: decoded.id = Instruction::SKP_VX; break;
+			case 0xA1: decoded.id = Instruction::SKNP_VX; break;
+			default: decoded.id = Instruction::NotImplemented; break;
+			}
+			break;
+		case 0xF:
+			switch (opcode & 0xFF)
+			{
+			case 0x07: decoded.id = Instruction::LD_VX_DT; break;
+			case 0x0A: decoded.id = Instruction::LD_VX_K; break;
+			case 0x15: decoded.id = Instruction::LD_DT_VX; break;
+			case 0x18: decoded.id = Instruction::LD_ST_VX; break;
+			case 0x1E: decoded.id = Instruction::ADD_I_VX; break;
+			case 0x29: decoded.id = Instruction::LD_F_VX; break;
+			case 0x33: decoded.id = Instruction::LD_B_VX; break;
+			case 0x55: decoded.id = Instruction::LD_I_VX; break;
+			case 0x65: decoded.id = Instruction::LD_VX_I; break;
+			default: decoded.id = Instruction::NotImplemented; break;
+			}
+			break;
+		default:
+			decoded.id = Instruction::NotImplemented;
+			break;
+		}
+		return decoded;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	bool BasicEmulator<Renderer, Input, Rng>::IsErrorStatus(const OpcodeStatus status)
+	{
+		return status == OpcodeStatus::NotImplemented || status == OpcodeStatus::StackOverflow || status == OpcodeStatus::Error;
+	}
+
+	// moves PC past the executed instruction, returns false when execution has to stop
+	template<typename Renderer, typename Input, typename Rng>
+	inline bool BasicEmulator<Renderer, Input, Rng>::RetireInstruction(const OpcodeStatus status)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << std::endl;
+#endif
+		if (status == OpcodeStatus::IncrementPC)
+		{
+			State.PC += 2;
+			return true;
+		}
+		return status == OpcodeStatus::NotIncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteInstructions(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+		return WithQuirkPolicy(Profile, DoWrap, [&]<typename Quirks>() { return ExecuteInstructions<Quirks>(instruction_count, out_status); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteInstructions(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+		switch (Dispatch)
+		{
+		case DispatchMode::Table:
+			return ExecuteTable(instruction_count, out_status);
+		case DispatchMode::Threaded:
+			return ExecuteThreaded<Quirks>(instruction_count, out_status);
+		case DispatchMode::Jit:
+			// only EmulatorImpl compiles these two, SetDispatchMode turns them into Block for the other instantiations
+			if constexpr (IsDynamic)
+				return ExecuteJit<Quirks>(instruction_count, out_status);
+			[[fallthrough]];
+		case DispatchMode::Static:
+			if constexpr (IsDynamic)
+				return ExecuteStatic<Quirks>(instruction_count, out_status);
+			[[fallthrough]];
+		case DispatchMode::Block:
+			return ExecuteBlocks<Quirks>(instruction_count, out_status);
+		case DispatchMode::Specialized:
+			// the 64K table is built for EmulatorImpl alone
+			if constexpr (IsDynamic)
+				return ExecuteSpecialized(instruction_count, out_status);
+			[[fallthrough]];
+		case DispatchMode::Switch:
+		default:
+			return ExecuteSwitch<Quirks>(instruction_count, out_status);
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteTable(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+		uint32_t executed = 0;
+		while (executed < instruction_count)
+		{
+			uint16_t opcode = FetchOpcode();
+			out_status = Opcodes[opcode >> 12](opcode);
+			++executed;
+			if (!RetireInstruction(out_status))
+				break;
+		}
+		return executed;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteSwitch(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+		uint32_t executed = 0;
+		while (executed < instruction_count)
+		{
+			out_status = Execute<Quirks>(FetchDecoded());
+			++executed;
+			if (!RetireInstruction(out_status))
+				break;
+		}
+		return executed;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Execute(DecodedInstruction& instruction)
+	{
+		return WithQuirkPolicy(Profile, DoWrap, [&]<typename Quirks>() { return Execute<Quirks>(instruction); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Execute(DecodedInstruction& instruction)
+	{
+		switch (instruction.id)
+		{
+		case Instruction::Undecoded:
+			instruction = DecodeAt(State.PC);
+			return Execute<Quirks>(instruction);
+		case Instruction::CLS: return CLS();
+		case Instruction::RET: return RET();
+		case Instruction::JP: return JP(instruction.nnn);
+		case Instruction::CALL: return CALL(instruction.nnn);
+		case Instruction::SE_VX_BYTE: return SE_VX_BYTE(instruction.x, instruction.nn);
+		case Instruction::SNE_VX_BYTE: return SNE_VX_BYTE(instruction.x, instruction.nn);
+		case Instruction::SE_VX_VY: return SE_VX_VY(instruction.x, instruction.y);
+		case Instruction::LD_VX_BYTE: return LD_VX_BYTE(instruction.x, instruction.nn);
+		case Instruction::ADD_VX_BYTE: return ADD_VX_BYTE(instruction.x, instruction.nn);
+		case Instruction::LD_VX_VY: return LD_VX_VY(instruction.x, instruction.y);
+		case Instruction::OR_VX_VY: return OR_VX_VY(instruction.x, instruction.y);
+		case Instruction::AND_VX_VY: return AND_VX_VY(instruction.x, instruction.y);
+		case Instruction::XOR_VX_VY: return XOR_VX_VY(instruction.x, instruction.y);
+		case Instruction::ADD_VX_VY: return ADD_VX_VY(instruction.x, instruction.y);
+		case Instruction::SUB_VX_VY: return SUB_VX_VY(instruction.x, instruction.y);
+		case Instruction::SHR_VX_VY: return SHR_VX_VY<Quirks>(instruction.x, instruction.y);
+		case Instruction::SUBN_VX_VY: return SUBN_VX_VY(instruction.x, instruction.y);
+		case Instruction::SHL_VX_VY: return SHL_VX_VY<Quirks>(instruction.x, instruction.y);
+		case Instruction::SNE_VX_VY: return SNE_VX_VY(instruction.x, instruction.y);
+		case Instruction::LD_I_ADDR: return LD_I_ADDR(instruction.nnn);
+		case Instruction::JP_V0_ADDR: return JP_V0_ADDR<Quirks>(instruction.nnn);
+		case Instruction::RND_VX_BYTE: return RND_VX_BYTE(instruction.x, instruction.nn);
+		case Instruction::DRW_VX_VY_NIBBLE: return DRW_VX_VY_NIBBLE<Quirks>(instruction.x, instruction.y, instruction.n);
+		case Instruction::SKP_VX: return SKP_VX(instruction.x);
+		case Instruction::SKNP_VX: return SKNP_VX(instruction.x);
+		case Instruction::LD_VX_DT: return LD_VX_DT(instruction.x);
+		case Instruction::LD_VX_K: return LD_VX_K(instruction.x);
+		case Instruction::LD_DT_VX: return LD_DT_VX(instruction.x);
+		case Instruction::LD_ST_VX: return LD_ST_VX(instruction.x);
+		case Instruction::ADD_I_VX: return ADD_I_VX(instruction.x);
+		case Instruction::LD_F_VX: return LD_F_VX(instruction.x);
+		case Instruction::LD_B_VX: return LD_B_VX(instruction.x);
+		case Instruction::LD_I_VX: return LD_I_VX<Quirks>(instruction.x);
+		case Instruction::LD_VX_I: return LD_VX_I<Quirks>(instruction.x);
+		case Instruction::LD_VX_BYTE_ADD_I_VY: return LD_VX_BYTE_ADD_I_VY(instruction);
+		case Instruction::LD_I_ADDR_DRW: return LD_I_ADDR_DRW<Quirks>(instruction);
+		case Instruction::SE_VX_BYTE_JP: return SE_VX_BYTE_JP(instruction);
+		case Instruction::SNE_VX_BYTE_JP: return SNE_VX_BYTE_JP(instruction);
+		case Instruction::LD_VX_DT_SE_JP: return LD_VX_DT_SE_JP(instruction);
+		case Instruction::NotImplemented:
+		default:
+			return OpcodeStatus::NotImplemented;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteThreaded(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+#if CHIP8_COMPUTED_GOTO
+		// indexed by Instruction, keep in the same order as the enum
+		static void* const instruction_labels[] =
+		{
+			&&op_undecoded, &&op_not_implemented,
+			&&op_CLS, &&op_RET, &&op_JP, &&op_CALL,
+			&&op_SE_VX_BYTE, &&op_SNE_VX_BYTE, &&op_SE_VX_VY, &&op_LD_VX_BYTE, &&op_ADD_VX_BYTE,
+			&&op_LD_VX_VY, &&op_OR_VX_VY, &&op_AND_VX_VY, &&op_XOR_VX_VY, &&op_ADD_VX_VY,
+			&&op_SUB_VX_VY, &&op_SHR_VX_VY, &&op_SUBN_VX_VY, &&op_SHL_VX_VY, &&op_SNE_VX_VY,
+			&&op_LD_I_ADDR, &&op_JP_V0_ADDR, &&op_RND_VX_BYTE, &&op_DRW_VX_VY_NIBBLE,
+			&&op_SKP_VX, &&op_SKNP_VX, &&op_LD_VX_DT, &&op_LD_VX_K, &&op_LD_DT_VX, &&op_LD_ST_VX,
+			&&op_ADD_I_VX, &&op_LD_F_VX, &&op_LD_B_VX, &&op_LD_I_VX, &&op_LD_VX_I,
+			&&op_LD_VX_BYTE_ADD_I_VY, &&op_LD_I_ADDR_DRW, &&op_SE_VX_BYTE_JP, &&op_SNE_VX_BYTE_JP, &&op_LD_VX_DT_SE_JP
+		};
+		static_assert(sizeof(instruction_labels) / sizeof(void*) == static_cast<size_t>(Instruction::Count),
+			"instruction_labels is out of sync with Instruction");
+
+		uint32_t executed = 0;
+		DecodedInstruction* instruction = nullptr;
+
+		// every handler ends with its own copy of the fetch and indirect jump, so the host
+		// branch predictor sees one dispatch site per instruction instead of a shared one
+#define THREADED_DISPATCH() \
+		if (executed == instruction_count) \
+			return executed; \
+		instruction = &FetchDecoded(); \
+		goto *instruction_labels[static_cast<uint8_t>(instruction->id)]
+
+#define THREADED_NEXT(handler) \
+		out_status = handler; \
+		++executed; \
+		if (!RetireInstruction(out_status)) \
+			return executed; \
+		THREADED_DISPATCH()
+
+		THREADED_DISPATCH();
+
+	op_undecoded:
+		*instruction = DecodeAt(State.PC);
+		goto *instruction_labels[static_cast<uint8_t>(instruction->id)];
+	op_not_implemented: THREADED_NEXT(OpcodeStatus::NotImplemented);
+	op_CLS: THREADED_NEXT(CLS());
+	op_RET: THREADED_NEXT(RET());
+	op_JP: THREADED_NEXT(JP(instruction->nnn));
+	op_CALL: THREADED_NEXT(CALL(instruction->nnn));
+	op_SE_VX_BYTE: THREADED_NEXT(SE_VX_BYTE(instruction->x, instruction->nn));
+	op_SNE_VX_BYTE: THREADED_NEXT(SNE_VX_BYTE(instruction->x, instruction->nn));
+	op_SE_VX_VY: THREADED_NEXT(SE_VX_VY(instruction->x, instruction->y));
+	op_LD_VX_BYTE: THREADED_NEXT(LD_VX_BYTE(instruction->x, instruction->nn));
+	op_ADD_VX_BYTE: THREADED_NEXT(ADD_VX_BYTE(instruction->x, instruction->nn));
+	op_LD_VX_VY: THREADED_NEXT(LD_VX_VY(instruction->x, instruction->y));
+	op_OR_VX_VY: THREADED_NEXT(OR_VX_VY(instruction->x, instruction->y));
+	op_AND_VX_VY: THREADED_NEXT(AND_VX_VY(instruction->x, instruction->y));
+	op_XOR_VX_VY: THREADED_NEXT(XOR_VX_VY(instruction->x, instruction->y));
+	op_ADD_VX_VY: THREADED_NEXT(ADD_VX_VY(instruction->x, instruction->y));
+	op_SUB_VX_VY: THREADED_NEXT(SUB_VX_VY(instruction->x, instruction->y));
+	op_SHR_VX_VY: THREADED_NEXT(SHR_VX_VY<Quirks>(instruction->x, instruction->y));
+	op_SUBN_VX_VY: THREADED_NEXT(SUBN_VX_VY(instruction->x, instruction->y));
+	op_SHL_VX_VY: THREADED_NEXT(SHL_VX_VY<Quirks>(instruction->x, instruction->y));
+	op_SNE_VX_VY: THREADED_NEXT(SNE_VX_VY(instruction->x, instruction->y));
+	op_LD_I_ADDR: THREADED_NEXT(LD_I_ADDR(instruction->nnn));
+	op_JP_V0_ADDR: THREADED_NEXT(JP_V0_ADDR<Quirks>(instruction->nnn));
+	op_RND_VX_BYTE: THREADED_NEXT(RND_VX_BYTE(instruction->x, instruction->nn));
+	op_DRW_VX_VY_NIBBLE: THREADED_NEXT(DRW_VX_VY_NIBBLE<Quirks>(instruction->x, instruction->y, instruction->n));
+	op_SKP_VX: THREADED_NEXT(SKP_VX(instruction->x));
+	op_SKNP_VX: THREADED_NEXT(SKNP_VX(instruction->x));
+	op_LD_VX_DT: THREADED_NEXT(LD_VX_DT(instruction->x));
+	op_LD_VX_K: THREADED_NEXT(LD_VX_K(instruction->x));
+	op_LD_DT_VX: THREADED_NEXT(LD_DT_VX(instruction->x));
+	op_LD_ST_VX: THREADED_NEXT(LD_ST_VX(instruction->x));
+	op_ADD_I_VX: THREADED_NEXT(ADD_I_VX(instruction->x));
+	op_LD_F_VX: THREADED_NEXT(LD_F_VX(instruction->x));
+	op_LD_B_VX: THREADED_NEXT(LD_B_VX(instruction->x));
+	op_LD_I_VX: THREADED_NEXT(LD_I_VX<Quirks>(instruction->x));
+	op_LD_VX_I: THREADED_NEXT(LD_VX_I<Quirks>(instruction->x));
+	op_LD_VX_BYTE_ADD_I_VY: THREADED_NEXT(LD_VX_BYTE_ADD_I_VY(*instruction));
+	op_LD_I_ADDR_DRW: THREADED_NEXT(LD_I_ADDR_DRW<Quirks>(*instruction));
+	op_SE_VX_BYTE_JP: THREADED_NEXT(SE_VX_BYTE_JP(*instruction));
+	op_SNE_VX_BYTE_JP: THREADED_NEXT(SNE_VX_BYTE_JP(*instruction));
+	op_LD_VX_DT_SE_JP: THREADED_NEXT(LD_VX_DT_SE_JP(*instruction));
+
+#undef THREADED_NEXT
+#undef THREADED_DISPATCH
+#else
+		return ExecuteSwitch<Quirks>(instruction_count, out_status);
+#endif // CHIP8_COMPUTED_GOTO
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	DecodedInstruction BasicEmulator<Renderer, Input, Rng>::DecodeAt(const uint16_t address) const
+	{
+		DecodedInstruction decoded = Decode(ReadOpcode(address));
+		// the other engines walk the decode cache one instruction per entry
+		if (!FusionEnabled || (Dispatch != DispatchMode::Switch && Dispatch != DispatchMode::Threaded)
+			|| static_cast<size_t>(address) + 2 * MaxFusionLength > MemoryMapping.size())
+			return decoded;
+
+		const DecodedInstruction second = Decode(ReadOpcode(address + 2));
+		switch (decoded.id)
+		{
+		case Instruction::LD_VX_DT:
+		{
+			const DecodedInstruction third = Decode(ReadOpcode(address + 4));
+			if (second.id == Instruction::SE_VX_BYTE && second.x == decoded.x && third.id == Instruction::JP)
+			{
+				decoded.id = Instruction::LD_VX_DT_SE_JP;
+				decoded.nn = second.nn;
+				decoded.nnn = third.nnn;
+			}
+			break;
+		}
+		case Instruction::LD_VX_BYTE:
+			if (second.id == Instruction::ADD_I_VX)
+			{
+				decoded.id = Instruction::LD_VX_BYTE_ADD_I_VY;
+				decoded.y = second.x;
+			}
+			break;
+		case Instruction::LD_I_ADDR:
+			if (second.id == Instruction::DRW_VX_VY_NIBBLE)
+			{
+				decoded.id = Instruction::LD_I_ADDR_DRW;
+				decoded.x = second.x;
+				decoded.y = second.y;
+				decoded.n = second.n;
+			}
+			break;
+		case Instruction::SE_VX_BYTE:
+		case Instruction::SNE_VX_BYTE:
+			if (second.id == Instruction::JP)
+			{
+				decoded.id = decoded.id == Instruction::SE_VX_BYTE ? Instruction::SE_VX_BYTE_JP : Instruction::SNE_VX_BYTE_JP;
+				decoded.nnn = second.nnn;
+			}
+			break;
+		default:
+			break;
+		}
+		return decoded;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	bool BasicEmulator<Renderer, Input, Rng>::IsBlockTerminator(const Instruction id)
+	{
+		switch (id)
+		{
+		case Instruction::JP:
+		case Instruction::CALL:
+		case Instruction::RET:
+		case Instruction::JP_V0_ADDR:
+		case Instruction::SE_VX_BYTE:
+		case Instruction::SNE_VX_BYTE:
+		case Instruction::SE_VX_VY:
+		case Instruction::SNE_VX_VY:
+		case Instruction::SKP_VX:
+		case Instruction::SKNP_VX:
+		case Instruction::DRW_VX_VY_NIBBLE:
+		case Instruction::LD_VX_K:
+		// memory writes end the block so a block never runs over code it just modified
+		case Instruction::LD_B_VX:
+		case Instruction::LD_I_VX:
+		case Instruction::NotImplemented:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::BuildBlock(BasicBlock& block, const uint16_t start)
+	{
+		uint16_t length = 0;
+		for (uint16_t address = start; address < MemoryMapping.size() - 1 && length < MaxBlockLength; address += 2)
+		{
+			DecodedInstruction& instruction = DecodeCache[address >> 1];
+			if (instruction.id == Instruction::Undecoded)
+			{
+				instruction = Decode(ReadOpcode(address));
+			}
+			++length;
+			if (IsBlockTerminator(instruction.id))
+				break;
+		}
+		block.length = length;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	BasicBlock& BasicEmulator<Renderer, Input, Rng>::FetchBlock()
+	{
+		BasicBlock& block = BlockCache[State.PC >> 1];
+		if (block.length == 0)
+		{
+			BuildBlock(block, State.PC);
+		}
+		return block;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	bool BasicEmulator<Renderer, Input, Rng>::RunBlock(const BasicBlock& block, uint32_t& executed, OpcodeStatus& out_status)
+	{
+		// the body cannot jump, fail or touch memory, so its statuses need no checking
+		DecodedInstruction* instruction = &DecodeCache[State.PC >> 1];
+		const uint16_t body_length = block.length - 1;
+		for (uint16_t i = 0; i < body_length; ++i, ++instruction)
+		{
+			Execute<Quirks>(*instruction);
+			State.PC += 2;
+		}
+		executed += body_length;
+
+#ifdef DEBUG_BUILD
+		std::cout << std::hex << "0x" << State.PC << ": 0x" << ReadOpcode(State.PC) << "  -->  ";
+#endif
+		out_status = Execute<Quirks>(*instruction);
+		++executed;
+		return RetireInstruction(out_status);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	bool BasicEmulator<Renderer, Input, Rng>::StepUncached(uint32_t& executed, OpcodeStatus& out_status)
+	{
+		executed += ExecuteSwitch<Quirks>(1, out_status);
+		return !IsErrorStatus(out_status) && out_status != OpcodeStatus::WaitForKeyboard;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteBlocks(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+		uint32_t executed = 0;
+		while (executed < instruction_count)
+		{
+			if (State.PC & 0xF001)
+			{
+				if (!StepUncached<Quirks>(executed, out_status))
+					break;
+				continue;
+			}
+
+			if (!RunBlock<Quirks>(FetchBlock(), executed, out_status))
+				break;
+		}
+		return executed;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteJit(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+#if CHIP8_HAS_JIT
+		if (!Jit)
+		{
+			Jit = std::make_unique<JitCompiler>(this);
+		}
+
+		uint32_t executed = 0;
+		while (executed < instruction_count)
+		{
+			if (State.PC & 0xF001)
+			{
+				if (!StepUncached<Quirks>(executed, out_status))
+					break;
+				continue;
+			}
+
+			const uint16_t start = State.PC;
+			BasicBlock& block = FetchBlock();
+			if (!block.native && ++block.hits >= JitThreshold)
+			{
+				CompileBlock(block, start);
+			}
+
+			if (block.native)
+			{
+				// the terminator may invalidate the block it ends, so nothing is read from it afterwards
+				const uint16_t length = block.length;
+				// native blocks retire their terminator themselves
+				out_status = static_cast<OpcodeStatus>(block.native(this));
+				executed += length;
+				if (out_status != OpcodeStatus::NotIncrementPC)
+					break;
+				continue;
+			}
+
+			if (!RunBlock<Quirks>(block, executed, out_status))
+				break;
+		}
+		return executed;
+#else
+		return ExecuteBlocks<Quirks>(instruction_count, out_status);
+#endif // CHIP8_HAS_JIT
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::CompileBlock(BasicBlock& block, const uint16_t start)
+	{
+		block.native = Jit->Compile(start, block.length);
+		if (!block.native)
+		{
+			// the code buffer is full, start over with only the blocks that are still hot
+			FlushJit();
+			block.native = Jit->Compile(start, block.length);
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteStatic(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+		StaticMachine machine{ *this, State.Registers.data(), State.I, State.PC, State.DelayTimer };
+
+		uint32_t executed = 0;
+		while (executed < instruction_count)
+		{
+			if (State.PC & 0xF001)
+			{
+				if (!StepUncached<Quirks>(executed, out_status))
+					break;
+				continue;
+			}
+
+			const StaticBlock* static_block = StaticBlocks.empty() ? nullptr : StaticBlocks[State.PC >> 1];
+			if (static_block)
+			{
+				executed += static_block->length;
+				out_status = static_block->function(machine);
+				if (out_status != OpcodeStatus::NotIncrementPC)
+					break;
+				continue;
+			}
+
+			if (!RunBlock<Quirks>(FetchBlock(), executed, out_status))
+				break;
+		}
+		return executed;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::ActivateStaticProgram()
+	{
+		static_assert(StaticRuntime::MaxBlockLength <= MaxBlockLength, "InvalidateCode must cover every static block");
+
+		StaticBlocks.clear();
+		if (!Program || Program->rom_size == 0 || Program->rom_size > MemoryMapping.size() - 0x200)
+			return;
+		if (memcmp(MemoryMapping.data() + 0x200, Program->rom, Program->rom_size) != 0)
+			return;
+
+		StaticBlocks.resize(BlockCache.size(), nullptr);
+		for (uint16_t i = 0; i < Program->block_count; ++i)
+		{
+			const StaticBlock& block = Program->blocks[i];
+			StaticBlocks[block.address >> 1] = &block;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::FlushJit()
+	{
+		for (BasicBlock& block : BlockCache)
+		{
+			block.hits = 0;
+			block.native = nullptr;
+		}
+		if (Jit)
+		{
+			Jit->Reset();
+		}
+	}
+
+#pragma endregion
+#pragma region Specialized Dispatch
+
+#if CHIP8_CONSTEXPR_DECODE
+	// one handler per opcode form and register operand, the immediates are the low bits of the opcode
+	template<typename Renderer, typename Input, typename Rng>
+	struct BasicEmulator<Renderer, Input, Rng>::SpecializedHandlers
+	{
+		using Handler = OpcodeStatus(*)(BasicEmulator& emulator, const uint16_t /*opcode*/);
+
+		static OpcodeStatus NotImplemented(BasicEmulator& /*emulator*/, const uint16_t /*opcode*/) { return OpcodeStatus::NotImplemented; }
+		static OpcodeStatus CLS(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.CLS(); }
+		static OpcodeStatus RET(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.RET(); }
+		static OpcodeStatus JP(BasicEmulator& emulator, const uint16_t opcode) { return emulator.JP(opcode & 0xFFF); }
+		static OpcodeStatus CALL(BasicEmulator& emulator, const uint16_t opcode) { return emulator.CALL(opcode & 0xFFF); }
+		static OpcodeStatus LD_I_ADDR(BasicEmulator& emulator, const uint16_t opcode) { return emulator.LD_I_ADDR(opcode & 0xFFF); }
+		static OpcodeStatus JP_V0_ADDR(BasicEmulator& emulator, const uint16_t opcode) { return emulator.JP_V0_ADDR(opcode & 0xFFF); }
+
+		// the byte immediate is a plain truncation, not a mask
+		template<uint8_t X> struct SE_VX_BYTE { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t opcode) { return emulator.SE_VX_BYTE(X, static_cast<uint8_t>(opcode)); } };
+		template<uint8_t X> struct SNE_VX_BYTE { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t opcode) { return emulator.SNE_VX_BYTE(X, static_cast<uint8_t>(opcode)); } };
+		template<uint8_t X> struct LD_VX_BYTE { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t opcode) { return emulator.LD_VX_BYTE(X, static_cast<uint8_t>(opcode)); } };
+		template<uint8_t X> struct ADD_VX_BYTE { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t opcode) { return emulator.ADD_VX_BYTE(X, static_cast<uint8_t>(opcode)); } };
+		template<uint8_t X> struct RND_VX_BYTE { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t opcode) { return emulator.RND_VX_BYTE(X, static_cast<uint8_t>(opcode)); } };
+		template<uint8_t X> struct SKP_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SKP_VX(X); } };
+		template<uint8_t X> struct SKNP_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SKNP_VX(X); } };
+		template<uint8_t X> struct LD_VX_DT { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_VX_DT(X); } };
+		template<uint8_t X> struct LD_VX_K { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_VX_K(X); } };
+		template<uint8_t X> struct LD_DT_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_DT_VX(X); } };
+		template<uint8_t X> struct LD_ST_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_ST_VX(X); } };
+		template<uint8_t X> struct ADD_I_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.ADD_I_VX(X); } };
+		template<uint8_t X> struct LD_F_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_F_VX(X); } };
+		template<uint8_t X> struct LD_B_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_B_VX(X); } };
+		template<uint8_t X> struct LD_I_VX { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_I_VX(X); } };
+		template<uint8_t X> struct LD_VX_I { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_VX_I(X); } };
+
+		template<uint8_t X, uint8_t Y> struct SE_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SE_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct SNE_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SNE_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct LD_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.LD_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct OR_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.OR_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct AND_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.AND_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct XOR_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.XOR_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct ADD_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.ADD_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct SUB_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SUB_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct SHR_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SHR_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct SUBN_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SUBN_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct SHL_VX_VY { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t /*opcode*/) { return emulator.SHL_VX_VY(X, Y); } };
+		template<uint8_t X, uint8_t Y> struct DRW_VX_VY_NIBBLE { static OpcodeStatus Run(BasicEmulator& emulator, const uint16_t opcode) { return emulator.DRW_VX_VY_NIBBLE(X, Y, opcode & 0xF); } };
+
+		template<template<uint8_t> class Form, size_t... X>
+		static constexpr std::array<Handler, 0x10> MakeX(std::index_sequence<X...>)
+		{
+			return { &Form<X>::Run... };
+		}
+
+		// indexed by the XY byte of the opcode
+		template<template<uint8_t, uint8_t> class Form, size_t... XY>
+		static constexpr std::array<Handler, 0x100> MakeXY(std::index_sequence<XY...>)
+		{
+			return { &Form<(XY >> 4), (XY & 0xF)>::Run... };
+		}
+
+		// same mapping as Decode, an opcode that Decode rejects stays NotImplemented
+		static constexpr std::array<Handler, 0x10000> MakeTable()
+		{
+			constexpr auto x = std::make_index_sequence<0x10>{};
+			constexpr auto xy = std::make_index_sequence<0x100>{};
+			constexpr auto se_vx_byte = MakeX<SE_VX_BYTE>(x);
+			constexpr auto sne_vx_byte = MakeX<SNE_VX_BYTE>(x);
+			constexpr auto ld_vx_byte = MakeX<LD_VX_BYTE>(x);
+			constexpr auto add_vx_byte = MakeX<ADD_VX_BYTE>(x);
+			constexpr auto rnd_vx_byte = MakeX<RND_VX_BYTE>(x);
+			constexpr auto skp_vx = MakeX<SKP_VX>(x);
+			constexpr auto sknp_vx = MakeX<SKNP_VX>(x);
+			constexpr auto ld_vx_dt = MakeX<LD_VX_DT>(x);
+			constexpr auto ld_vx_k = MakeX<LD_VX_K>(x);
+			constexpr auto ld_dt_vx = MakeX<LD_DT_VX>(x);
+			constexpr auto ld_st_vx = MakeX<LD_ST_VX>(x);
+			constexpr auto add_i_vx = MakeX<ADD_I_VX>(x);
+			constexpr auto ld_f_vx = MakeX<LD_F_VX>(x);
+			constexpr auto ld_b_vx = MakeX<LD_B_VX>(x);
+			constexpr auto ld_i_vx = MakeX<LD_I_VX>(x);
+			constexpr auto ld_vx_i = MakeX<LD_VX_I>(x);
+			constexpr auto se_vx_vy = MakeXY<SE_VX_VY>(xy);
+			constexpr auto ld_vx_vy = MakeXY<LD_VX_VY>(xy);
+			constexpr auto or_vx_vy = MakeXY<OR_VX_VY>(xy);
+			constexpr auto and_vx_vy = MakeXY<AND_VX_VY>(xy);
+			constexpr auto xor_vx_vy = MakeXY<XOR_VX_VY>(xy);
+			constexpr auto add_vx_vy = MakeXY<ADD_VX_VY>(xy);
+			constexpr auto sub_vx_vy = MakeXY<SUB_VX_VY>(xy);
+			constexpr auto shr_vx_vy = MakeXY<SHR_VX_VY>(xy);
+			constexpr auto subn_vx_vy = MakeXY<SUBN_VX_VY>(xy);
+			constexpr auto shl_vx_vy = MakeXY<SHL_VX_VY>(xy);
+			constexpr auto sne_vx_vy = MakeXY<SNE_VX_VY>(xy);
+			constexpr auto drw_vx_vy_nibble = MakeXY<DRW_VX_VY_NIBBLE>(xy);
+
+			std::array<Handler, 0x10000> table{};
+			for (uint32_t opcode = 0; opcode < table.size(); ++opcode)
+			{
+				const uint8_t vx = (opcode >> 8) & 0xF;
+				const uint8_t vxy = (opcode >> 4) & 0xFF;
+				Handler handler = &NotImplemented;
+				switch (opcode >> 12)
+				{
+				case 0x0:
+					if ((opcode & 0xFF) == 0xE0)
+						handler = &CLS;
+					else if ((opcode & 0xFF) == 0xEE)
+						handler = &RET;
+					break;
+				case 0x1: handler = &JP; break;
+				case 0x2: handler = &CALL; break;
+				case 0x3: handler = se_vx_byte[vx]; break;
+				case 0x4: handler = sne_vx_byte[vx]; break;
+				case 0x5: handler = se_vx_vy[vxy]; break;
+				case 0x6: handler = ld_vx_byte[vx]; break;
+				case 0x7: handler = add_vx_byte[vx]; break;
+				case 0x8:
+					switch (opcode & 0xF)
+					{
+					case 0x0: handler = ld_vx_vy[vxy]; break;
+					case 0x1: handler = or_vx_vy[vxy]; break;
+					case 0x2: handler = and_vx_vy[vxy]; break;
+					case 0x3: handler = xor_vx_vy[vxy]; break;
+					case 0x4: handler = add_vx_vy[vxy]; break;
+					case 0x5: handler = sub_vx_vy[vxy]; break;
+					case 0x6: handler = shr_vx_vy[vxy]; break;
+					case 0x7: handler = subn_vx_vy[vxy]; break;
+					case 0xE: handler = shl_vx_vy[vxy]; break;
+					}
+					break;
+				case 0x9: handler = sne_vx_vy[vxy]; break;
+				case 0xA: handler = &LD_I_ADDR; break;
+				case 0xB: handler = &JP_V0_ADDR; break;
+				case 0xC: handler = rnd_vx_byte[vx]; break;
+				case 0xD: handler = drw_vx_vy_nibble[vxy]; break;
+				case 0xE:
+					if ((opcode & 0xFF) == 0x9E)
+						handler = skp_vx[vx];
+					else if ((opcode & 0xFF) == 0xA1)
+						handler = sknp_vx[vx];
+					break;
+				case 0xF:
+					switch (opcode & 0xFF)
+					{
+					case 0x07: handler = ld_vx_dt[vx]; break;
+					case 0x0A: handler = ld_vx_k[vx]; break;
+					case 0x15: handler = ld_dt_vx[vx]; break;
+					case 0x18: handler = ld_st_vx[vx]; break;
+					case 0x1E: handler = add_i_vx[vx]; break;
+					case 0x29: handler = ld_f_vx[vx]; break;
+					case 0x33: handler = ld_b_vx[vx]; break;
+					case 0x55: handler = ld_i_vx[vx]; break;
+					case 0x65: handler = ld_vx_i[vx]; break;
+					}
+					break;
+				}
+				table[opcode] = handler;
+			}
+			return table;
+		}
+
+		static const std::array<Handler, 0x10000> Table;
+	};
+
+	// built by the compiler, it lands in read-only data
+	template<typename Renderer, typename Input, typename Rng>
+	constexpr std::array<typename BasicEmulator<Renderer, Input, Rng>::SpecializedHandlers::Handler, 0x10000> BasicEmulator<Renderer, Input, Rng>::SpecializedHandlers::Table =
+		BasicEmulator<Renderer, Input, Rng>::SpecializedHandlers::MakeTable();
+#endif // CHIP8_CONSTEXPR_DECODE
+
+	template<typename Renderer, typename Input, typename Rng>
+	uint32_t BasicEmulator<Renderer, Input, Rng>::ExecuteSpecialized(const uint32_t instruction_count, OpcodeStatus& out_status)
+	{
+#if CHIP8_CONSTEXPR_DECODE
+		uint32_t executed = 0;
+		while (executed < instruction_count)
+		{
+			const uint16_t opcode = FetchOpcode();
+			out_status = SpecializedHandlers::Table[opcode](*this, opcode);
+			++executed;
+			if (!RetireInstruction(out_status))
+				break;
+		}
+		return executed;
+#else
+		return WithQuirkPolicy(Profile, DoWrap, [&]<typename Quirks>() { return ExecuteSwitch<Quirks>(instruction_count, out_status); });
+#endif // CHIP8_CONSTEXPR_DECODE
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	size_t BasicEmulator<Renderer, Input, Rng>::GetSpecializedTableSize()
+	{
+#if CHIP8_CONSTEXPR_DECODE
+		if constexpr (IsDynamic)
+			return sizeof(SpecializedHandlers::Table);
+#endif // CHIP8_CONSTEXPR_DECODE
+		return 0;
+	}
+
+#pragma endregion
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetFonts()
+	{
+		memcpy(MemoryMapping.data(), FontSprites.data(), FontSprites.size());
+	}
+
+#pragma region Opcode Categories
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode0(const uint16_t opcode)
+	{
+		switch (opcode & 0xFF)
+		{
+		case 0xE0:
+			return CLS();
+		case 0xEE:
+			return RET();
+		default:
+			return OpcodeStatus::NotImplemented;    // SYS addr is ignored
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode1(const uint16_t opcode)
+	{
+		uint16_t address = opcode & 0x0FFF;
+		return JP(address);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode2(const uint16_t opcode)
+	{
+		uint16_t address = opcode & 0xFFF;
+		return CALL(address);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode3(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+		uint8_t value = opcode & 0xFF;
+		return SE_VX_BYTE(register_index, value);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode4(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+		uint8_t value = opcode & 0xFF;
+		return SNE_VX_BYTE(register_index, value);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode5(const uint16_t opcode)
+	{
+		uint8_t register_vx_index = (opcode >> 8) & 0xF;
+		uint8_t register_vy_index = (opcode >> 4) & 0xF;
+		return SE_VX_VY(register_vx_index, register_vy_index);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode6(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+		uint8_t register_value = opcode & 0xFF;
+		return LD_VX_BYTE(register_index, register_value);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode7(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+		uint8_t value = opcode & 0xFF;
+		return ADD_VX_BYTE(register_index, value);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode8(const uint16_t opcode)
+	{
+		uint8_t registerX_index = (opcode >> 8) & 0xF;
+		uint8_t registerY_index = (opcode >> 4) & 0xF;
+
+		switch (opcode & 0xF)
+		{
+		case 0x0:
+			return LD_VX_VY(registerX_index, registerY_index);
+		case 0x1:
+			return OR_VX_VY(registerX_index, registerY_index);
+		case 0x2:
+			return AND_VX_VY(registerX_index, registerY_index);
+		case 0x3:
+			return XOR_VX_VY(registerX_index, registerY_index);
+		case 0x4:
+			return ADD_VX_VY(registerX_index, registerY_index);
+		case 0x5:
+			return SUB_VX_VY(registerX_index, registerY_index);
+		case 0x6:
+			return SHR_VX_VY(registerX_index, registerY_index);
+		case 0x7:
+			return SUBN_VX_VY(registerX_index, registerY_index);
+		case 0xE:
+			return SHL_VX_VY(registerX_index, registerY_index);
+		default:
+			return OpcodeStatus::NotImplemented;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::Opcode9(const uint16_t opcode)
+	{
+		uint8_t registerX_index = (opcode >> 8) & 0xF;
+		uint8_t registerY_index = (opcode >> 4) & 0xF;
+		return SNE_VX_VY(registerX_index, registerY_index);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OpcodeA(const uint16_t opcode)
+	{
+		uint16_t Addr = (opcode & 0xFFF);
+		return LD_I_ADDR(Addr);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OpcodeB(const uint16_t opcode)
+	{
+		uint16_t address = (opcode & 0x0FFF);
+		return JP_V0_ADDR(address);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OpcodeC(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+		uint8_t random_mask = opcode & 0xFF;
+		return RND_VX_BYTE(register_index, random_mask);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OpcodeD(const uint16_t opcode)
+	{
+		uint8_t registerX_index = (opcode >> 8) & 0xF;
+		uint8_t registerY_index = (opcode >> 4) & 0xF;
+		uint8_t sprite_height = opcode & 0xF;
+		return DRW_VX_VY_NIBBLE(registerX_index, registerY_index, sprite_height);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OpcodeE(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+		switch (opcode & 0xFF)
+		{
+		case 0x9E:
+			return SKP_VX(register_index);
+		case 0xA1:
+			return SKNP_VX(register_index);
+		default:
+			return OpcodeStatus::NotImplemented;
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OpcodeF(const uint16_t opcode)
+	{
+		uint8_t register_index = (opcode >> 8) & 0xF;
+
+		switch (opcode & 0xFF)
+		{
+		case 0x07:
+			return LD_VX_DT(register_index);
+		case 0x0A:
+			return LD_VX_K(register_index);
+		case 0x15:
+			return LD_DT_VX(register_index);
+		case 0x18:
+			return LD_ST_VX(register_index);
+		case 0x1E:
+			return ADD_I_VX(register_index);
+		case 0x29:
+			return LD_F_VX(register_index);
+		case 0x33:
+			return LD_B_VX(register_index);
+		case 0x55:
+			return LD_I_VX(register_index);
+		case 0x65:
+			return LD_VX_I(register_index);
+		default:
+			return OpcodeStatus::NotImplemented;
+		}
+	}
+
+#pragma endregion
+
+#pragma region Opcode Instructions
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::CLS()
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "CLS";
+#endif
+		Screen.fill(0);
+		PresentFrame();
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::RET()
+	{
+		if (State.SP > 0xF && State.SP < 0xFF)
+			return OpcodeStatus::StackOverflow;
+#ifdef DEBUG_BUILD
+		std::cout << "RET";
+#endif
+		State.PC = Stack[State.SP & 0xF];
+		State.SP -= 1;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::JP(uint16_t address)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "JP 0x" << address;
+#endif
+		State.PC = address;
+		return OpcodeStatus::NotIncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::CALL(uint16_t address)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "CALL 0x" << (int)address;
+#endif
+		if (State.SP > 0xF)
+		{
+			State.SP = 0;
+		}
+		else
+		{
+			if (State.SP < 0xF)
+			{
+				State.SP += 1;
+			}
+			else
+			{
+				return OpcodeStatus::StackOverflow;
+			}
+		}
+		Stack[State.SP] = State.PC;
+		State.PC = address;
+		return OpcodeStatus::NotIncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SE_VX_BYTE(uint8_t Vx, uint8_t byte)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "SE V" << (int)Vx << ", 0x" << (int)byte;
+#endif
+		if (State.Registers[Vx] == byte)
+			State.PC += 2;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SNE_VX_BYTE(uint8_t Vx, uint8_t byte)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "SNE V" << (int)Vx << ", 0x" << (int)byte;
+#endif
+		if (State.Registers[Vx] != byte)
+			State.PC += 2;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SE_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "SE V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		if (State.Registers[Vx] == State.Registers[Vy])
+			State.PC += 2;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_BYTE(uint8_t Vx, uint8_t byte)
+	{
+		State.Registers[Vx] = byte;
+#ifdef DEBUG_BUILD
+		std::cout << "LD V" << (int)Vx << ", 0x" << (int)byte;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::ADD_VX_BYTE(uint8_t Vx, uint8_t byte)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "ADD V" << (int)Vx << ", 0x" << (int)byte;
+#endif
+		State.Registers[Vx] += byte;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		State.Registers[Vx] = State.Registers[Vy];
+#ifdef DEBUG_BUILD
+		std::cout << "LD V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::OR_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		State.Registers[Vx] |= State.Registers[Vy];
+#ifdef DEBUG_BUILD
+		std::cout << "OR V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::AND_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		State.Registers[Vx] &= State.Registers[Vy];
+#ifdef DEBUG_BUILD
+		std::cout << "AND V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::XOR_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		State.Registers[Vx] ^= State.Registers[Vy];
+#ifdef DEBUG_BUILD
+		std::cout << "XOR V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::ADD_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		int result = static_cast<int>(State.Registers[Vx]) + State.Registers[Vy];
+		if (result > 255)
+			State.Registers[0xF] = 1;
+		else
+			State.Registers[0xF] = 0;
+		State.Registers[Vx] += State.Registers[Vy];
+#ifdef DEBUG_BUILD
+		std::cout << "ADD V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SUB_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		if (State.Registers[Vx] > State.Registers[Vy])
+			State.Registers[0xF] = 1;
+		else
+			State.Registers[0xF] = 0;
+		State.Registers[Vx] -= State.Registers[Vy];
+#ifdef DEBUG_BUILD
+		std::cout << "SUB V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SHR_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		return WithQuirkPolicy(Profile, [&]<typename Quirks>() { return SHR_VX_VY<Quirks>(Vx, Vy); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SUBN_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		if (State.Registers[Vy] > State.Registers[Vx])
+			State.Registers[0xF] = 1;
+		else
+			State.Registers[0xF] = 0;
+		State.Registers[Vx] = State.Registers[Vy] - State.Registers[Vx];
+#ifdef DEBUG_BUILD
+		std::cout << "SUBN V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SHL_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		return WithQuirkPolicy(Profile, [&]<typename Quirks>() { return SHL_VX_VY<Quirks>(Vx, Vy); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SNE_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		if (State.Registers[Vx] != State.Registers[Vy])
+		{
+			State.PC += 2;
+		}
+#ifdef DEBUG_BUILD
+		std::cout << "SNE V" << (int)Vx << ", V" << (int)Vy;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_I_ADDR(uint16_t address)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD I, 0x" << (int)address;
+#endif
+		State.I = address;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::JP_V0_ADDR(uint16_t address)
+	{
+		return WithQuirkPolicy(Profile, [&]<typename Quirks>() { return JP_V0_ADDR<Quirks>(address); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::RND_VX_BYTE(uint8_t Vx, uint8_t bytemask)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "RND V" << (int)Vx << ", 0x" << (int)bytemask;
+#endif
+		State.Registers[Vx] = random_generator->GetRandomByte() & bytemask;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::DRW_VX_VY_NIBBLE(uint8_t Vx, uint8_t Vy, uint8_t n_byte)
+	{
+		return WithQuirkPolicy(Profile, DoWrap, [&]<typename Quirks>() { return DRW_VX_VY_NIBBLE<Quirks>(Vx, Vy, n_byte); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SKP_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "SKP V" << (int)Vx;
+#endif
+		if (input_class->IsKeyPressed(INT_AS_KEY(State.Registers[Vx])))
+		{
+			State.PC += 2;
+		}
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SKNP_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "SKNP V" << (int)Vx;
+#endif
+		if (!input_class->IsKeyPressed(INT_AS_KEY(State.Registers[Vx])))
+		{
+			State.PC += 2;
+		}
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_DT(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD V" << (int)Vx << ", DT";
+#endif
+		State.Registers[Vx] = State.DelayTimer;
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_K(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD V" << (int)Vx << ", K";
+#endif
+		State.WaitForKeyboardRegister_Index = Vx;
+		State.Suspended = true;
+		return OpcodeStatus::WaitForKeyboard;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_DT_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD DT, V" << (int)Vx;
+#endif
+		State.DelayTimer = State.Registers[Vx];
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_ST_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD ST, V" << (int)Vx;
+#endif
+		State.SoundTimer = State.Registers[Vx];
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::ADD_I_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "ADD I, V" << (int)Vx;
+#endif
+		State.I += State.Registers[Vx];
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_F_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD F, V" << (int)Vx;
+#endif
+		State.I = 5 * State.Registers[Vx];
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_B_VX(uint8_t Vx)
+	{
+		uint8_t value = State.Registers[Vx];
+		MemoryMapping[State.I] = value / 100;
+		MemoryMapping[State.I + 1] = (value - (MemoryMapping[State.I] * 100)) / 10; // ONE BUG WAS HERE
+		MemoryMapping[State.I + 2] = value % 10;
+		InvalidateCode(State.I, State.I + 2);
+#ifdef DEBUG_BUILD
+		std::cout << "LD B, V" << (int)Vx;
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_I_VX(uint8_t Vx)
+	{
+		return WithQuirkPolicy(Profile, [&]<typename Quirks>() { return LD_I_VX<Quirks>(Vx); });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_I(uint8_t Vx)
+	{
+		return WithQuirkPolicy(Profile, [&]<typename Quirks>() { return LD_VX_I<Quirks>(Vx); });
+	}
+
+#pragma endregion
+#pragma region Quirky Instructions
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SHR_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		const uint8_t Vs = Quirks::ShiftReadsVy ? Vy : Vx;
+		State.Registers[0xF] = State.Registers[Vs] & 0x1;
+		State.Registers[Vx] = State.Registers[Vs] >> 1;
+#ifdef DEBUG_BUILD
+		std::cout << "SHR V" << (int)Vx << "{, V" << (int)Vy << "}";
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SHL_VX_VY(uint8_t Vx, uint8_t Vy)
+	{
+		const uint8_t Vs = Quirks::ShiftReadsVy ? Vy : Vx;
+		State.Registers[0xF] = State.Registers[Vs] >> 7;
+		State.Registers[Vx] = State.Registers[Vs] << 1;
+#ifdef DEBUG_BUILD
+		std::cout << "SHL V" << (int)Vx << "{, V" << (int)Vy << "}";
+#endif
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::JP_V0_ADDR(uint16_t address)
+	{
+		const uint8_t Vx = Quirks::JumpReadsVx ? detail::OperandX(address) : 0x0;
+#ifdef DEBUG_BUILD
+		std::cout << "JP V" << (int)Vx << ", 0x" << address;
+#endif
+		State.PC = address + State.Registers[Vx];
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_I_VX(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD [I], V" << (int)Vx;
+#endif
+		for (uint8_t i = 0; i <= Vx; ++i)   // ONE BUG WAS HERE
+		{
+			MemoryMapping[State.I + i] = State.Registers[i];
+		}
+		InvalidateCode(State.I, State.I + Vx);
+		if constexpr (Quirks::LoadStoreAdvancesI)
+		{
+			State.I += Vx + 1;
+		}
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_I(uint8_t Vx)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "LD V" << (int)Vx << ", [I]";
+#endif
+		for (uint8_t i = 0; i <= Vx; ++i)   //ONE BUG WAS HERE
+		{
+			State.Registers[i] = MemoryMapping[State.I + i];    //ONE BUG WAS HERE
+		}
+		if constexpr (Quirks::LoadStoreAdvancesI)
+		{
+			State.I += Vx + 1;
+		}
+		return OpcodeStatus::IncrementPC;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::DRW_VX_VY_NIBBLE(uint8_t Vx, uint8_t Vy, uint8_t n_byte)
+	{
+#ifdef DEBUG_BUILD
+		std::cout << "DRW V" << (int)Vx << ", V" << (int)Vy << ", " << (int)n_byte;
+#endif
+
+		const uint8_t x_coord = State.Registers[Vx] % width;
+		const uint8_t y_coord = State.Registers[Vy] % height;
+		bool collision = false;
+
+		// the 8 columns the sprite covers, cut at the right edge unless it wraps
+		const uint64_t columns = Quirks::WrapSprites ? std::rotr(0xFFull << 56, x_coord) : (0xFFull << 56) >> x_coord;
+		for (int sprite_row = 0; sprite_row < n_byte; ++sprite_row)
+		{
+			int row = sprite_row + y_coord;
+			if (row >= height)
+			{
+				if constexpr (!Quirks::WrapSprites)
+					break;
+				row %= height;
+			}
+
+			const uint64_t line = static_cast<uint64_t>(MemoryMapping[(State.I + sprite_row) & 0xFFF]) << 56;
+			const uint64_t bits = Quirks::WrapSprites ? std::rotr(line, x_coord) : line >> x_coord;
+			// a lit pixel the sprite leaves lit counts as a collision, the rule the SDL texture readback always had
+			if (Screen[row] & ~bits & columns)
+			{
+				collision = true;
+			}
+			Screen[row] ^= bits;
+		}
+		PresentFrame();
+
+		if (collision)
+		{
+			State.Registers[0xF] = 0x1;
+		}
+
+		return OpcodeStatus::IncrementPC;
+	}
+
+#pragma endregion
+#pragma region Fused Instructions
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_BYTE_ADD_I_VY(const DecodedInstruction& instruction)
+	{
+		++FusionHits[static_cast<uint8_t>(Instruction::LD_VX_BYTE_ADD_I_VY) - FirstFusedInstruction];
+		LD_VX_BYTE(instruction.x, instruction.nn);
+		State.PC += 2;
+		++InstructionCount;
+		return ADD_I_VX(instruction.y);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	template<typename Quirks>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_I_ADDR_DRW(const DecodedInstruction& instruction)
+	{
+		++FusionHits[static_cast<uint8_t>(Instruction::LD_I_ADDR_DRW) - FirstFusedInstruction];
+		LD_I_ADDR(instruction.nnn);
+		State.PC += 2;
+		++InstructionCount;
+		return DRW_VX_VY_NIBBLE<Quirks>(instruction.x, instruction.y, instruction.n);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SE_VX_BYTE_JP(const DecodedInstruction& instruction)
+	{
+		++FusionHits[static_cast<uint8_t>(Instruction::SE_VX_BYTE_JP) - FirstFusedInstruction];
+		// a taken skip lands past the jump, which never runs
+		if (State.Registers[instruction.x] == instruction.nn)
+			return SE_VX_BYTE(instruction.x, instruction.nn);
+		++InstructionCount;
+		return JP(instruction.nnn);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::SNE_VX_BYTE_JP(const DecodedInstruction& instruction)
+	{
+		++FusionHits[static_cast<uint8_t>(Instruction::SNE_VX_BYTE_JP) - FirstFusedInstruction];
+		if (State.Registers[instruction.x] != instruction.nn)
+			return SNE_VX_BYTE(instruction.x, instruction.nn);
+		++InstructionCount;
+		return JP(instruction.nnn);
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	OpcodeStatus BasicEmulator<Renderer, Input, Rng>::LD_VX_DT_SE_JP(const DecodedInstruction& instruction)
+	{
+		++FusionHits[static_cast<uint8_t>(Instruction::LD_VX_DT_SE_JP) - FirstFusedInstruction];
+		LD_VX_DT(instruction.x);
+		State.PC += 2;
+		++InstructionCount;
+		if (State.Registers[instruction.x] == instruction.nn)
+			return SE_VX_BYTE(instruction.x, instruction.nn);
+		++InstructionCount;
+		return JP(instruction.nnn);
+	}
+
+#pragma endregion
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::HardResetEmulator()
+	{
+		State = {};
+
+		memset(MemoryMapping.data(), 0, MemoryMapping.size() * sizeof(uint8_t));
+		memset(Stack.data(), 0, Stack.size() * sizeof(uint16_t));
+		DecodeCache.fill({});
+		BlockCache.fill({});
+		FlushJit();
+		StaticBlocks.clear();
+
+		SetFonts();
+
+		Screen.fill(0);
+		PresentFrame();
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::PresentFrame()
+	{
+		if (renderer)
+		{
+			renderer->DrawFrame(Screen);
+		}
+	}
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetDoWrap(const bool do_wrap)
+	{
+		DoWrap = do_wrap;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetQuirkProfile(const QuirkProfile profile)
+	{
+		if (profile != Profile)
+		{
+			// compiled blocks have the shifts of the old profile baked in
+			BlockCache.fill({});
+			FlushJit();
+		}
+		Profile = profile;
+		DoWrap = WithQuirkPolicy(profile, []<typename Quirks>() { return Quirks::WrapSprites; });
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetDispatchMode(const DispatchMode mode)
+	{
+		if (mode != Dispatch)
+		{
+			// the engines disagree on superinstructions, so nothing decoded by one is handed to another
+			DecodeCache.fill({});
+			BlockCache.fill({});
+			FlushJit();
+		}
+		Dispatch = mode;
+#if !CHIP8_COMPUTED_GOTO
+		if (Dispatch == DispatchMode::Threaded)
+		{
+			Dispatch = DispatchMode::Switch;
+		}
+#endif // !CHIP8_COMPUTED_GOTO
+#if !CHIP8_CONSTEXPR_DECODE
+		if (Dispatch == DispatchMode::Specialized)
+		{
+			Dispatch = DispatchMode::Switch;
+		}
+#endif // !CHIP8_CONSTEXPR_DECODE
+#if !CHIP8_HAS_JIT
+		if (Dispatch == DispatchMode::Jit)
+		{
+			Dispatch = DispatchMode::Block;
+		}
+#endif // !CHIP8_HAS_JIT
+		if constexpr (!IsDynamic)
+		{
+			if (Dispatch == DispatchMode::Jit || Dispatch == DispatchMode::Static)
+			{
+				Dispatch = DispatchMode::Block;
+			}
+			else if (Dispatch == DispatchMode::Specialized)
+			{
+				Dispatch = DispatchMode::Switch;
+			}
+		}
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetIdleSkipEnabled(const bool enabled)
+	{
+		IdleSkipEnabled = enabled;
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetFusionEnabled(const bool enabled)
+	{
+		FusionEnabled = enabled;
+		DecodeCache.fill({});
+	}
+
+	template<typename Renderer, typename Input, typename Rng>
+	void BasicEmulator<Renderer, Input, Rng>::SetStaticProgram(const StaticProgram* program)
+	{
+		Program = program;
+		ActivateStaticProgram();
+	}
+}
\ No newline at end of file
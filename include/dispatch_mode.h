@@ -0,0 +1,31 @@
+#pragma once
+
+#include "export.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CHIP8_COMPUTED_GOTO 1
+#else
+#define CHIP8_COMPUTED_GOTO 0
+#endif // __GNUC__ || __clang__
+
+namespace chipotto
+{
+	enum class CHIP8_API DispatchMode
+	{
+		// std::function table indexed by the high nibble, then the per-category handler
+		Table,
+		// single switch that decodes the whole opcode and calls the instruction directly
+		Switch,
+		// direct-threaded computed goto, only available on GCC/Clang (falls back to Switch)
+		Threaded,
+		// runs whole cached basic blocks, Tick executes one block instead of one instruction
+		Block,
+		// Block, with hot blocks compiled to x86-64, only available with CHIP8_ENABLE_JIT on x86-64 (falls back to Block)
+		Jit,
+		// Block, with the blocks of a program attached by SetStaticProgram running as ahead-of-time compiled code
+		Static,
+		// constexpr table of all 64K opcodes pointing at handlers specialized on their registers,
+		// only available when built with CHIP8_CONSTEXPR_DECODE (falls back to Switch)
+		Specialized
+	};
+}
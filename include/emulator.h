@@ -1,13 +1,15 @@
 #pragma once
 #include "export.h"
+#include <cstdint>
+#include "dispatch_mode.h"
+#include "emulator_fwd.h"
+#include "quirks.h"
+#include "run_status.h"
 
 namespace chipotto
 {
-	class IInputCommand;
-	class EmuRenderer;
-	class IRandomGenerator;
-	class EmulatorImpl;
 	class Gamefile;
+	struct StaticProgram;
 
 	class CHIP8_API Emulator
 	{
@@ -19,10 +21,25 @@ namespace chipotto
 
 		bool Tick(const float deltatime);
 
+		RunStatus RunCycles(const uint32_t cycle_count);
+
+		RunStatus RunFrame();
+
+		void SetInstructionsPerFrame(const uint32_t instructions_per_frame);
+
+		// true while FX0A waits with both timers stopped, the host can sleep until the next input event
+		bool IsBlockedOnKey() const;
+
 		void HardResetEmulator();
 
 		void SetDoWrap(const bool do_wrap);
 
+		void SetQuirkProfile(const QuirkProfile profile);
+
+		void SetDispatchMode(const DispatchMode mode);
+
+		void SetStaticProgram(const StaticProgram* program);
+
 	private:
 		EmulatorImpl* impl;
 	};
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace chipotto
+{
+	class EmuRenderer;
+	class IInputCommand;
+	class IRandomGenerator;
+
+	template<typename Renderer, typename Input, typename Rng>
+	class BasicEmulator;
+
+	// the core behind Emulator, it reaches its backends through their virtual interfaces
+	using EmulatorImpl = BasicEmulator<EmuRenderer, IInputCommand, IRandomGenerator>;
+}
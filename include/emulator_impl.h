@@ -4,18 +4,24 @@
 #include <array>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
+#include "dispatch_mode.h"
+#include "emulator_fwd.h"
 #include "gamefile.h"
+#include "jit/jit_compiler.h"
+#include "quirks.h"
+#include "renderer.h"
+#include "run_status.h"
 
 
-#define SIXTYHERTZ_S 0.017
-
 namespace chipotto
 {
-	class IInputCommand;
-	class EmuRenderer;
-	class IRandomGenerator;
+	struct StaticProgram;
+	struct StaticBlock;
 
 	enum class CHIP8_API OpcodeStatus
 	{
@@ -27,26 +33,371 @@ namespace chipotto
 		Error
 	};
 
-	 class CHIP8_API EmulatorImpl
+	// a run of straight-line instructions ending at the first one that can change PC, draw, wait or write memory
+	struct CHIP8_API BasicBlock
+	{
+		// number of instructions including the terminator, 0 marks a block that is not built yet
+		uint16_t length = 0;
+		// executions so far, the block is compiled once it reaches the JIT threshold
+		uint16_t hits = 0;
+		// compiled code, only used by DispatchMode::Jit
+		JitBlockFunction native = nullptr;
+	};
+
+	// one entry per instruction handler, Undecoded marks an empty slot of the decode cache
+	enum class CHIP8_API Instruction : uint8_t
+	{
+		Undecoded,
+		NotImplemented,
+		CLS,
+		RET,
+		JP,
+		CALL,
+		SE_VX_BYTE,
+		SNE_VX_BYTE,
+		SE_VX_VY,
+		LD_VX_BYTE,
+		ADD_VX_BYTE,
+		LD_VX_VY,
+		OR_VX_VY,
+		AND_VX_VY,
+		XOR_VX_VY,
+		ADD_VX_VY,
+		SUB_VX_VY,
+		SHR_VX_VY,
+		SUBN_VX_VY,
+		SHL_VX_VY,
+		SNE_VX_VY,
+		LD_I_ADDR,
+		JP_V0_ADDR,
+		RND_VX_BYTE,
+		DRW_VX_VY_NIBBLE,
+		SKP_VX,
+		SKNP_VX,
+		LD_VX_DT,
+		LD_VX_K,
+		LD_DT_VX,
+		LD_ST_VX,
+		ADD_I_VX,
+		LD_F_VX,
+		LD_B_VX,
+		LD_I_VX,
+		LD_VX_I,
+		// superinstructions, produced only by the Switch and Threaded engines
+		// 6XNN + FY1E
+		LD_VX_BYTE_ADD_I_VY,
+		// ANNN + DXYN
+		LD_I_ADDR_DRW,
+		// 3XNN + 1NNN
+		SE_VX_BYTE_JP,
+		// 4XNN + 1NNN
+		SNE_VX_BYTE_JP,
+		// FX07 + 3XNN + 1NNN, the delay timer polling loop
+		LD_VX_DT_SE_JP,
+		Count
+	};
+
+	constexpr uint8_t FirstFusedInstruction = static_cast<uint8_t>(Instruction::LD_VX_BYTE_ADD_I_VY);
+	constexpr uint8_t FusedInstructionCount = static_cast<uint8_t>(Instruction::Count) - FirstFusedInstruction;
+
+	// an opcode with its operands already unpacked
+	struct CHIP8_API DecodedInstruction
+	{
+		Instruction id = Instruction::Undecoded;
+		uint8_t x = 0;
+		uint8_t y = 0;
+		uint8_t n = 0;
+		uint8_t nn = 0;
+		uint16_t nnn = 0;
+	};
+
+	/// <summary>
+	/// Everything an instruction reads or writes besides memory and the stack, packed into one cache line.
+	/// It is trivially copyable, so saving or restoring the registers and timers is a single copy.
+	/// </summary>
+	struct alignas(64) MachineState
 	{
+		std::array<uint8_t, 0x10> Registers{};
+		uint16_t I = 0x0;
+		uint16_t PC = 0x200;
+		uint8_t SP = 0xFF;
+		uint8_t DelayTimer = 0x0;
+		uint8_t SoundTimer = 0x0;
+		bool Suspended = false;
+		uint8_t WaitForKeyboardRegister_Index = 0;
+		// instructions since the timers last stepped, they step every instructions per frame
+		uint32_t CyclesSinceTimerStep = 0;
+		// run past the end of the last RunCycles budget by a fused instruction or a block, taken off the next budget
+		uint32_t OverrunCycles = 0;
+		// emulated time in instructions since the last reset, waiting on FX0A counts as well
+		uint64_t Cycles = 0;
+	};
+
+	static_assert(sizeof(MachineState) == 64, "MachineState has to stay within one cache line");
+	static_assert(std::is_trivially_copyable_v<MachineState>, "MachineState has to be copyable with memcpy");
+
+	/// <summary>
+	/// The CHIP-8 core, calling its backends through the given types.
+	/// EmulatorImpl instantiates it with the virtual interfaces; with final or non-virtual backends known at compile time,
+	/// every draw, key check and random byte is a direct call the compiler can inline. Only EmulatorImpl runs
+	/// DispatchMode::Jit, Static and Specialized, the other instantiations fall back to Block and Switch.
+	/// </summary>
+	template<typename Renderer, typename Input, typename Rng>
+	class BasicEmulator
+	{
+		friend class JitCompiler;
+		friend class StaticRuntime;
+
+		// the JIT, the generated static programs and the opcode table are built for EmulatorImpl only
+		static constexpr bool IsDynamic = std::is_same_v<BasicEmulator, EmulatorImpl>;
+
 	public:
-		EmulatorImpl() = delete;
-		EmulatorImpl(EmuRenderer* renderer, IInputCommand* input, IRandomGenerator* random_generator);
-		~EmulatorImpl();
+		BasicEmulator() = delete;
+		BasicEmulator(Renderer* renderer, Input* input, Rng* random_generator);
+		~BasicEmulator();
 
-		EmulatorImpl(const EmulatorImpl& other) = delete;
-		EmulatorImpl& operator=(const EmulatorImpl& other) = delete;
-		EmulatorImpl(EmulatorImpl&& other) = delete;
+		BasicEmulator(const BasicEmulator& other) = delete;
+		BasicEmulator& operator=(const BasicEmulator& other) = delete;
+		BasicEmulator(BasicEmulator&& other) = delete;
 
 		bool Load(const Gamefile* gamefile);
 
+		/// <summary>
+		/// Handles the pending input, then executes one instruction, or one block with the block engines.
+		/// The timers follow the instructions executed, deltatime is ignored and only kept for existing callers.
+		/// </summary>
+		/// <returns>false on error or quit, true otherwise</returns>
 		bool Tick(const float deltatime);
 
+		/// <summary>
+		/// Executes up to instruction_count instructions back to back, without the timer and input bookkeeping of Tick.
+		/// Stops early if the machine suspends waiting for a key or an opcode fails.
+		/// </summary>
+		/// <param name="instruction_count">the maximum number of instructions to execute</param>
+		/// <returns>false on error, true otherwise</returns>
+		bool RunInstructions(const uint32_t instruction_count);
+
+		/// <summary>
+		/// Handles the pending input, then advances the machine by cycle_count instructions of emulated time.
+		/// The delay and sound timers step once every GetInstructionsPerFrame() instructions, which is 1/60 s of emulated time,
+		/// and the engines stop at every step, so a run depends only on the ROM and the input it receives.
+		/// Time keeps passing while FX0A waits for a key.
+		/// </summary>
+		/// <param name="cycle_count">the instruction budget, fused instructions and the block engines may run a few past it</param>
+		/// <returns>why the call returned</returns>
+		RunStatus RunCycles(const uint32_t cycle_count);
+
+		/// <summary>
+		/// Emulates one 60 Hz frame, RunCycles(GetInstructionsPerFrame()).
+		/// Call it 60 times per second and the machine runs at 60 * GetInstructionsPerFrame() instructions per second.
+		/// </summary>
+		/// <returns>why the call returned</returns>
+		RunStatus RunFrame();
+
+		// true while FX0A waits with both timers stopped, only a key can change the machine until then
+		inline bool IsBlockedOnKey() const { return State.Suspended && State.DelayTimer == 0 && State.SoundTimer == 0; }
+
+		// 10 by default, about 600 instructions per second; it is also the timer period in instructions, at least 1
+		void SetInstructionsPerFrame(const uint32_t instructions_per_frame);
+
+		inline uint32_t GetInstructionsPerFrame() const { return InstructionsPerFrame; }
+
 		void HardResetEmulator();
 
 		void SetDoWrap(const bool do_wrap);
 
+		/// <summary>
+		/// Selects how the opcodes that differ between CHIP-8, SUPER-CHIP and XO-CHIP behave, call it before Load.
+		/// Every engine is compiled once per profile, so the running code never checks a quirk; sprite wrapping
+		/// follows the profile and SetDoWrap afterwards switches to the engines compiled with the other wrapping.
+		/// </summary>
+		/// <param name="profile">the platform the next ROM was written for</param>
+		void SetQuirkProfile(const QuirkProfile profile);
+
+		inline QuirkProfile GetQuirkProfile() const { return Profile; }
+
+		void SetDispatchMode(const DispatchMode mode);
+
+		inline DispatchMode GetDispatchMode() const { return Dispatch; }
+
+		/// <summary>
+		/// Attaches a program generated by Chip8Aot, run by DispatchMode::Static.
+		/// Its blocks are used only while the loaded ROM matches the one it was generated from.
+		/// </summary>
+		/// <param name="program">the generated program, nullptr detaches it</param>
+		void SetStaticProgram(const StaticProgram* program);
+
+		// size in bytes of the opcode table used by DispatchMode::Specialized, 0 if the library was built without it
+		static size_t GetSpecializedTableSize();
+
+		// emulated time in instructions since the last HardResetEmulator, advanced by Tick, RunCycles and RunFrame
+		inline uint64_t GetCycles() const { return State.Cycles; }
+
+		// instructions retired since construction, HardResetEmulator does not clear it
+		inline uint64_t GetInstructionCount() const { return InstructionCount; }
+
+		// lets the Switch and Threaded engines fuse common instruction sequences, on by default
+		void SetFusionEnabled(const bool enabled);
+
+		inline bool GetFusionEnabled() const { return FusionEnabled; }
+
+		/// <summary>
+		/// Lets RunCycles and RunFrame recognize the loops a ROM waits in and jump over their iterations instead of running them:
+		/// a JP to itself, a key poll SKP/SKNP + JP, and the delay timer poll FX07 + 3XNN + JP. The skipped iterations
+		/// would not change anything but the cycle count, the timers and the polled register, so the run ends in the same state
+		/// as with the loop interpreted one instruction at a time. On by default.
+		/// </summary>
+		void SetIdleSkipEnabled(const bool enabled);
+
+		inline bool GetIdleSkipEnabled() const { return IdleSkipEnabled; }
+
+		// instructions of emulated time fast-forwarded in idle loops since construction, they are not in GetInstructionCount
+		inline uint64_t GetIdleCycles() const { return IdleCycles; }
+
+		/// <summary>
+		/// Whole frames the machine is certain to spend in the idle loop at PC, whatever the keys do: until the delay timer
+		/// reads the awaited value for FX07 + 3XNN + JP, IdleForever for a JP to itself or a value DT never reaches.
+		/// A scheduler can skip that many frames and catch up with one RunCycles call, which jumps over the loop.
+		/// </summary>
+		uint32_t GetIdleFrames() const;
+
+		static constexpr uint32_t IdleForever = UINT32_MAX;
+
+		// registers, PC, I, stack pointer and timers; memory, the stack and the caches are not part of it
+		inline const MachineState& GetMachineState() const { return State; }
+
+		// memory is left as it is, so the caches stay valid
+		inline void SetMachineState(const MachineState& state) { State = state; }
+
+		// times a superinstruction ran since the last Load
+		inline uint64_t GetFusionHits(const Instruction fused) const { return FusionHits[static_cast<uint8_t>(fused) - FirstFusedInstruction]; }
+
+		// the screen as the ROM drew it, one uint64_t per row with bit 63 as the leftmost pixel
+		inline const Framebuffer& GetFramebuffer() const { return Screen; }
+
 	private:
+#pragma region Dispatch
+
+		uint16_t ReadOpcode(const uint16_t address) const;
+
+		uint16_t FetchOpcode() const;
+
+		DecodedInstruction& FetchDecoded();
+
+		// drops the cached decodes and blocks covering [first, last], call on every memory write
+		void InvalidateCode(const uint16_t first, const uint16_t last);
+
+		static bool IsBlockTerminator(const Instruction id);
+
+		void BuildBlock(BasicBlock& block, const uint16_t start);
+
+		static DecodedInstruction Decode(const uint16_t opcode);
+
+		// decodes the instruction at address and fuses it with the next ones when the engine supports it
+		DecodedInstruction DecodeAt(const uint16_t address) const;
+
+		// superinstructions read up to this many instructions, InvalidateCode has to reach back that far
+		static constexpr uint16_t MaxFusionLength = 3;
+
+		static bool IsErrorStatus(const OpcodeStatus status);
+
+		// drains the input events, a key press completes a waiting FX0A; returns false on quit
+		bool PollInput();
+
+		// one 60 Hz step of the delay and sound timers
+		void StepTimers();
+
+		// moves emulated time forward, stepping the timers on every frame boundary it crosses
+		void AdvanceClock(const uint64_t cycles);
+
+		// a loop starting at PC that only waits, as far as the idle loop detection can tell
+		struct IdleLoop
+		{
+			enum class Kind : uint8_t { None, Halt, KeyPoll, DelayPoll };
+			Kind kind = Kind::None;
+			// the register the loop reads, and for DelayPoll the value it waits for
+			uint8_t x = 0;
+			uint8_t nn = 0;
+			// SKP loops until the key is down, SKNP until it is up
+			bool waits_for_press = false;
+		};
+
+		IdleLoop MatchIdleLoop() const;
+
+		// fast-forwards whole iterations of the idle loop starting at PC, if any, within cycle_budget; returns the cycles skipped
+		uint64_t SkipIdleLoop(const uint64_t cycle_budget);
+
+		// instructions between two idle loop checks; prime, so a loop of 2 or 3 instructions is met at its start within a few checks
+		static constexpr uint32_t IdleCheckInterval = 61;
+
+		bool RetireInstruction(const OpcodeStatus status);
+
+		// every loop returns the number of executed instructions and stores the status of the last one
+		// this one resolves the quirk profile, the loops below are instantiated per QuirkPolicy
+		uint32_t ExecuteInstructions(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		template<typename Quirks>
+		uint32_t ExecuteInstructions(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		// reaches the quirky handlers through their runtime checked overloads
+		uint32_t ExecuteTable(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		template<typename Quirks>
+		uint32_t ExecuteSwitch(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		template<typename Quirks>
+		uint32_t ExecuteThreaded(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		// may run past instruction_count to finish the block it started
+		template<typename Quirks>
+		uint32_t ExecuteBlocks(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		// runs compiled blocks, interpreting the ones that are not hot yet
+		template<typename Quirks>
+		uint32_t ExecuteJit(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		BasicBlock& FetchBlock();
+
+		// interprets the block at PC, returns false when execution has to stop
+		template<typename Quirks>
+		bool RunBlock(const BasicBlock& block, uint32_t& executed, OpcodeStatus& out_status);
+
+		// steps an instruction the caches cannot hold, returns false when execution has to stop
+		template<typename Quirks>
+		bool StepUncached(uint32_t& executed, OpcodeStatus& out_status);
+
+		void CompileBlock(BasicBlock& block, const uint16_t start);
+
+		// forgets every compiled block and recycles the code buffer
+		void FlushJit();
+
+		// runs the blocks of the attached static program, interpreting everything it does not cover
+		template<typename Quirks>
+		uint32_t ExecuteStatic(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		// enables the static blocks if the loaded ROM is the one they were generated from
+		void ActivateStaticProgram();
+
+		// the constexpr opcode table and its handlers, defined only with CHIP8_CONSTEXPR_DECODE
+		struct SpecializedHandlers;
+
+		// the table is built once for all profiles, its quirky handlers check the profile at runtime
+		uint32_t ExecuteSpecialized(const uint32_t instruction_count, OpcodeStatus& out_status);
+
+		// for callers outside the engines, like the JIT and static program fallbacks
+		OpcodeStatus Execute(DecodedInstruction& instruction);
+
+		template<typename Quirks>
+		OpcodeStatus Execute(DecodedInstruction& instruction);
+
+		// fused handlers retire their extra instructions into InstructionCount themselves
+		OpcodeStatus LD_VX_BYTE_ADD_I_VY(const DecodedInstruction& instruction);
+		template<typename Quirks> OpcodeStatus LD_I_ADDR_DRW(const DecodedInstruction& instruction);
+		OpcodeStatus SE_VX_BYTE_JP(const DecodedInstruction& instruction);
+		OpcodeStatus SNE_VX_BYTE_JP(const DecodedInstruction& instruction);
+		OpcodeStatus LD_VX_DT_SE_JP(const DecodedInstruction& instruction);
+
+#pragma endregion
 #pragma region Opcode Categories
 
 #ifdef EMU_TEST
@@ -123,58 +474,97 @@ namespace chipotto
 		OpcodeStatus LD_I_VX(uint8_t Vx);
 		OpcodeStatus LD_VX_I(uint8_t Vx);
 #pragma endregion
+#pragma region Quirky Instructions
+		// one instantiation per QuirkPolicy, the untemplated overloads above pick it from the active profile
+		template<typename Quirks> OpcodeStatus SHR_VX_VY(uint8_t Vx, uint8_t Vy);
+		template<typename Quirks> OpcodeStatus SHL_VX_VY(uint8_t Vx, uint8_t Vy);
+		template<typename Quirks> OpcodeStatus JP_V0_ADDR(uint16_t address);
+		template<typename Quirks> OpcodeStatus LD_I_VX(uint8_t Vx);
+		template<typename Quirks> OpcodeStatus LD_VX_I(uint8_t Vx);
+		template<typename Quirks> OpcodeStatus DRW_VX_VY_NIBBLE(uint8_t Vx, uint8_t Vy, uint8_t n_byte);
+#pragma endregion
 
 #ifdef EMU_TEST
 	public:
-		inline uint16_t GetPC() const {return PC;}
-		inline uint16_t GetI() const {return I;}
-		inline void SetI(const uint16_t new_i) {I = new_i;}
-		inline void SetSP(const uint8_t new_sp) {SP = new_sp;}
-		inline uint8_t GetSP() const {return SP;}
-		inline bool GetIsSuspended() const {return Suspended;}
+		inline uint16_t GetPC() const {return State.PC;}
+		inline void SetPC(const uint16_t new_pc) {State.PC = new_pc;}
+		inline uint16_t GetI() const {return State.I;}
+		inline void SetI(const uint16_t new_i) {State.I = new_i;}
+		inline void SetSP(const uint8_t new_sp) {State.SP = new_sp;}
+		inline uint8_t GetSP() const {return State.SP;}
+		inline bool GetIsSuspended() const {return State.Suspended;}
 		inline int GetWidth() const {return width;}
 		inline int GetHeight() const {return height;}
-		inline uint8_t GetDelayTimer() const {return DelayTimer;}
-		inline uint8_t GetSoundTimer() const {return SoundTimer;}
-		inline std::array<uint8_t, 0x1000>& GetMemoryMapping() {return MemoryMapping;}
-		inline std::array<uint8_t, 0x10>& GetRegisters() {return Registers;}
+		inline uint8_t GetDelayTimer() const {return State.DelayTimer;}
+		inline uint8_t GetSoundTimer() const {return State.SoundTimer;}
+		inline std::array<uint8_t, 0x1000>& GetMemoryMapping() {InvalidateCode(0x0, 0xFFF); return MemoryMapping;}
+		inline std::array<DecodedInstruction, 0x800>& GetDecodeCache() {return DecodeCache;}
+		inline std::array<BasicBlock, 0x800>& GetBlockCache() {return BlockCache;}
+		inline void SetJitThreshold(const uint16_t threshold) {JitThreshold = threshold;}
+		inline std::vector<const StaticBlock*>& GetStaticBlocks() {return StaticBlocks;}
+		inline std::array<uint8_t, 0x10>& GetRegisters() {return State.Registers;}
 		inline std::array<uint16_t, 0x10>& GetStack() {return Stack;}
-		inline EmuRenderer* GetRenderer() const { return renderer; }
-		inline void SetRenderer(EmuRenderer* new_renderer) { renderer = new_renderer; }
-		inline IInputCommand* GetInputClass() {return input_class;}
-		inline void SetInputClass(IInputCommand* new_input_class) {input_class = new_input_class;}
-		inline IRandomGenerator* GetRandGenerator() {return random_generator;}
-		inline void SetRandomGenerator(IRandomGenerator* new_rand_gen) {random_generator = new_rand_gen;}
+		inline Renderer* GetRenderer() const { return renderer; }
+		inline void SetRenderer(Renderer* new_renderer) { renderer = new_renderer; }
+		inline Input* GetInputClass() {return input_class;}
+		inline void SetInputClass(Input* new_input_class) {input_class = new_input_class;}
+		inline Rng* GetRandGenerator() {return random_generator;}
+		inline void SetRandomGenerator(Rng* new_rand_gen) {random_generator = new_rand_gen;}
 
 #endif //EMU_TEST
 
 	private:
 		void SetFonts();
 
+		// hands the screen to the renderer, there is none in headless runs
+		void PresentFrame();
+
 	private:
+		// hot, touched by nearly every instruction; first in the object, so it owns the first cache line
+		MachineState State;
 		std::array<uint8_t, 0x1000> MemoryMapping;
-		std::array<uint8_t, 0x10> Registers;
 		std::array<uint16_t, 0x10> Stack;
+		// drawn by CLS and DRW, the renderer only receives copies of it
+		Framebuffer Screen{};
+		// parallel to MemoryMapping, one entry per even address
+		std::array<DecodedInstruction, 0x800> DecodeCache{};
+		DecodedInstruction UncachedInstruction;
+		// indexed by the start address of the block, like DecodeCache
+		std::array<BasicBlock, 0x800> BlockCache{};
+		static constexpr uint16_t MaxBlockLength = 64;
+		uint64_t InstructionCount = 0;
+		uint64_t IdleCycles = 0;
+		std::array<uint64_t, FusedInstructionCount> FusionHits{};
+
+		// cold, configuration and backends read once per call or only on the slow paths
 		std::array<std::function<OpcodeStatus(const uint16_t)>, 0x10> Opcodes;
-
-		uint16_t I = 0x0;
-		uint8_t DelayTimer = 0x0;
-		uint8_t SoundTimer = 0x0;
-		uint16_t PC = 0x200;
-		uint8_t SP = 0xFF;
-
-		bool Suspended = false;
-		uint8_t WaitForKeyboardRegister_Index = 0;
-		double DelayTimerDeltaTicks = 0;
-		double SoundTimerDeltaTicks = 0;
+		// created on the first Jit dispatch, so the interpreters never pay for the code buffer
+		std::unique_ptr<JitCompiler> Jit;
+		uint16_t JitThreshold = 8;
+		const StaticProgram* Program = nullptr;
+		// indexed like BlockCache, empty while the static program does not match memory
+		std::vector<const StaticBlock*> StaticBlocks;
+		bool FusionEnabled = true;
+		bool IdleSkipEnabled = true;
+		uint32_t InstructionsPerFrame = 10;
 
 		int width = 64;
 		int height = 32;
 		bool DoWrap = false;
+		QuirkProfile Profile = QuirkProfile::Default;
+
+#if CHIP8_COMPUTED_GOTO
+		DispatchMode Dispatch = DispatchMode::Threaded;
+#else
+		DispatchMode Dispatch = DispatchMode::Switch;
+#endif // CHIP8_COMPUTED_GOTO
 
-		EmuRenderer* renderer = nullptr;
-		IInputCommand* input_class = nullptr;
-		IRandomGenerator* random_generator = nullptr;
+		Renderer* renderer = nullptr;
+		Input* input_class = nullptr;
+		Rng* random_generator = nullptr;
 	};
+
+	// defined in emulator_impl.cpp, so including this header never compiles the core again
+	extern template class CHIP8_API BasicEmulator<EmuRenderer, IInputCommand, IRandomGenerator>;
 }
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace chipotto
+{
+	// the digit sprites loaded at address 0, 5 bytes each so FX29 points I at 5 * digit
+	// the F sprite sits in the slot of E and the slot of F stays empty, as the core always loaded them
+	inline constexpr std::array<uint8_t, 0x50> FontSprites =
+	{
+		0xF0, 0x90, 0x90, 0x90, 0xF0,   // 0
+		0x20, 0x60, 0x20, 0x20, 0x70,   // 1
+		0xF0, 0x10, 0xF0, 0x80, 0xF0,   // 2
+		0xF0, 0x10, 0xF0, 0x10, 0xF0,   // 3
+		0x90, 0x90, 0xF0, 0x10, 0x10,   // 4
+		0xF0, 0x80, 0xF0, 0x10, 0xF0,   // 5
+		0xF0, 0x80, 0xF0, 0x90, 0xF0,   // 6
+		0xF0, 0x10, 0x20, 0x40, 0x40,   // 7
+		0xF0, 0x90, 0xF0, 0x90, 0xF0,   // 8
+		0xF0, 0x90, 0xF0, 0x10, 0xF0,   // 9
+		0xF0, 0x90, 0xF0, 0x90, 0x90,   // A
+		0xE0, 0x90, 0xE0, 0x90, 0xE0,   // B
+		0xF0, 0x80, 0x80, 0x80, 0xF0,   // C
+		0xE0, 0x90, 0x90, 0x90, 0xE0,   // D
+		0xF0, 0x80, 0xF0, 0x80, 0x80,   // F, in the slot of E
+		0x00, 0x00, 0x00, 0x00, 0x00,
+	};
+}
@@ -15,6 +15,8 @@ namespace chipotto
 		virtual EmuKey GetKey() = 0;
 		virtual bool IsKeyPressed(const EmuKey key) = 0;
 		virtual InputType GetInputEventType() = 0;
+		// blocks until an input event is pending or timeout_ms passed, true if an event is pending; backends that cannot block return false right away
+		virtual bool WaitForInput(const uint32_t /*timeout_ms*/) { return false; }
 		virtual ~IInputCommand() {};
 	};
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "emulator_fwd.h"
+#include "jit/x64_emitter.h"
+
+#if defined(CHIP8_ENABLE_JIT) && (defined(__x86_64__) || defined(_M_X64))
+#define CHIP8_HAS_JIT 1
+#else
+#define CHIP8_HAS_JIT 0
+#endif // CHIP8_ENABLE_JIT && x86-64
+
+namespace chipotto
+{
+	struct DecodedInstruction;
+
+	// native code for one basic block, returns the OpcodeStatus of its terminator as an int
+	using JitBlockFunction = int (*)(EmulatorImpl* emulator);
+
+	/// <summary>
+	/// Translates basic blocks of one EmulatorImpl into x86-64 code.
+	/// The emitted code addresses the machine state of that instance directly, so a compiler is never shared.
+	/// </summary>
+	class JitCompiler
+	{
+	public:
+		JitCompiler(EmulatorImpl* emulator);
+		~JitCompiler();
+
+		JitCompiler(const JitCompiler& other) = delete;
+		JitCompiler& operator=(const JitCompiler& other) = delete;
+
+		/// <summary>
+		/// Compiles the already decoded block starting at start.
+		/// </summary>
+		/// <param name="start">the address of the first instruction</param>
+		/// <param name="length">the number of instructions, the last one is the terminator</param>
+		/// <returns>the native block, nullptr when the code buffer is full or unavailable</returns>
+		JitBlockFunction Compile(const uint16_t start, const uint16_t length);
+
+		// drops every compiled block, the caller must forget the functions it got from Compile
+		void Reset();
+
+		inline size_t GetUsedBytes() const { return Used; }
+
+	private:
+		void EmitPrologue();
+		void EmitEpilogue();
+		void EmitReturnStatus(const int status);
+		void EmitCall(const void* function);
+		void EmitLoadEmulatorArgument();
+		// terminators that end with a conditional skip of the next instruction
+		void EmitSkipTail(const uint16_t address, const bool skip_if_equal);
+		// falls back to the interpreter for one instruction
+		void EmitInterpret(const DecodedInstruction& instruction);
+		// moves the shift source into VX when the quirk profile shifts VY, the shift itself is done in place
+		void EmitShiftCopy(const DecodedInstruction& instruction);
+		void EmitInterpretTerminator(const DecodedInstruction& instruction, const uint16_t address);
+		// returns false if the instruction is a terminator that was fully emitted
+		bool EmitInstruction(const DecodedInstruction& instruction, const uint16_t address, const bool is_last);
+
+		int32_t RegisterDisp(const uint8_t index) const;
+
+		// the register 8XY6 and 8XYE read under the quirk profile of the emulator
+		int32_t ShiftSourceDisp(const DecodedInstruction& instruction) const;
+
+#pragma region Trampolines
+		// stable entry points the native code calls back into, so the emitted calls never move
+		static int Interpret(EmulatorImpl* emulator, const uint64_t packed_instruction);
+		static uint32_t RandomByte(EmulatorImpl* emulator);
+		static uint32_t IsKeyPressed(EmulatorImpl* emulator, const uint32_t key);
+#pragma endregion
+
+	private:
+		EmulatorImpl* Emulator = nullptr;
+		X64Emitter Emitter;
+
+		uint8_t* Buffer = nullptr;
+		size_t Capacity = 0;
+		size_t Used = 0;
+
+		// displacements from the register file, where rbx points
+		int32_t IDisp = 0;
+		int32_t PCDisp = 0;
+		int32_t DelayTimerDisp = 0;
+	};
+}
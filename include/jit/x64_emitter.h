@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace chipotto
+{
+	/// <summary>
+	/// Minimal x86-64 encoder for the JIT.
+	/// Every memory operand is a byte or word at [rbx + disp32], rbx always holds the machine state base.
+	/// </summary>
+	class X64Emitter
+	{
+	public:
+		enum Reg8 : uint8_t
+		{
+			AL = 0,
+			CL = 1
+		};
+
+		enum Reg64 : uint8_t
+		{
+			RAX = 0,
+			RCX = 1,
+			RDX = 2,
+			RBX = 3,
+			RSI = 6,
+			RDI = 7,
+			R12 = 12
+		};
+
+		inline const std::vector<uint8_t>& GetCode() const { return Code; }
+		inline size_t GetSize() const { return Code.size(); }
+		inline void Clear() { Code.clear(); }
+
+#pragma region Encoding
+
+		inline void Byte(const uint8_t value) { Code.push_back(value); }
+
+		inline void Word(const uint16_t value)
+		{
+			Byte(value & 0xFF);
+			Byte(value >> 8);
+		}
+
+		inline void Dword(const uint32_t value)
+		{
+			Word(value & 0xFFFF);
+			Word(value >> 16);
+		}
+
+		inline void Qword(const uint64_t value)
+		{
+			Dword(value & 0xFFFFFFFF);
+			Dword(value >> 32);
+		}
+
+		// ModRM + disp32 for [rbx + disp], reg is the register or the opcode extension
+		inline void MemoryOperand(const uint8_t reg, const int32_t disp)
+		{
+			Byte(0x80 | ((reg & 0x7) << 3) | RBX);
+			Dword(static_cast<uint32_t>(disp));
+		}
+
+#pragma endregion
+#pragma region Instructions
+
+		inline void Push(const Reg64 reg)
+		{
+			if (reg >= 8)
+				Byte(0x41);
+			Byte(0x50 + (reg & 0x7));
+		}
+
+		inline void Pop(const Reg64 reg)
+		{
+			if (reg >= 8)
+				Byte(0x41);
+			Byte(0x58 + (reg & 0x7));
+		}
+
+		inline void Ret() { Byte(0xC3); }
+
+		// mov reg, imm64
+		inline void MovImm64(const Reg64 reg, const uint64_t value)
+		{
+			Byte(reg >= 8 ? 0x49 : 0x48);
+			Byte(0xB8 + (reg & 0x7));
+			Qword(value);
+		}
+
+		// mov dst, src
+		inline void MovReg64(const Reg64 dst, const Reg64 src)
+		{
+			Byte(0x48 | (src >= 8 ? 0x4 : 0) | (dst >= 8 ? 0x1 : 0));
+			Byte(0x89);
+			Byte(0xC0 | ((src & 0x7) << 3) | (dst & 0x7));
+		}
+
+		// sub rsp, imm8 / add rsp, imm8
+		inline void SubRsp(const uint8_t value) { Byte(0x48); Byte(0x83); Byte(0xEC); Byte(value); }
+		inline void AddRsp(const uint8_t value) { Byte(0x48); Byte(0x83); Byte(0xC4); Byte(value); }
+
+		// call rax
+		inline void CallRax() { Byte(0xFF); Byte(0xD0); }
+
+		// mov eax, imm32
+		inline void MovEaxImm32(const uint32_t value) { Byte(0xB8); Dword(value); }
+
+		// mov byte [rbx + disp], imm8
+		inline void MovMem8Imm(const int32_t disp, const uint8_t value) { Byte(0xC6); MemoryOperand(0, disp); Byte(value); }
+
+		// add byte [rbx + disp], imm8
+		inline void AddMem8Imm(const int32_t disp, const uint8_t value) { Byte(0x80); MemoryOperand(0, disp); Byte(value); }
+
+		// cmp byte [rbx + disp], imm8
+		inline void CmpMem8Imm(const int32_t disp, const uint8_t value) { Byte(0x80); MemoryOperand(7, disp); Byte(value); }
+
+		// mov reg8, byte [rbx + disp]
+		inline void LoadReg8(const Reg8 reg, const int32_t disp) { Byte(0x8A); MemoryOperand(reg, disp); }
+
+		// mov byte [rbx + disp], reg8
+		inline void StoreReg8(const int32_t disp, const Reg8 reg) { Byte(0x88); MemoryOperand(reg, disp); }
+
+		// add / sub / cmp al, byte [rbx + disp]
+		inline void AddAlMem8(const int32_t disp) { Byte(0x02); MemoryOperand(AL, disp); }
+		inline void SubAlMem8(const int32_t disp) { Byte(0x2A); MemoryOperand(AL, disp); }
+		inline void CmpAlMem8(const int32_t disp) { Byte(0x3A); MemoryOperand(AL, disp); }
+
+		// or / and / xor byte [rbx + disp], al
+		inline void OrMem8Al(const int32_t disp) { Byte(0x08); MemoryOperand(AL, disp); }
+		inline void AndMem8Al(const int32_t disp) { Byte(0x20); MemoryOperand(AL, disp); }
+		inline void XorMem8Al(const int32_t disp) { Byte(0x30); MemoryOperand(AL, disp); }
+
+		// shr / shl byte [rbx + disp], 1
+		inline void ShrMem8(const int32_t disp) { Byte(0xD0); MemoryOperand(5, disp); }
+		inline void ShlMem8(const int32_t disp) { Byte(0xD0); MemoryOperand(4, disp); }
+
+		// and al, imm8 / shr al, imm8
+		inline void AndAlImm(const uint8_t value) { Byte(0x24); Byte(value); }
+		inline void ShrAlImm(const uint8_t value) { Byte(0xC0); Byte(0xE8); Byte(value); }
+
+		// setc cl / seta cl
+		inline void SetcCl() { Byte(0x0F); Byte(0x92); Byte(0xC1); }
+		inline void SetaCl() { Byte(0x0F); Byte(0x97); Byte(0xC1); }
+
+		// movzx reg32, byte [rbx + disp]
+		inline void MovzxReg32Mem8(const Reg64 reg, const int32_t disp) { Byte(0x0F); Byte(0xB6); MemoryOperand(reg, disp); }
+
+		// mov word [rbx + disp], imm16
+		inline void MovMem16Imm(const int32_t disp, const uint16_t value) { Byte(0x66); Byte(0xC7); MemoryOperand(0, disp); Word(value); }
+
+		// add word [rbx + disp], imm8 (sign extended)
+		inline void AddMem16Imm8(const int32_t disp, const uint8_t value) { Byte(0x66); Byte(0x83); MemoryOperand(0, disp); Byte(value); }
+
+		// mov / add word [rbx + disp], ax
+		inline void StoreAx(const int32_t disp) { Byte(0x66); Byte(0x89); MemoryOperand(RAX, disp); }
+		inline void AddMem16Ax(const int32_t disp) { Byte(0x66); Byte(0x01); MemoryOperand(RAX, disp); }
+
+		// lea eax, [rax + rax * 4]
+		inline void LeaEaxTimesFive() { Byte(0x8D); Byte(0x04); Byte(0x80); }
+
+		// test eax, eax / cmp eax, imm8
+		inline void TestEax() { Byte(0x85); Byte(0xC0); }
+		inline void CmpEaxImm8(const uint8_t value) { Byte(0x83); Byte(0xF8); Byte(value); }
+
+		// short conditional jumps, return the offset of the rel8 to patch with PatchRel8
+		inline size_t Je8() { Byte(0x74); Byte(0); return Code.size() - 1; }
+		inline size_t Jne8() { Byte(0x75); Byte(0); return Code.size() - 1; }
+
+		// points a rel8 emitted by Je8/Jne8 to the current position
+		inline void PatchRel8(const size_t rel_offset)
+		{
+			Code[rel_offset] = static_cast<uint8_t>(Code.size() - rel_offset - 1);
+		}
+
+#pragma endregion
+
+	private:
+		std::vector<uint8_t> Code;
+	};
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "export.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "keys.h"
+#include "quirks.h"
+#include "run_status.h"
+
+namespace chipotto
+{
+	class Gamefile;
+	class IRandomGenerator;
+
+	/// <summary>
+	/// Runs the same ROM on 8, 16 or 32 machines at once, with their registers stored structure-of-arrays so one SIMD
+	/// instruction updates a register of every machine. Each step decodes one instruction and executes it on every lane
+	/// whose PC points at it; lanes that branched elsewhere are masked out and run on a later step.
+	/// Every lane ends each frame in the state an EmulatorImpl with the same input reaches with RunFrame.
+	/// Built with AVX2 when the compiler targets it (CHIP8_ENABLE_AVX2), with plain loops otherwise.
+	/// </summary>
+	template<size_t Lanes>
+	class LockstepEmulator
+	{
+		static_assert(Lanes == 8 || Lanes == 16 || Lanes == 32, "LockstepEmulator runs 8, 16 or 32 lanes");
+
+	public:
+		// one bit per lane, bit 0 is lane 0
+		using LaneMask = uint32_t;
+		static constexpr LaneMask AllLanes = Lanes == 32 ? 0xFFFFFFFFu : (1u << Lanes) - 1;
+		// the registers of every lane are padded to a full AVX2 register
+		static constexpr size_t LaneStride = 32;
+
+		// takes ownership of the random generators, one per lane
+		explicit LockstepEmulator(const std::array<IRandomGenerator*, Lanes>& random_generators);
+		~LockstepEmulator();
+
+		LockstepEmulator(const LockstepEmulator& other) = delete;
+		LockstepEmulator& operator=(const LockstepEmulator& other) = delete;
+
+		// copies the game into the memory of every lane, at PC like EmulatorImpl::Load
+		bool Load(const Gamefile* gamefile);
+
+		// every lane back to power on, with the fonts loaded and the screens cleared
+		void HardReset();
+
+		void SetQuirkProfile(const QuirkProfile profile);
+		inline QuirkProfile GetQuirkProfile() const { return Profile; }
+
+		void SetInstructionsPerFrame(const uint32_t instructions_per_frame);
+		inline uint32_t GetInstructionsPerFrame() const { return InstructionsPerFrame; }
+
+		// a press is also queued for the lane, so it completes a waiting FX0A on the next frame
+		void KeyDown(const size_t lane, const EmuKey key);
+		void KeyUp(const size_t lane, const EmuKey key);
+
+		/// <summary>
+		/// Runs the instructions-per-frame budget on every lane, like RunFrame on as many EmulatorImpl instances.
+		/// </summary>
+		/// <returns>the lanes whose frame ended with RunStatus::Error</returns>
+		LaneMask RunFrame();
+
+		// how the last frame of the lane ended
+		RunStatus GetStatus(const size_t lane) const;
+
+		// the machine of one lane in the layout of EmulatorImpl, for comparisons and snapshots
+		MachineState GetMachineState(const size_t lane) const;
+
+		inline const std::array<uint8_t, 0x1000>& GetMemory(const size_t lane) const { return Memory[lane]; }
+
+		// one uint64_t per row, bit 63 is the leftmost pixel, like EmulatorImpl::GetFramebuffer
+		inline const std::array<uint64_t, 32>& GetFramebuffer(const size_t lane) const { return Framebuffers[lane]; }
+
+		// instructions retired by all lanes together, and the steps that retired them
+		inline uint64_t GetLaneInstructionCount() const { return LaneInstructions; }
+		inline uint64_t GetStepCount() const { return Steps; }
+
+		// true when the lane operations were compiled with AVX2 intrinsics
+		static bool UsesAvx2();
+
+	private:
+		template<typename Quirks>
+		void RunSteps();
+
+		// executes the instruction on the lanes of group, returns the lanes it failed on
+		template<typename Quirks>
+		LaneMask Execute(const uint16_t opcode, const LaneMask group);
+
+		// the lanes that run the next step and the instruction they run; converged tells that all of active ran the last step
+		LaneMask PickGroup(const LaneMask active, const bool converged, uint16_t& out_opcode);
+		void ConsumeSuspended(const LaneMask lanes);
+		void StepTimers(const LaneMask lanes);
+		void MarkWritten(const size_t lane, const uint16_t first, const uint16_t last);
+
+		// registers, padded per lane: Registers[x][lane]
+		alignas(32) std::array<std::array<uint8_t, LaneStride>, 0x10> Registers{};
+		alignas(32) std::array<uint16_t, LaneStride> I{};
+		alignas(32) std::array<uint16_t, LaneStride> PC{};
+		alignas(32) std::array<uint8_t, LaneStride> DelayTimer{};
+		alignas(32) std::array<uint8_t, LaneStride> SoundTimer{};
+		// instructions left in the current frame, and the value it has when the timers of the lane step
+		alignas(32) std::array<uint32_t, LaneStride> Remaining{};
+		alignas(32) std::array<uint32_t, LaneStride> TimerStepAt{};
+
+		// touched by calls, returns, waits and the frame bookkeeping only, so they stay per lane
+		std::array<uint8_t, Lanes> SP{};
+		std::array<std::array<uint16_t, 0x10>, Lanes> Stacks{};
+		std::array<uint8_t, Lanes> WaitRegister{};
+		std::array<uint32_t, Lanes> CyclesSinceTimerStep{};
+		std::array<uint64_t, Lanes> Cycles{};
+		LaneMask Suspended = 0;
+		LaneMask Failed = 0;
+
+		std::vector<std::array<uint8_t, 0x1000>> Memory;
+		std::array<std::array<uint64_t, 32>, Lanes> Framebuffers{};
+		// the lanes that wrote each 64 byte page since the load, only those pages can hold code that differs between lanes
+		std::array<LaneMask, 0x40> WrittenPages{};
+
+		std::array<uint16_t, Lanes> KeysDown{};
+		// the first key pressed since the last frame, K_NONE if there was none
+		std::array<EmuKey, Lanes> PendingPress{};
+		std::array<std::unique_ptr<IRandomGenerator>, Lanes> RandomGenerators;
+
+		QuirkProfile Profile = QuirkProfile::Default;
+		uint32_t InstructionsPerFrame = 10;
+		uint64_t LaneInstructions = 0;
+		uint64_t Steps = 0;
+	};
+
+	extern template class CHIP8_API LockstepEmulator<8>;
+	extern template class CHIP8_API LockstepEmulator<16>;
+	extern template class CHIP8_API LockstepEmulator<32>;
+}
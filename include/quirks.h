@@ -0,0 +1,88 @@
+#pragma once
+
+#include "export.h"
+
+#include <cstdint>
+
+namespace chipotto
+{
+	// the platform a ROM was written for, each one resolves the ambiguous opcodes its own way
+	enum class CHIP8_API QuirkProfile : uint8_t
+	{
+		// what this emulator always did: shifts read VX, FX55/FX65 leave I alone, BNNN adds V0, sprites are clipped
+		Default,
+		// the COSMAC VIP interpreter: shifts read VY, FX55/FX65 advance I, BNNN adds V0, sprites are clipped
+		Chip8,
+		// SUPER-CHIP 1.1: shifts read VX, FX55/FX65 leave I alone, BXNN adds VX, sprites are clipped
+		SuperChip,
+		// XO-CHIP: shifts read VY, FX55/FX65 advance I, BNNN adds V0, sprites wrap
+		XoChip
+	};
+
+	/// <summary>
+	/// The quirks of a profile as constants, so every handler instantiated with a policy compiles to a single behavior.
+	/// Sprite wrapping follows the profile unless Wrap picks the other variant, as EmulatorImpl::SetDoWrap does.
+	/// </summary>
+	template<QuirkProfile Profile, bool Wrap = Profile == QuirkProfile::XoChip>
+	struct QuirkPolicy
+	{
+		static constexpr QuirkProfile profile = Profile;
+		// 8XY6 and 8XYE shift VY into VX instead of shifting VX in place
+		static constexpr bool ShiftReadsVy = Profile == QuirkProfile::Chip8 || Profile == QuirkProfile::XoChip;
+		// FX55 and FX65 leave I past the last register they copied
+		static constexpr bool LoadStoreAdvancesI = Profile == QuirkProfile::Chip8 || Profile == QuirkProfile::XoChip;
+		// BXNN jumps to XNN + VX instead of NNN + V0
+		static constexpr bool JumpReadsVx = Profile == QuirkProfile::SuperChip;
+		// sprites crossing an edge reappear on the other side instead of being cut
+		static constexpr bool WrapSprites = Wrap;
+	};
+
+	/// <summary>
+	/// Turns a profile known only at runtime into its policy type, calling function.template operator()&lt;QuirkPolicy&lt;profile&gt;&gt;().
+	/// Branch once here, then stay inside code instantiated for the policy.
+	/// </summary>
+	template<typename Function>
+	inline decltype(auto) WithQuirkPolicy(const QuirkProfile profile, Function&& function)
+	{
+		switch (profile)
+		{
+		case QuirkProfile::Chip8:
+			return function.template operator()<QuirkPolicy<QuirkProfile::Chip8>>();
+		case QuirkProfile::SuperChip:
+			return function.template operator()<QuirkPolicy<QuirkProfile::SuperChip>>();
+		case QuirkProfile::XoChip:
+			return function.template operator()<QuirkPolicy<QuirkProfile::XoChip>>();
+		case QuirkProfile::Default:
+		default:
+			return function.template operator()<QuirkPolicy<QuirkProfile::Default>>();
+		}
+	}
+
+	/// <summary>
+	/// Like the overload above, with sprite wrapping chosen apart from the profile.
+	/// </summary>
+	template<typename Function>
+	inline decltype(auto) WithQuirkPolicy(const QuirkProfile profile, const bool wrap_sprites, Function&& function)
+	{
+		switch (profile)
+		{
+		case QuirkProfile::Chip8:
+			if (wrap_sprites)
+				return function.template operator()<QuirkPolicy<QuirkProfile::Chip8, true>>();
+			return function.template operator()<QuirkPolicy<QuirkProfile::Chip8, false>>();
+		case QuirkProfile::SuperChip:
+			if (wrap_sprites)
+				return function.template operator()<QuirkPolicy<QuirkProfile::SuperChip, true>>();
+			return function.template operator()<QuirkPolicy<QuirkProfile::SuperChip, false>>();
+		case QuirkProfile::XoChip:
+			if (wrap_sprites)
+				return function.template operator()<QuirkPolicy<QuirkProfile::XoChip, true>>();
+			return function.template operator()<QuirkPolicy<QuirkProfile::XoChip, false>>();
+		case QuirkProfile::Default:
+		default:
+			if (wrap_sprites)
+				return function.template operator()<QuirkPolicy<QuirkProfile::Default, true>>();
+			return function.template operator()<QuirkPolicy<QuirkProfile::Default, false>>();
+		}
+	}
+}
@@ -1,10 +1,14 @@
 #pragma once
 #include "export.h"
 
+#include <array>
 #include <cstdint>
 
 namespace chipotto
 {
+	// the 64x32 screen owned by the core, one uint64_t per row with bit 63 as the leftmost pixel
+	using Framebuffer = std::array<uint64_t, 32>;
+
 	class CHIP8_API EmuRenderer
 	{
 	public:
@@ -12,21 +16,12 @@ namespace chipotto
 			: width(in_width), height(in_height)
 		{};
 
-		virtual void ClearScreen() = 0;
 		/// <summary>
-		/// Implementation of the DRW command for your render pipeline.
-		/// Draws a sprite from memory starting at location I, at (Vx, Vy) coords.
+		/// Shows a finished frame. The core draws and detects collisions in its own framebuffer,
+		/// and hands it over after every CLS and DRW that changed it.
 		/// </summary>
-		/// <param name="x_coord">the x coordinate where the sprite is drawn</param>
-		/// <param name="y_coord">the y coordinate where the sprite is drawn</param>
-		/// <param name="raw_sprite_mono"> the sprite data using a single channel configuration</param>
-		/// <param name="sprite_height"> the sprite height</param>
-		/// <param name="do_wrap">if true, the sprite wraps around the screen</param>
-		/// <param name="out_collision">true on pixel collision(s), false otherwise</param>
-		/// <returns>0 if no error occurred</returns>
-		virtual int Draw(uint8_t const x_coord, const uint8_t y_coord,
-			const uint8_t* raw_sprite_mono, const uint8_t sprite_height, bool do_wrap,
-			bool& out_collision) = 0;
+		/// <param name="rows">the whole screen, one uint64_t per row with bit 63 as the leftmost pixel</param>
+		virtual void DrawFrame(const Framebuffer& rows) = 0;
 
 		virtual bool IsValid() = 0;
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "export.h"
+
+#include <cstdint>
+
+namespace chipotto
+{
+	// how a RunCycles or RunFrame call ended
+	enum class CHIP8_API RunStatus : uint8_t
+	{
+		// the whole instruction budget ran
+		FrameDone,
+		// an FX0A is waiting for a key, the rest of the budget was dropped
+		WaitingForKey,
+		// an opcode failed or is not implemented, PC stays on it
+		Error,
+		// the input backend asked to quit, nothing ran
+		Quit
+	};
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "export.h"
+
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "keys.h"
+
+namespace chipotto
+{
+	class Gamefile;
+	class RunnerInput;
+
+	enum class CHIP8_API InstanceState : uint8_t
+	{
+		// runs on the next Tick
+		Ready,
+		// inside a delay timer loop, runs again on the frame the loop can end
+		Sleeping,
+		// FX0A with the timers stopped, runs again after a KeyDown
+		WaitingForKey,
+		// in a loop nothing can end, never runs again
+		Halted,
+		// failed on an opcode, never runs again
+		Stopped
+	};
+
+	/// <summary>
+	/// Runs many headless emulators on the calling thread, each one a coroutine that yields at the end of every frame.
+	/// An instance that waits on FX0A or idles in a delay timer loop is not resumed at all until its key arrives or the
+	/// loop can end, so the cost of a Tick follows the instances that have work to do rather than the instance count.
+	/// </summary>
+	class CHIP8_API CoroutineScheduler
+	{
+	public:
+		CoroutineScheduler() = default;
+		~CoroutineScheduler();
+
+		CoroutineScheduler(const CoroutineScheduler& other) = delete;
+		CoroutineScheduler& operator=(const CoroutineScheduler& other) = delete;
+
+		/// <summary>
+		/// Adds an instance running the game from the next Tick on.
+		/// </summary>
+		/// <param name="gamefile">copied into the instance, the caller keeps it</param>
+		/// <param name="random_generator">owned by the instance from now on</param>
+		/// <returns>the id of the instance</returns>
+		uint32_t Spawn(const Gamefile* gamefile, IRandomGenerator* random_generator);
+
+		// runs one frame of every instance that is due, returns how many were resumed
+		size_t Tick();
+
+		// a press also wakes an instance waiting for a key, it runs on the next Tick
+		void KeyDown(const uint32_t id, const EmuKey key);
+		void KeyUp(const uint32_t id, const EmuKey key);
+
+		inline InstanceState GetState(const uint32_t id) const { return Instances[id].State; }
+
+		// the instance is suspended between ticks and can be inspected, a sleeping one has not caught up with its skipped frames yet
+		inline const EmulatorImpl& GetEmulator(const uint32_t id) const { return *Instances[id].Core; }
+
+		inline size_t GetInstanceCount() const { return Instances.size(); }
+
+		// ticks run so far
+		inline uint64_t GetFrame() const { return Frame; }
+
+	private:
+		struct Task;
+
+		struct Instance
+		{
+			std::unique_ptr<EmulatorImpl> Core;
+			RunnerInput* Keys = nullptr;
+			std::coroutine_handle<> Handle;
+			InstanceState State = InstanceState::Ready;
+			// frames skipped while sleeping, run in one RunCycles call when the instance wakes
+			uint32_t SleptFrames = 0;
+		};
+
+		// what an instance awaits at the end of a frame, await_suspend files it with the scheduler
+		struct Yield
+		{
+			CoroutineScheduler& Scheduler;
+			uint32_t Id;
+			InstanceState State;
+			uint32_t Frames = 0;
+
+			inline bool await_ready() const noexcept { return false; }
+			inline void await_suspend(std::coroutine_handle<>) const noexcept { Scheduler.Park(Id, State, Frames); }
+			inline void await_resume() const noexcept {}
+		};
+
+		Task Run(const uint32_t id);
+
+		void Park(const uint32_t id, const InstanceState state, const uint32_t frames);
+
+		// a delay timer loop lasts at most 255 frames, so one bucket per frame of that span is enough
+		static constexpr size_t WheelSize = 256;
+
+		std::vector<Instance> Instances;
+		// due on the current Tick, and due on the next one
+		std::vector<uint32_t> Ready;
+		std::vector<uint32_t> NextReady;
+		// sleeping instances, by the frame they wake on modulo WheelSize
+		std::array<std::vector<uint32_t>, WheelSize> Wheel;
+		uint64_t Frame = 0;
+	};
+}
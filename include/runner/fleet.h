@@ -0,0 +1,111 @@
+#pragma once
+
+#include "export.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "keys.h"
+#include "quirks.h"
+#include "run_status.h"
+
+namespace chipotto
+{
+	class Gamefile;
+
+	// a key going down or up before the given frame of a job runs
+	struct FleetInputEvent
+	{
+		uint32_t Frame = 0;
+		EmuKey Key = EmuKey::K_NONE;
+		bool Pressed = true;
+	};
+
+	// one independent run: a game, the keys pressed during it and how many frames it lasts
+	struct FleetJob
+	{
+		// shared by any number of jobs, the caller keeps it alive until Run returns
+		const Gamefile* Game = nullptr;
+		// sorted by frame
+		std::vector<FleetInputEvent> Script;
+		uint32_t Frames = 0;
+		uint32_t InstructionsPerFrame = 10;
+		QuirkProfile Profile = QuirkProfile::Default;
+		// seeds the random generator of the job, so the same job always gives the same result
+		uint64_t Seed = 0;
+	};
+
+	struct FleetResult
+	{
+		// FNV-1a of the 32 rows of the final screen, one uint64_t per row with bit 63 as the leftmost pixel
+		uint64_t FramebufferHash = 0;
+		// Error or Quit if the job stopped early, FrameDone or WaitingForKey after its last frame otherwise
+		RunStatus Status = RunStatus::FrameDone;
+		// emulated instruction cycles, skipped idle loops included
+		uint64_t Cycles = 0;
+		uint32_t FramesRun = 0;
+		// the worker that ran the job, its own or a stolen one
+		uint32_t Worker = 0;
+	};
+
+	struct FleetOptions
+	{
+		// 0 starts one worker per hardware thread
+		uint32_t WorkerCount = 0;
+		// pins worker i to core i modulo the core count, where the OS supports it
+		bool PinWorkers = false;
+	};
+
+	/// <summary>
+	/// Runs batches of independent headless jobs on a pool of worker threads.
+	/// Every worker owns a deque of jobs and a reusable emulator; a worker that runs out of jobs steals the oldest half
+	/// of another deque, so uneven jobs still keep every core busy. Results do not depend on which worker ran a job.
+	/// </summary>
+	class CHIP8_API Chip8Fleet
+	{
+	public:
+		explicit Chip8Fleet(const FleetOptions& options = {});
+		~Chip8Fleet();
+
+		Chip8Fleet(const Chip8Fleet& other) = delete;
+		Chip8Fleet& operator=(const Chip8Fleet& other) = delete;
+
+		/// <summary>
+		/// Runs every job and blocks until the last one is done. Meant for one calling thread at a time.
+		/// </summary>
+		/// <returns>one result per job, in the order of the jobs</returns>
+		std::vector<FleetResult> Run(const std::vector<FleetJob>& jobs);
+
+		inline uint32_t GetWorkerCount() const { return static_cast<uint32_t>(Workers.size()); }
+
+		// jobs a worker took from another deque, since the fleet started
+		inline uint64_t GetStolenJobs() const { return StolenJobs.load(std::memory_order_relaxed); }
+
+	private:
+		struct Worker;
+
+		void WorkerMain(const uint32_t index);
+		bool PopJob(const uint32_t index, uint32_t& out_job);
+		bool StealJobs(const uint32_t index, uint32_t& out_job);
+		void RunJob(Worker& worker, const uint32_t index, const FleetJob& job, FleetResult& out_result);
+
+		std::vector<std::unique_ptr<Worker>> Workers;
+
+		// the batch being run, published to the workers under BatchMutex
+		std::mutex BatchMutex;
+		std::condition_variable BatchStarted;
+		std::condition_variable BatchDone;
+		const std::vector<FleetJob>* Jobs = nullptr;
+		std::vector<FleetResult>* Results = nullptr;
+		uint64_t Batch = 0;
+		// workers that took the current batch and have no job of it left, Run returns once all of them have
+		uint32_t WorkersDone = 0;
+		bool StopRequested = false;
+
+		std::atomic<uint64_t> StolenJobs{ 0 };
+	};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "export.h"
+#include "renderer.h"
+
+#include <cstdint>
+
+namespace chipotto
+{
+	/// <summary>
+	/// Shows nothing and needs no display, for servers, batch workers, tests and the ThreadedRunner behind a UI.
+	/// The frame is not copied: GetFrame reads the framebuffer of the core that drew it, so it is valid as long as that core
+	/// and always shows its screen as of the last CLS or DRW.
+	/// </summary>
+	class CHIP8_API HeadlessRenderer final : public EmuRenderer
+	{
+	public:
+		HeadlessRenderer();
+
+		inline virtual void DrawFrame(const Framebuffer& rows) override
+		{
+			Frame = &rows;
+			++FrameCount;
+		}
+
+		inline virtual bool IsValid() override { return true; }
+
+		// one uint64_t per row with bit 63 as the leftmost pixel, blank until the first frame
+		inline const Framebuffer& GetFrame() const { return *Frame; }
+
+		inline bool IsPixelSet(const uint32_t x, const uint32_t y) const { return ((*Frame)[y % 32] >> (63 - x % 64)) & 1; }
+
+		// the frames handed over by the core, one per CLS and DRW
+		inline uint64_t GetFrameCount() const { return FrameCount; }
+
+	private:
+		const Framebuffer* Frame;
+		uint64_t FrameCount = 0;
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "export.h"
+#include "renderer.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace chipotto
+{
+	// the pixel whose bytes are r, g, b and a in this order in memory, the layout of SDL_PIXELFORMAT_RGBA32
+	constexpr uint32_t PackRgba(const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a)
+	{
+		if constexpr (std::endian::native == std::endian::little)
+			return uint32_t(r) | uint32_t(g) << 8 | uint32_t(b) << 16 | uint32_t(a) << 24;
+		else
+			return uint32_t(r) << 24 | uint32_t(g) << 16 | uint32_t(b) << 8 | uint32_t(a);
+	}
+
+	/// <summary>
+	/// Turns the 1 bit framebuffer of the core into 32 bit pixels, one color for a lit pixel and one for an unlit one,
+	/// optionally scaled up by a whole factor with nearest neighbour so the image is ready to show or save as it is.
+	/// Eight pixels are written per instruction with AVX2 when the compiler targets it (CHIP8_ENABLE_AVX2),
+	/// four with SSE2 on the other x86-64 builds and one at a time elsewhere.
+	/// </summary>
+	class CHIP8_API RgbaExpander
+	{
+	public:
+		static constexpr uint32_t MaxScale = 16;
+
+		RgbaExpander(const uint32_t on_color = PackRgba(0xFF, 0xFF, 0xFF, 0xFF), const uint32_t off_color = 0, const uint32_t scale = 1);
+
+		void SetColors(const uint32_t on_color, const uint32_t off_color);
+		inline uint32_t GetOnColor() const { return OnColor; }
+		inline uint32_t GetOffColor() const { return OffColor; }
+
+		// clamped to 1..MaxScale
+		void SetScale(const uint32_t scale);
+		inline uint32_t GetScale() const { return Scale; }
+
+		// the size of the image in pixels
+		inline uint32_t GetWidth() const { return 64 * Scale; }
+		inline uint32_t GetHeight() const { return 32 * Scale; }
+
+		/// <summary>
+		/// Writes the pixels of rows first_row to first_row + row_count - 1, each one GetScale() lines of GetWidth() pixels.
+		/// </summary>
+		/// <param name="pixels">the first pixel of the first line of first_row</param>
+		/// <param name="pitch">the bytes from one line of pixels to the next, at least GetWidth() * 4</param>
+		void ExpandRows(const Framebuffer& rows, const uint32_t first_row, const uint32_t row_count, uint32_t* pixels, const size_t pitch) const;
+
+		inline void Expand(const Framebuffer& rows, uint32_t* pixels, const size_t pitch) const
+		{
+			ExpandRows(rows, 0, static_cast<uint32_t>(rows.size()), pixels, pitch);
+		}
+
+		// "AVX2", "SSE2" or "scalar", the instructions the expansion was compiled with
+		static const char* GetInstructionSet();
+
+	private:
+		uint32_t OnColor;
+		uint32_t OffColor;
+		uint32_t Scale = 1;
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+
+#include "iinput_command.h"
+
+namespace chipotto
+{
+	// the keyboard as the host reports it through key down and up calls, read by the core on the thread that runs it
+	class RunnerInput : public IInputCommand
+	{
+	public:
+		virtual const uint8_t* GetKeyboardState() override { return Pressed.data(); }
+		virtual bool IsInputPending() override { return !Presses.empty(); }
+		virtual EmuKey GetKey() override { return LastKey; }
+		virtual bool IsKeyPressed(const EmuKey key) override { return Pressed[KEY_AS_INT(key)] != 0; }
+		virtual InputType GetInputEventType() override
+		{
+			LastKey = Presses.front();
+			Presses.pop_front();
+			return InputType::KEYDOWN;
+		}
+
+		// a press is also queued as an event, so it completes a waiting FX0A
+		void SetKey(const EmuKey key, const bool pressed)
+		{
+			if (KEY_AS_INT(key) >= KEY_AS_INT(EmuKey::K_NONE))
+				return;
+			if (pressed)
+			{
+				Presses.push_back(key);
+			}
+			Pressed[KEY_AS_INT(key)] = pressed ? 1 : 0;
+		}
+
+		void Clear()
+		{
+			Presses.clear();
+			Pressed.fill(0);
+		}
+
+	private:
+		std::array<uint8_t, 0x10> Pressed{};
+		std::deque<EmuKey> Presses;
+		EmuKey LastKey = EmuKey::K_NONE;
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "irandom_generator.h"
+
+namespace chipotto
+{
+	// splitmix64, so the same seed always gives the same bytes and the same run, on any host
+	class SeededRandom final : public IRandomGenerator
+	{
+	public:
+		explicit SeededRandom(const uint64_t seed = 0) : State(seed) {}
+
+		virtual uint8_t GetRandomByte() override
+		{
+			uint64_t z = (State += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return static_cast<uint8_t>((z ^ (z >> 31)) >> 56);
+		}
+
+		// starts the sequence over, as if just constructed with seed
+		inline void Seed(const uint64_t seed) { State = seed; }
+
+	private:
+		uint64_t State;
+	};
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace chipotto
+{
+	/// <summary>
+	/// Publishes a value from one writer thread to any number of readers without locks. The writer never waits;
+	/// a reader that overlaps a store copies the value again, so it always gets a whole value from a single store.
+	/// </summary>
+	template<typename T>
+	class SeqLock
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "SeqLock copies its value word by word");
+
+	public:
+		// writer only
+		void Store(const T& value)
+		{
+			std::array<uint64_t, WordCount> buffer{};
+			memcpy(buffer.data(), static_cast<const void*>(&value), sizeof(T));
+
+			// an odd sequence marks a store in progress
+			const uint32_t sequence = Sequence.load(std::memory_order_relaxed);
+			Sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (size_t word = 0; word < WordCount; ++word)
+			{
+				Words[word].store(buffer[word], std::memory_order_relaxed);
+			}
+			Sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		// any thread, retries while the writer is storing
+		T Load() const
+		{
+			std::array<uint64_t, WordCount> buffer;
+			while (true)
+			{
+				const uint32_t before = Sequence.load(std::memory_order_acquire);
+				if (before & 1)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				for (size_t word = 0; word < WordCount; ++word)
+				{
+					buffer[word] = Words[word].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Sequence.load(std::memory_order_relaxed) == before)
+					break;
+			}
+
+			// through void*, T only has to be trivially copyable and may still have member initializers
+			T value;
+			memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+			return value;
+		}
+
+		// stores completed so far, a reader can poll it to see whether anything changed
+		inline uint32_t GetVersion() const { return Sequence.load(std::memory_order_acquire) / 2; }
+
+	private:
+		static constexpr size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		alignas(64) std::atomic<uint32_t> Sequence{ 0 };
+		// atomic words rather than a plain T, so the copy that races with a store is still well defined
+		std::array<std::atomic<uint64_t>, WordCount> Words{};
+	};
+}
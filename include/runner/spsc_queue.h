@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace chipotto
+{
+	/// <summary>
+	/// A bounded queue for exactly one producer thread and one consumer thread. Neither side ever locks or waits:
+	/// a push into a full queue and a pop from an empty one just fail.
+	/// </summary>
+	template<typename T, size_t Capacity>
+	class SpscQueue
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+	public:
+		// producer only, false if the queue is full
+		bool TryPush(const T& value)
+		{
+			const size_t tail = Tail.load(std::memory_order_relaxed);
+			if (tail - CachedHead == Capacity)
+			{
+				CachedHead = Head.load(std::memory_order_acquire);
+				if (tail - CachedHead == Capacity)
+					return false;
+			}
+			Slots[tail & (Capacity - 1)] = value;
+			Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only, false if the queue is empty
+		bool TryPop(T& out_value)
+		{
+			const size_t head = Head.load(std::memory_order_relaxed);
+			if (head == CachedTail)
+			{
+				CachedTail = Tail.load(std::memory_order_acquire);
+				if (head == CachedTail)
+					return false;
+			}
+			out_value = Slots[head & (Capacity - 1)];
+			Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		// the indices only grow; each side keeps a copy of the other one and reloads it only when the queue looks full or empty,
+		// and the two sides live on separate cache lines so they never bounce one between the threads
+		alignas(64) std::atomic<size_t> Head{ 0 };
+		size_t CachedTail = 0;
+		alignas(64) std::atomic<size_t> Tail{ 0 };
+		size_t CachedHead = 0;
+		alignas(64) std::array<T, Capacity> Slots{};
+	};
+}
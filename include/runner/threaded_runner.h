@@ -0,0 +1,111 @@
+#pragma once
+
+#include "export.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "keys.h"
+#include "run_status.h"
+#include "runner/seqlock.h"
+#include "runner/spsc_queue.h"
+
+namespace chipotto
+{
+	class HeadlessRenderer;
+	class RunnerInput;
+
+	// what the UI sees of the machine, published by the runner after every frame
+	struct RunnerSnapshot
+	{
+		MachineState State;
+		// one uint64_t per row, bit 63 is the leftmost pixel
+		std::array<uint64_t, 32> Framebuffer{};
+		// frames run since the runner started
+		uint64_t Frames = 0;
+		RunStatus Status = RunStatus::FrameDone;
+		bool Paused = true;
+	};
+
+	enum class CHIP8_API RunnerCommandType : uint8_t
+	{
+		Pause,
+		Resume,
+		Load,
+		Reset,
+		KeyDown,
+		KeyUp,
+		SetSpeed
+	};
+
+	struct RunnerCommand
+	{
+		RunnerCommandType Type = RunnerCommandType::Pause;
+		EmuKey Key = EmuKey::K_NONE;
+		float Speed = 1.0f;
+		// owned by the command, the runner deletes it after loading
+		Gamefile* Game = nullptr;
+	};
+
+	/// <summary>
+	/// Owns an emulator and runs it on a thread of its own, so a slow UI never delays emulation and a slow frame never freezes the UI.
+	/// The UI thread sends commands through a lock-free queue and reads the machine through a snapshot it takes without locking.
+	/// Every method is meant for one UI thread; the runner starts paused, with nothing loaded.
+	/// </summary>
+	class CHIP8_API ThreadedRunner
+	{
+	public:
+		// takes ownership of the random generator, like Emulator does with its backends
+		explicit ThreadedRunner(IRandomGenerator* random_generator);
+		~ThreadedRunner();
+
+		ThreadedRunner(const ThreadedRunner& other) = delete;
+		ThreadedRunner& operator=(const ThreadedRunner& other) = delete;
+
+		// every command returns false without blocking if the queue is full, the caller can retry on its next frame
+		bool Pause();
+		bool Resume();
+
+		// resets the machine and loads the game, which the runner deletes; on false the caller keeps it
+		bool Load(Gamefile* gamefile);
+
+		// resets the machine and loads the last game again
+		bool Reset();
+
+		bool KeyDown(const EmuKey key);
+		bool KeyUp(const EmuKey key);
+
+		// frame rate as a multiple of 60 Hz, 0 runs the frames back to back as fast as the host allows
+		bool SetSpeed(const float speed);
+
+		// never blocks on the runner, which publishes a new snapshot after every frame
+		inline RunnerSnapshot GetSnapshot() const { return Snapshot.Load(); }
+
+	private:
+		void Run();
+		void ApplyCommand(const RunnerCommand& command);
+		void Publish();
+
+		// touched by the UI thread
+		SpscQueue<RunnerCommand, 256> Commands;
+		SeqLock<RunnerSnapshot> Snapshot;
+		std::atomic<bool> StopRequested{ false };
+
+		// touched by the runner thread only
+		std::unique_ptr<EmulatorImpl> Core;
+		HeadlessRenderer* Screen = nullptr;
+		RunnerInput* Keys = nullptr;
+		std::vector<uint8_t> Rom;
+		uint64_t Frames = 0;
+		RunStatus LastStatus = RunStatus::FrameDone;
+		float Speed = 1.0f;
+		bool Paused = true;
+
+		std::thread Thread;
+	};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace chipotto
+{
+	/// <summary>
+	/// Hands whole values from one writer thread to one reader thread through three slots, without locks or waiting.
+	/// The writer fills its own slot and swaps it with the spare one; the reader swaps its slot with the spare one
+	/// when a newer value is there. Each side only ever touches its own slot, so neither can see a half written value,
+	/// and values the reader was too slow to take are overwritten rather than queued.
+	/// </summary>
+	template<typename T>
+	class TripleBuffer
+	{
+	public:
+		// writer only, the slot the next value is built in
+		inline T& GetWriteBuffer() { return Slots[WriteIndex]; }
+
+		// writer only, makes the write buffer the newest value and hands the writer the spare slot
+		void Publish()
+		{
+			const uint8_t previous = Spare.exchange(static_cast<uint8_t>(WriteIndex | FreshBit), std::memory_order_acq_rel);
+			WriteIndex = previous & IndexMask;
+			// a value the reader never took is dropped, the writer keeps going instead of waiting for it
+			if (previous & FreshBit)
+			{
+				Dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+			Version.fetch_add(1, std::memory_order_release);
+			// a syscall only while a reader sleeps in WaitForVersion, and even then it does not wait for the reader
+			Version.notify_all();
+		}
+
+		// reader only, true if a value newer than the read buffer was published and is now in it
+		bool Acquire()
+		{
+			if (!(Spare.load(std::memory_order_relaxed) & FreshBit))
+				return false;
+			const uint8_t previous = Spare.exchange(ReadIndex, std::memory_order_acq_rel);
+			ReadIndex = previous & IndexMask;
+			return true;
+		}
+
+		// reader only, the value taken by the last successful Acquire
+		inline const T& GetReadBuffer() const { return Slots[ReadIndex]; }
+
+		// any thread, bumped by every Publish and Wake; a reader with nothing to do waits on it with WaitForVersion
+		inline uint64_t GetVersion() const { return Version.load(std::memory_order_acquire); }
+
+		// any thread, blocks until the version moves past version; Publish itself never blocks
+		inline void WaitForVersion(const uint64_t version) const { Version.wait(version, std::memory_order_acquire); }
+
+		// wakes a reader blocked in WaitForVersion without publishing, for example to stop it
+		inline void Wake()
+		{
+			Version.fetch_add(1, std::memory_order_release);
+			Version.notify_all();
+		}
+
+		// any thread, published values that were replaced before the reader took them
+		inline uint64_t GetDroppedCount() const { return Dropped.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr uint8_t IndexMask = 0x3;
+		static constexpr uint8_t FreshBit = 0x4;
+
+		std::array<T, 3> Slots{};
+		// the index of the spare slot, with FreshBit set while it holds a value the reader has not taken
+		alignas(64) std::atomic<uint8_t> Spare{ 1 };
+		alignas(64) std::atomic<uint64_t> Version{ 0 };
+		std::atomic<uint64_t> Dropped{ 0 };
+		// owned by the writer
+		alignas(64) uint8_t WriteIndex = 0;
+		// owned by the reader
+		alignas(64) uint8_t ReadIndex = 2;
+	};
+}
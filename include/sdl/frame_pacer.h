@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace chipotto
+{
+	// how far the frame starts landed from their deadlines
+	struct FramePacerStats
+	{
+		uint64_t frames = 0;
+		// frames that started more than a whole period late, their deadlines were moved instead of caught up
+		uint64_t late_frames = 0;
+		double mean_jitter_us = 0;
+		double max_jitter_us = 0;
+	};
+
+	/// <summary>
+	/// Keeps a host loop at a fixed frame rate without burning a core: it sleeps until shortly before
+	/// each deadline, where the OS timer is still reliable, and spins through the last stretch.
+	/// </summary>
+	class FramePacer
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/// <param name="frame_rate">frames per second</param>
+		/// <param name="spin_margin">how long before each deadline to stop sleeping and start spinning</param>
+		FramePacer(const double frame_rate = 60.0, const std::chrono::microseconds spin_margin = std::chrono::microseconds(500));
+
+		/// <summary>
+		/// Blocks until the next frame is due, measured from the previous deadline so the error never accumulates.
+		/// </summary>
+		void WaitForNextFrame();
+
+		// schedules the next frame one period from now and clears the stats
+		void Restart();
+
+		// schedules the next frame one period from now, after the host stopped pacing for a while
+		inline void Resync() { Deadline = Clock::now(); }
+
+		inline const FramePacerStats& GetStats() const { return Stats; }
+
+	private:
+		void SleepUntil(const Clock::time_point deadline) const;
+
+		Clock::duration Period;
+		Clock::duration SpinMargin;
+		Clock::time_point Deadline;
+		FramePacerStats Stats;
+		double TotalJitterUs = 0;
+	};
+}
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "renderer.h"
+#include "runner/rgba_expander.h"
+
+#include <cstdint>
+#include <vector>
 
 class SDL_Window;
 class SDL_Renderer;
@@ -8,26 +12,47 @@ class SDL_Texture;
 
 namespace chipotto
 {
+	// what coalescing the frames into one present per emulated frame saved
+	struct SDLRendererStats
+	{
+		// frames handed over by the core, one per CLS and DRW
+		uint64_t frames = 0;
+		uint64_t presents = 0;
+		// frames that were shown as part of a later present instead of their own
+		uint64_t presents_saved = 0;
+		uint64_t bytes_uploaded = 0;
+		// bytes a whole texture upload per frame would have sent on top of bytes_uploaded
+		uint64_t bytes_saved = 0;
+	};
+
 	class SDLEmuRenderer : public EmuRenderer
 	{
 	public:
 		SDLEmuRenderer(const int width, const int height);
 
-		virtual void ClearScreen() override;
+		// draws into a window created elsewhere and leaves it open; the calling thread is the one that may render from then on
+		SDLEmuRenderer(SDL_Window* shared_window, const int width, const int height);
+
 		/// <summary>
-		/// SDL implementation of the DRW command.
-		/// Draws a sprite from memory starting at location I, at (Vx, Vy) coords.
+		/// Uploads the rows that changed since the last frame to the streaming texture, in the colors of SetColors.
+		/// Nothing reaches the window until the next Present, however many frames arrive before it.
 		/// </summary>
-		/// <param name="x_coord">the x coordinate where the sprite is drawn</param>
-		/// <param name="y_coord">the y coordinate where the sprite is drawn</param>
-		/// <param name="raw_sprite_mono"> the sprite data using a single channel configuration</param>
-		/// <param name="sprite_height"> the sprite height</param>
-		/// <param name="do_wrap">if true, the sprite wraps around the screen</param>
-		/// <param name="out_collision">true on pixel collision(s), false otherwise</param>
-		/// <returns>0 if no error occurred</returns>
-		virtual int Draw(uint8_t const x_coord, const uint8_t y_coord,
-			const uint8_t* raw_sprite_mono, const uint8_t sprite_height, bool do_wrap,
-			bool& out_collision) override;
+		/// <param name="rows">the whole screen, one uint64_t per row with bit 63 as the leftmost pixel</param>
+		virtual void DrawFrame(const Framebuffer& rows) override;
+
+		// copies the texture to the window if a frame arrived since the last present, call it once per emulated frame; false if nothing was shown
+		bool Present();
+
+		// uploads the whole next frame, after the texture was written or lost outside the renderer
+		inline void Invalidate() { UploadAll = true; }
+
+		// RGBA pixels as made by PackRgba, white and transparent black by default; the next frame is uploaded whole
+		void SetColors(const uint32_t on_color, const uint32_t off_color);
+
+		inline const SDLRendererStats& GetStats() const { return Stats; }
+
+		// waits for the display refresh on every present, on by default
+		void SetVSync(const bool vsync);
 
 		inline virtual bool IsValid() override
 		{
@@ -43,8 +68,21 @@ namespace chipotto
 #endif // EMU_TEST
 
 	protected:
+		// the SDL renderer and the streaming texture for window, both destroyed with the renderer
+		void CreateRenderTarget();
+
 		SDL_Window* window = nullptr;
 		SDL_Renderer* renderer = nullptr;
 		SDL_Texture* texture = nullptr;
+		bool OwnsWindow = true;
+
+		// the rows the texture holds, and the same rows expanded to RGBA, TexelPitch pixels apart
+		Framebuffer Uploaded{};
+		RgbaExpander Expander;
+		int TexelPitch;
+		std::vector<uint32_t> Texels;
+		bool UploadAll = true;
+		bool FramePending = false;
+		SDLRendererStats Stats;
 	};
 }
\ No newline at end of file
@@ -21,6 +21,8 @@ namespace chipotto
 		virtual EmuKey GetKey() override;
 		virtual bool IsKeyPressed(const EmuKey key) override;
 		virtual InputType GetInputEventType() override;
+		// sleeps in the SDL event queue, the event is left there for IsInputPending
+		virtual bool WaitForInput(const uint32_t timeout_ms) override;
 
 	protected:
 		// used to link the SDL_Keycode to the emulator hex key
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "renderer.h"
+#include "runner/triple_buffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <thread>
+
+class SDL_Window;
+
+namespace chipotto
+{
+	// what the render thread did with the frames the emulation published
+	struct SDLRenderThreadStats
+	{
+		uint64_t published = 0;
+		// frames that actually reached the window
+		uint64_t presented = 0;
+		// published frames a newer one replaced before the render thread got to them
+		uint64_t dropped = 0;
+	};
+
+	/// <summary>
+	/// Shows the screen from a thread of its own, so a vsync wait or a compositor stall never holds up emulation.
+	/// The emulation thread draws through DrawFrame and calls PublishFrame once per emulated frame, which hands
+	/// the screen over through a lock-free triple buffer and returns at once. The render thread takes the newest
+	/// frame, uploads it and presents it with vsync, at the display rate; frames that came faster than that are skipped whole,
+	/// so the window never shows half of one frame and half of the next.
+	/// The window is created on the constructing thread, which keeps handling its events.
+	/// </summary>
+	class SDLRenderThread : public EmuRenderer
+	{
+	public:
+		SDLRenderThread(const int width, const int height);
+		virtual ~SDLRenderThread() override;
+
+		SDLRenderThread(const SDLRenderThread& other) = delete;
+		SDLRenderThread& operator=(const SDLRenderThread& other) = delete;
+
+		// emulation thread, only fills the frame PublishFrame hands over next
+		virtual void DrawFrame(const Framebuffer& rows) override;
+
+		// emulation thread, hands the screen to the render thread if it changed since the last call; never blocks
+		void PublishFrame();
+
+		// false if the window or the render thread could not set up SDL
+		inline virtual bool IsValid() override { return window && RenderTargetReady; }
+
+		// emulation thread
+		SDLRenderThreadStats GetStats() const;
+
+	private:
+		void Run(std::promise<bool>& ready);
+
+		SDL_Window* window = nullptr;
+		TripleBuffer<Framebuffer> Frames;
+		// the screen as DrawFrame last left it, owned by the emulation thread
+		Framebuffer Latest{};
+		bool LatestChanged = true;
+		uint64_t Published = 0;
+
+		std::atomic<bool> StopRequested{ false };
+		std::atomic<uint64_t> Presented{ 0 };
+		bool RenderTargetReady = false;
+		std::thread Thread;
+	};
+}
@@ -0,0 +1,47 @@
+#include "aot/static_program.h"
+
+#include "iinput_command.h"
+#include "irandom_generator.h"
+#include "keys.h"
+
+namespace chipotto
+{
+	DecodedInstruction StaticRuntime::Decode(const uint16_t opcode)
+	{
+		return EmulatorImpl::Decode(opcode);
+	}
+
+	bool StaticRuntime::IsBlockTerminator(const Instruction id)
+	{
+		return EmulatorImpl::IsBlockTerminator(id);
+	}
+
+	void StaticRuntime::Execute(StaticMachine& machine, const uint16_t opcode)
+	{
+		DecodedInstruction instruction = EmulatorImpl::Decode(opcode);
+		machine.emulator.Execute(instruction);
+	}
+
+	OpcodeStatus StaticRuntime::Terminate(StaticMachine& machine, const uint16_t address, const uint16_t opcode)
+	{
+		machine.PC = address;
+		DecodedInstruction instruction = EmulatorImpl::Decode(opcode);
+		const OpcodeStatus status = machine.emulator.Execute(instruction);
+		if (status == OpcodeStatus::IncrementPC)
+		{
+			machine.PC += 2;
+			return OpcodeStatus::NotIncrementPC;
+		}
+		return status;
+	}
+
+	uint8_t StaticRuntime::RandomByte(StaticMachine& machine)
+	{
+		return machine.emulator.random_generator->GetRandomByte();
+	}
+
+	bool StaticRuntime::IsKeyPressed(StaticMachine& machine, const uint8_t key)
+	{
+		return machine.emulator.input_class->IsKeyPressed(INT_AS_KEY(key));
+	}
+}
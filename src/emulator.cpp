@@ -24,6 +24,26 @@ bool chipotto::Emulator::Tick(const float deltatime)
 	return impl->Tick(deltatime);
 }
 
+chipotto::RunStatus chipotto::Emulator::RunCycles(const uint32_t cycle_count)
+{
+	return impl->RunCycles(cycle_count);
+}
+
+chipotto::RunStatus chipotto::Emulator::RunFrame()
+{
+	return impl->RunFrame();
+}
+
+void chipotto::Emulator::SetInstructionsPerFrame(const uint32_t instructions_per_frame)
+{
+	impl->SetInstructionsPerFrame(instructions_per_frame);
+}
+
+bool chipotto::Emulator::IsBlockedOnKey() const
+{
+	return impl->IsBlockedOnKey();
+}
+
 void chipotto::Emulator::HardResetEmulator()
 {
 	impl->HardResetEmulator();
@@ -33,3 +53,18 @@ void chipotto::Emulator::SetDoWrap(const bool do_wrap)
 {
 	impl->SetDoWrap(do_wrap);
 }
+
+void chipotto::Emulator::SetQuirkProfile(const QuirkProfile profile)
+{
+	impl->SetQuirkProfile(profile);
+}
+
+void chipotto::Emulator::SetDispatchMode(const DispatchMode mode)
+{
+	impl->SetDispatchMode(mode);
+}
+
+void chipotto::Emulator::SetStaticProgram(const StaticProgram* program)
+{
+	impl->SetStaticProgram(program);
+}
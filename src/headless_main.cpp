@@ -0,0 +1,118 @@
+#include "emulator_impl.h"
+#include "gamefile.h"
+#include "runner/headless_renderer.h"
+#include "runner/rgba_expander.h"
+#include "runner/runner_input.h"
+#include "runner/seeded_random.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	chipotto::Gamefile* ReadGamefile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return nullptr;
+		const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (bytes.empty())
+			return nullptr;
+		chipotto::Gamefile* gamefile = new chipotto::Gamefile(bytes.size());
+		std::copy(bytes.begin(), bytes.end(), gamefile->bytecode);
+		return gamefile;
+	}
+
+	// a binary PPM of the screen, white on black and scaled up 10 times
+	bool WriteImage(const std::filesystem::path& path, const chipotto::Framebuffer& rows)
+	{
+		const chipotto::RgbaExpander expander(chipotto::PackRgba(0xFF, 0xFF, 0xFF, 0xFF), chipotto::PackRgba(0x00, 0x00, 0x00, 0xFF), 10);
+		std::vector<uint32_t> pixels(size_t(expander.GetWidth()) * expander.GetHeight());
+		expander.Expand(rows, pixels.data(), size_t(expander.GetWidth()) * 4);
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+		file << "P6\n" << expander.GetWidth() << " " << expander.GetHeight() << "\n255\n";
+		for (const uint32_t& pixel : pixels)
+		{
+			// the first three bytes of an RGBA pixel are its RGB
+			file.write(reinterpret_cast<const char*>(&pixel), 3);
+		}
+		return file.good();
+	}
+}
+
+// usage: Chip8Headless rom_path [frame_count] [instructions_per_frame] [seed] [image_path]
+// runs the rom with no window and no SDL, and prints how it ended
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("usage: Chip8Headless rom_path [frame_count] [instructions_per_frame] [seed] [image_path]\n");
+		return -1;
+	}
+	const auto start = std::chrono::steady_clock::now();
+	const uint32_t frame_count = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 600;
+	const uint32_t instructions_per_frame = argc > 3 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 10;
+	const uint64_t seed = argc > 4 ? strtoull(argv[4], nullptr, 10) : 0;
+
+	chipotto::Gamefile* gamefile = ReadGamefile(argv[1]);
+	if (!gamefile)
+	{
+		printf("unable to read %s\n", argv[1]);
+		return -1;
+	}
+
+	chipotto::HeadlessRenderer* screen = new chipotto::HeadlessRenderer();
+	chipotto::EmulatorImpl emulator(screen, new chipotto::RunnerInput(), new chipotto::SeededRandom(seed));
+	emulator.HardResetEmulator();
+	emulator.SetInstructionsPerFrame(instructions_per_frame);
+	if (!emulator.Load(gamefile))
+	{
+		printf("unable to load %s\n", argv[1]);
+		delete gamefile;
+		return -1;
+	}
+	const auto ready = std::chrono::steady_clock::now();
+
+	chipotto::RunStatus status = chipotto::RunStatus::FrameDone;
+	uint32_t frames_run = 0;
+	while (frames_run < frame_count && status != chipotto::RunStatus::Quit && status != chipotto::RunStatus::Error)
+	{
+		status = emulator.RunFrame();
+		++frames_run;
+	}
+	const auto done = std::chrono::steady_clock::now();
+
+	printf("ready in %.1f us, %u frames in %.3f ms\n", std::chrono::duration<double, std::micro>(ready - start).count(), frames_run,
+		std::chrono::duration<double, std::milli>(done - ready).count());
+	printf("%llu cycles, %llu screen updates, last status %d\n", static_cast<unsigned long long>(emulator.GetCycles()),
+		static_cast<unsigned long long>(screen->GetFrameCount()), static_cast<int>(status));
+	// the screen as text, one character per pixel
+	for (const uint64_t row : screen->GetFrame())
+	{
+		char line[65];
+		for (int column = 0; column < 64; ++column)
+		{
+			line[column] = (row >> (63 - column)) & 1 ? '#' : '.';
+		}
+		line[64] = '\0';
+		printf("%s\n", line);
+	}
+
+	int result = status == chipotto::RunStatus::Error ? 1 : 0;
+	if (argc > 5 && !WriteImage(argv[5], screen->GetFrame()))
+	{
+		printf("unable to write %s\n", argv[5]);
+		result = -1;
+	}
+	delete gamefile;
+	return result;
+}
@@ -0,0 +1,415 @@
+#include "jit/jit_compiler.h"
+
+#if CHIP8_HAS_JIT
+
+#include <bit>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif // _WIN32
+
+#include "emulator_impl.h"
+#include "iinput_command.h"
+#include "irandom_generator.h"
+
+namespace chipotto
+{
+	namespace
+	{
+		constexpr size_t JitBufferSize = 1 << 20;
+		constexpr size_t JitBlockAlignment = 16;
+		// rbx, r12 and the return address leave rsp 8 bytes off, 40 more keep it aligned with room for the Win64 shadow space
+		constexpr uint8_t JitFrameSize = 40;
+
+#ifdef _WIN32
+		constexpr X64Emitter::Reg64 FirstArgument = X64Emitter::RCX;
+		constexpr X64Emitter::Reg64 SecondArgument = X64Emitter::RDX;
+#else
+		constexpr X64Emitter::Reg64 FirstArgument = X64Emitter::RDI;
+		constexpr X64Emitter::Reg64 SecondArgument = X64Emitter::RSI;
+#endif // _WIN32
+
+		uint8_t* AllocateCodeBuffer(const size_t size)
+		{
+#ifdef _WIN32
+			return static_cast<uint8_t*>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#else
+			void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			return memory == MAP_FAILED ? nullptr : static_cast<uint8_t*>(memory);
+#endif // _WIN32
+		}
+
+		void FreeCodeBuffer(uint8_t* buffer, const size_t size)
+		{
+#ifdef _WIN32
+			VirtualFree(buffer, 0, MEM_RELEASE);
+#else
+			munmap(buffer, size);
+#endif // _WIN32
+		}
+
+		// the buffer is never writable and executable at the same time
+		bool SetCodeBufferWritable(uint8_t* buffer, const size_t size, const bool writable)
+		{
+#ifdef _WIN32
+			DWORD old_protection;
+			if (!VirtualProtect(buffer, size, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &old_protection))
+				return false;
+			if (!writable)
+			{
+				FlushInstructionCache(GetCurrentProcess(), buffer, size);
+			}
+			return true;
+#else
+			return mprotect(buffer, size, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+#endif // _WIN32
+		}
+
+		uint64_t PackInstruction(const DecodedInstruction& instruction)
+		{
+			static_assert(sizeof(DecodedInstruction) == sizeof(uint64_t), "DecodedInstruction must fit in a register");
+			return std::bit_cast<uint64_t>(instruction);
+		}
+
+		int32_t DisplacementBetween(const void* base, const void* field)
+		{
+			return static_cast<int32_t>(reinterpret_cast<intptr_t>(field) - reinterpret_cast<intptr_t>(base));
+		}
+	}
+
+	JitCompiler::JitCompiler(EmulatorImpl* emulator) : Emulator(emulator)
+	{
+		Buffer = AllocateCodeBuffer(JitBufferSize);
+		if (Buffer)
+		{
+			Capacity = JitBufferSize;
+		}
+
+		const uint8_t* registers = Emulator->State.Registers.data();
+		IDisp = DisplacementBetween(registers, &Emulator->State.I);
+		PCDisp = DisplacementBetween(registers, &Emulator->State.PC);
+		DelayTimerDisp = DisplacementBetween(registers, &Emulator->State.DelayTimer);
+	}
+
+	JitCompiler::~JitCompiler()
+	{
+		if (Buffer)
+		{
+			FreeCodeBuffer(Buffer, Capacity);
+		}
+	}
+
+	void JitCompiler::Reset()
+	{
+		Used = 0;
+	}
+
+	JitBlockFunction JitCompiler::Compile(const uint16_t start, const uint16_t length)
+	{
+		if (!Buffer)
+			return nullptr;
+
+		Emitter.Clear();
+		EmitPrologue();
+
+		uint16_t address = start;
+		for (uint16_t i = 0; i < length; ++i, address += 2)
+		{
+			const DecodedInstruction& instruction = Emulator->DecodeCache[address >> 1];
+			if (!EmitInstruction(instruction, address, i == length - 1))
+				break;
+		}
+
+		const size_t offset = (Used + JitBlockAlignment - 1) & ~(JitBlockAlignment - 1);
+		if (offset + Emitter.GetSize() > Capacity)
+			return nullptr;
+
+		if (!SetCodeBufferWritable(Buffer, Capacity, true))
+			return nullptr;
+		memcpy(Buffer + offset, Emitter.GetCode().data(), Emitter.GetSize());
+		if (!SetCodeBufferWritable(Buffer, Capacity, false))
+			return nullptr;
+
+		Used = offset + Emitter.GetSize();
+		return reinterpret_cast<JitBlockFunction>(Buffer + offset);
+	}
+
+#pragma region Emission
+
+	int32_t JitCompiler::RegisterDisp(const uint8_t index) const
+	{
+		return index;
+	}
+
+	int32_t JitCompiler::ShiftSourceDisp(const DecodedInstruction& instruction) const
+	{
+		const bool reads_vy = WithQuirkPolicy(Emulator->Profile, []<typename Quirks>() { return Quirks::ShiftReadsVy; });
+		return RegisterDisp(reads_vy ? instruction.y : instruction.x);
+	}
+
+	void JitCompiler::EmitPrologue()
+	{
+		Emitter.Push(X64Emitter::RBX);
+		Emitter.Push(X64Emitter::R12);
+		Emitter.SubRsp(JitFrameSize);
+		Emitter.MovReg64(X64Emitter::R12, FirstArgument);
+		Emitter.MovImm64(X64Emitter::RBX, reinterpret_cast<uint64_t>(Emulator->State.Registers.data()));
+	}
+
+	void JitCompiler::EmitEpilogue()
+	{
+		Emitter.AddRsp(JitFrameSize);
+		Emitter.Pop(X64Emitter::R12);
+		Emitter.Pop(X64Emitter::RBX);
+		Emitter.Ret();
+	}
+
+	void JitCompiler::EmitReturnStatus(const int status)
+	{
+		Emitter.MovEaxImm32(status);
+		EmitEpilogue();
+	}
+
+	void JitCompiler::EmitCall(const void* function)
+	{
+		Emitter.MovImm64(X64Emitter::RAX, reinterpret_cast<uint64_t>(function));
+		Emitter.CallRax();
+	}
+
+	void JitCompiler::EmitLoadEmulatorArgument()
+	{
+		Emitter.MovReg64(FirstArgument, X64Emitter::R12);
+	}
+
+	void JitCompiler::EmitSkipTail(const uint16_t address, const bool skip_if_equal)
+	{
+		// the stores leave the flags of the comparison untouched
+		Emitter.MovMem16Imm(PCDisp, address + 2);
+		size_t no_skip = skip_if_equal ? Emitter.Jne8() : Emitter.Je8();
+		Emitter.MovMem16Imm(PCDisp, address + 4);
+		Emitter.PatchRel8(no_skip);
+		EmitReturnStatus(static_cast<int>(OpcodeStatus::NotIncrementPC));
+	}
+
+	void JitCompiler::EmitShiftCopy(const DecodedInstruction& instruction)
+	{
+		// VF is already written, so the source is read again like the interpreter does
+		const int32_t source = ShiftSourceDisp(instruction);
+		if (source != RegisterDisp(instruction.x))
+		{
+			Emitter.LoadReg8(X64Emitter::AL, source);
+			Emitter.StoreReg8(RegisterDisp(instruction.x), X64Emitter::AL);
+		}
+	}
+
+	void JitCompiler::EmitInterpret(const DecodedInstruction& instruction)
+	{
+		EmitLoadEmulatorArgument();
+		Emitter.MovImm64(SecondArgument, PackInstruction(instruction));
+		EmitCall(reinterpret_cast<const void*>(&JitCompiler::Interpret));
+	}
+
+	void JitCompiler::EmitInterpretTerminator(const DecodedInstruction& instruction, const uint16_t address)
+	{
+		Emitter.MovMem16Imm(PCDisp, address);
+		EmitInterpret(instruction);
+
+		// retire like the interpreter does, the caller only ever sees NotIncrementPC or a stop status
+		Emitter.CmpEaxImm8(static_cast<uint8_t>(OpcodeStatus::IncrementPC));
+		size_t keep_status = Emitter.Jne8();
+		Emitter.AddMem16Imm8(PCDisp, 2);
+		Emitter.MovEaxImm32(static_cast<uint32_t>(OpcodeStatus::NotIncrementPC));
+		Emitter.PatchRel8(keep_status);
+		EmitEpilogue();
+	}
+
+	bool JitCompiler::EmitInstruction(const DecodedInstruction& instruction, const uint16_t address, const bool is_last)
+	{
+		const int32_t vx = RegisterDisp(instruction.x);
+		const int32_t vy = RegisterDisp(instruction.y);
+		const int32_t vf = RegisterDisp(0xF);
+		// with VF as an operand the flag write is visible to the operation, like in the interpreter
+		const bool touches_vf = instruction.x == 0xF || instruction.y == 0xF;
+
+		switch (instruction.id)
+		{
+		case Instruction::LD_VX_BYTE:
+			Emitter.MovMem8Imm(vx, instruction.nn);
+			break;
+		case Instruction::ADD_VX_BYTE:
+			Emitter.AddMem8Imm(vx, instruction.nn);
+			break;
+		case Instruction::LD_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vy);
+			Emitter.StoreReg8(vx, X64Emitter::AL);
+			break;
+		case Instruction::OR_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vy);
+			Emitter.OrMem8Al(vx);
+			break;
+		case Instruction::AND_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vy);
+			Emitter.AndMem8Al(vx);
+			break;
+		case Instruction::XOR_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vy);
+			Emitter.XorMem8Al(vx);
+			break;
+		case Instruction::ADD_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vx);
+			Emitter.AddAlMem8(vy);
+			Emitter.SetcCl();
+			if (touches_vf)
+			{
+				Emitter.StoreReg8(vf, X64Emitter::CL);
+				Emitter.LoadReg8(X64Emitter::AL, vx);
+				Emitter.AddAlMem8(vy);
+				Emitter.StoreReg8(vx, X64Emitter::AL);
+			}
+			else
+			{
+				Emitter.StoreReg8(vx, X64Emitter::AL);
+				Emitter.StoreReg8(vf, X64Emitter::CL);
+			}
+			break;
+		case Instruction::SUB_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vx);
+			Emitter.CmpAlMem8(vy);
+			Emitter.SetaCl();
+			Emitter.StoreReg8(vf, X64Emitter::CL);
+			Emitter.LoadReg8(X64Emitter::AL, vx);
+			Emitter.SubAlMem8(vy);
+			Emitter.StoreReg8(vx, X64Emitter::AL);
+			break;
+		case Instruction::SUBN_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vy);
+			Emitter.CmpAlMem8(vx);
+			Emitter.SetaCl();
+			Emitter.StoreReg8(vf, X64Emitter::CL);
+			Emitter.LoadReg8(X64Emitter::AL, vy);
+			Emitter.SubAlMem8(vx);
+			Emitter.StoreReg8(vx, X64Emitter::AL);
+			break;
+		// the profile is fixed while the block lives, SetQuirkProfile throws compiled blocks away
+		case Instruction::SHR_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, ShiftSourceDisp(instruction));
+			Emitter.AndAlImm(0x1);
+			Emitter.StoreReg8(vf, X64Emitter::AL);
+			EmitShiftCopy(instruction);
+			Emitter.ShrMem8(vx);
+			break;
+		case Instruction::SHL_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, ShiftSourceDisp(instruction));
+			Emitter.ShrAlImm(7);
+			Emitter.StoreReg8(vf, X64Emitter::AL);
+			EmitShiftCopy(instruction);
+			Emitter.ShlMem8(vx);
+			break;
+		case Instruction::LD_I_ADDR:
+			Emitter.MovMem16Imm(IDisp, instruction.nnn);
+			break;
+		case Instruction::ADD_I_VX:
+			Emitter.MovzxReg32Mem8(X64Emitter::RAX, vx);
+			Emitter.AddMem16Ax(IDisp);
+			break;
+		case Instruction::LD_F_VX:
+			Emitter.MovzxReg32Mem8(X64Emitter::RAX, vx);
+			Emitter.LeaEaxTimesFive();
+			Emitter.StoreAx(IDisp);
+			break;
+		case Instruction::LD_VX_DT:
+			Emitter.LoadReg8(X64Emitter::AL, DelayTimerDisp);
+			Emitter.StoreReg8(vx, X64Emitter::AL);
+			break;
+		case Instruction::RND_VX_BYTE:
+			Emitter.MovMem16Imm(PCDisp, address);
+			EmitLoadEmulatorArgument();
+			EmitCall(reinterpret_cast<const void*>(&JitCompiler::RandomByte));
+			Emitter.AndAlImm(instruction.nn);
+			Emitter.StoreReg8(vx, X64Emitter::AL);
+			break;
+		case Instruction::CLS:
+		case Instruction::LD_DT_VX:
+		case Instruction::LD_ST_VX:
+		case Instruction::LD_VX_I:
+			Emitter.MovMem16Imm(PCDisp, address);
+			EmitInterpret(instruction);
+			break;
+
+#pragma region Terminators
+		case Instruction::JP:
+			Emitter.MovMem16Imm(PCDisp, instruction.nnn);
+			EmitReturnStatus(static_cast<int>(OpcodeStatus::NotIncrementPC));
+			return false;
+		case Instruction::SE_VX_BYTE:
+			Emitter.CmpMem8Imm(vx, instruction.nn);
+			EmitSkipTail(address, true);
+			return false;
+		case Instruction::SNE_VX_BYTE:
+			Emitter.CmpMem8Imm(vx, instruction.nn);
+			EmitSkipTail(address, false);
+			return false;
+		case Instruction::SE_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vx);
+			Emitter.CmpAlMem8(vy);
+			EmitSkipTail(address, true);
+			return false;
+		case Instruction::SNE_VX_VY:
+			Emitter.LoadReg8(X64Emitter::AL, vx);
+			Emitter.CmpAlMem8(vy);
+			EmitSkipTail(address, false);
+			return false;
+		case Instruction::SKP_VX:
+		case Instruction::SKNP_VX:
+			Emitter.MovMem16Imm(PCDisp, address);
+			EmitLoadEmulatorArgument();
+			Emitter.MovzxReg32Mem8(SecondArgument, vx);
+			EmitCall(reinterpret_cast<const void*>(&JitCompiler::IsKeyPressed));
+			Emitter.TestEax();
+			// a pressed key clears ZF
+			EmitSkipTail(address, instruction.id == Instruction::SKNP_VX);
+			return false;
+		default:
+			// CALL, RET, JP V0, DRW, FX0A, the memory writes and invalid opcodes
+			EmitInterpretTerminator(instruction, address);
+			return false;
+#pragma endregion
+		}
+
+		if (is_last)
+		{
+			// the block was cut by its maximum length
+			Emitter.MovMem16Imm(PCDisp, address + 2);
+			EmitReturnStatus(static_cast<int>(OpcodeStatus::NotIncrementPC));
+			return false;
+		}
+		return true;
+	}
+
+#pragma endregion
+#pragma region Trampolines
+
+	int JitCompiler::Interpret(EmulatorImpl* emulator, const uint64_t packed_instruction)
+	{
+		DecodedInstruction instruction = std::bit_cast<DecodedInstruction>(packed_instruction);
+		return static_cast<int>(emulator->Execute(instruction));
+	}
+
+	uint32_t JitCompiler::RandomByte(EmulatorImpl* emulator)
+	{
+		return emulator->random_generator->GetRandomByte();
+	}
+
+	uint32_t JitCompiler::IsKeyPressed(EmulatorImpl* emulator, const uint32_t key)
+	{
+		return emulator->input_class->IsKeyPressed(INT_AS_KEY(key)) ? 1 : 0;
+	}
+
+#pragma endregion
+}
+
+#endif // CHIP8_HAS_JIT
@@ -0,0 +1,845 @@
+#include "lockstep/lockstep_emulator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "font.h"
+#include "gamefile.h"
+#include "irandom_generator.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace chipotto
+{
+	namespace
+	{
+		using LaneMask = uint32_t;
+		constexpr size_t Stride = 32;
+
+#pragma region Lane Operations
+
+#if defined(__AVX2__)
+		// one register of every lane
+		using Bytes = __m256i;
+
+		inline Bytes LoadBytes(const uint8_t* bytes) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(bytes)); }
+		inline Bytes Broadcast(const uint8_t value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+
+		// 0xFF in the bytes of the lanes in mask
+		inline __m256i ByteMask(const LaneMask mask)
+		{
+			const __m256i spread = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(mask)),
+				_mm256_setr_epi64x(0x0000000000000000ll, 0x0101010101010101ll, 0x0202020202020202ll, 0x0303030303030303ll));
+			const __m256i bits = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ull));
+			return _mm256_cmpeq_epi8(_mm256_and_si256(spread, bits), bits);
+		}
+
+		inline void Blend(uint8_t* bytes, const Bytes value, const LaneMask mask)
+		{
+			_mm256_store_si256(reinterpret_cast<__m256i*>(bytes), _mm256_blendv_epi8(LoadBytes(bytes), value, ByteMask(mask)));
+		}
+
+		inline Bytes Add(const Bytes a, const Bytes b) { return _mm256_add_epi8(a, b); }
+		inline Bytes Sub(const Bytes a, const Bytes b) { return _mm256_sub_epi8(a, b); }
+		inline Bytes Or(const Bytes a, const Bytes b) { return _mm256_or_si256(a, b); }
+		inline Bytes And(const Bytes a, const Bytes b) { return _mm256_and_si256(a, b); }
+		inline Bytes Xor(const Bytes a, const Bytes b) { return _mm256_xor_si256(a, b); }
+		// the 16 bit shifts move bits across bytes, the masks drop them again
+		inline Bytes ShiftRight(const Bytes a) { return _mm256_and_si256(_mm256_srli_epi16(a, 1), Broadcast(0x7F)); }
+		inline Bytes ShiftLeft(const Bytes a) { return _mm256_add_epi8(a, a); }
+		inline Bytes LowBit(const Bytes a) { return _mm256_and_si256(a, Broadcast(0x01)); }
+		inline Bytes HighBit(const Bytes a) { return _mm256_and_si256(_mm256_srli_epi16(a, 7), Broadcast(0x01)); }
+
+		// 1 where a + b overflows, 0 elsewhere
+		inline Bytes Carry(const Bytes a, const Bytes b)
+		{
+			return _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_adds_epu8(a, b), _mm256_add_epi8(a, b)), Broadcast(0x01));
+		}
+
+		// 1 where a > b unsigned, 0 elsewhere
+		inline Bytes Greater(const Bytes a, const Bytes b)
+		{
+			return _mm256_andnot_si256(_mm256_cmpeq_epi8(a, b), _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(a, b), a), Broadcast(0x01)));
+		}
+
+		inline LaneMask Equal(const Bytes a, const Bytes b)
+		{
+			return static_cast<LaneMask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+		}
+
+		// 0xFFFF in the words of the lanes in mask, lanes 0 to 15 and 16 to 31
+		inline void WordMasks(const LaneMask mask, __m256i& out_low, __m256i& out_high)
+		{
+			const __m256i bytes = ByteMask(mask);
+			out_low = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(bytes));
+			out_high = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(bytes, 1));
+		}
+
+		inline void AddWords(uint16_t* words, const uint16_t value, const LaneMask mask)
+		{
+			__m256i low, high;
+			WordMasks(mask, low, high);
+			__m256i* halves = reinterpret_cast<__m256i*>(words);
+			const __m256i add = _mm256_set1_epi16(static_cast<short>(value));
+			_mm256_store_si256(halves, _mm256_add_epi16(_mm256_load_si256(halves), _mm256_and_si256(add, low)));
+			_mm256_store_si256(halves + 1, _mm256_add_epi16(_mm256_load_si256(halves + 1), _mm256_and_si256(add, high)));
+		}
+
+		inline void SetWords(uint16_t* words, const uint16_t value, const LaneMask mask)
+		{
+			__m256i low, high;
+			WordMasks(mask, low, high);
+			__m256i* halves = reinterpret_cast<__m256i*>(words);
+			const __m256i set = _mm256_set1_epi16(static_cast<short>(value));
+			_mm256_store_si256(halves, _mm256_blendv_epi8(_mm256_load_si256(halves), set, low));
+			_mm256_store_si256(halves + 1, _mm256_blendv_epi8(_mm256_load_si256(halves + 1), set, high));
+		}
+
+		inline LaneMask EqualWords(const uint16_t* words, const uint16_t value)
+		{
+			const __m256i* halves = reinterpret_cast<const __m256i*>(words);
+			const __m256i compare = _mm256_set1_epi16(static_cast<short>(value));
+			const __m256i low = _mm256_cmpeq_epi16(_mm256_load_si256(halves), compare);
+			const __m256i high = _mm256_cmpeq_epi16(_mm256_load_si256(halves + 1), compare);
+			// packing interleaves the 128 bit halves, the permute puts the lanes back in order
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+			return static_cast<LaneMask>(_mm256_movemask_epi8(packed));
+		}
+
+		// the lane of mask with the lowest word, mask must not be empty
+		inline size_t LowestWord(const uint16_t* words, const LaneMask mask)
+		{
+			__m256i low, high;
+			WordMasks(mask, low, high);
+			const __m256i* halves = reinterpret_cast<const __m256i*>(words);
+			// the lanes outside mask read as 0xFFFF, so they only win when every lane of mask sits at 0xFFFF too
+			const __m256i masked_low = _mm256_or_si256(_mm256_load_si256(halves), _mm256_andnot_si256(low, _mm256_set1_epi16(-1)));
+			const __m256i masked_high = _mm256_or_si256(_mm256_load_si256(halves + 1), _mm256_andnot_si256(high, _mm256_set1_epi16(-1)));
+			const __m256i both = _mm256_min_epu16(masked_low, masked_high);
+			const __m128i lowest = _mm_min_epu16(_mm256_castsi256_si128(both), _mm256_extracti128_si256(both, 1));
+			const uint16_t value = static_cast<uint16_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(lowest)));
+			return static_cast<size_t>(std::countr_zero(EqualWords(words, value) & mask));
+		}
+
+		// the counters of lanes 8 * chunk to 8 * chunk + 7, 1 for the lanes in mask
+		inline __m256i CounterBits(const LaneMask mask, const size_t chunk)
+		{
+			const __m256i shifted = _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(mask >> (8 * chunk))), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			return _mm256_and_si256(shifted, _mm256_set1_epi32(1));
+		}
+
+		inline void DecrementCounters(uint32_t* counters, const LaneMask mask, const size_t lanes)
+		{
+			for (size_t chunk = 0; chunk < lanes / 8; ++chunk)
+			{
+				__m256i* eight = reinterpret_cast<__m256i*>(counters) + chunk;
+				_mm256_store_si256(eight, _mm256_sub_epi32(_mm256_load_si256(eight), CounterBits(mask, chunk)));
+			}
+		}
+
+		inline LaneMask EqualCounters(const uint32_t* a, const uint32_t* b, const size_t lanes)
+		{
+			LaneMask mask = 0;
+			for (size_t chunk = 0; chunk < lanes / 8; ++chunk)
+			{
+				const __m256i equal = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(a) + chunk),
+					_mm256_load_si256(reinterpret_cast<const __m256i*>(b) + chunk));
+				mask |= static_cast<LaneMask>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) << (8 * chunk);
+			}
+			return mask;
+		}
+
+		inline LaneMask ZeroCounters(const uint32_t* counters, const size_t lanes)
+		{
+			LaneMask mask = 0;
+			for (size_t chunk = 0; chunk < lanes / 8; ++chunk)
+			{
+				const __m256i zero = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(counters) + chunk), _mm256_setzero_si256());
+				mask |= static_cast<LaneMask>(_mm256_movemask_ps(_mm256_castsi256_ps(zero))) << (8 * chunk);
+			}
+			return mask;
+		}
+#else
+		// one register of every lane, in plain loops the compiler is free to vectorize
+		struct Bytes
+		{
+			std::array<uint8_t, Stride> Lane;
+		};
+
+		template<typename Function>
+		inline Bytes Map(const Bytes a, const Bytes b, Function function)
+		{
+			Bytes result;
+			for (size_t lane = 0; lane < Stride; ++lane)
+			{
+				result.Lane[lane] = static_cast<uint8_t>(function(a.Lane[lane], b.Lane[lane]));
+			}
+			return result;
+		}
+
+		inline Bytes LoadBytes(const uint8_t* bytes)
+		{
+			Bytes result;
+			memcpy(result.Lane.data(), bytes, Stride);
+			return result;
+		}
+
+		inline Bytes Broadcast(const uint8_t value)
+		{
+			Bytes result;
+			result.Lane.fill(value);
+			return result;
+		}
+
+		inline void Blend(uint8_t* bytes, const Bytes value, const LaneMask mask)
+		{
+			for (size_t lane = 0; lane < Stride; ++lane)
+			{
+				bytes[lane] = (mask >> lane) & 1 ? value.Lane[lane] : bytes[lane];
+			}
+		}
+
+		inline Bytes Add(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x + y; }); }
+		inline Bytes Sub(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x - y; }); }
+		inline Bytes Or(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x | y; }); }
+		inline Bytes And(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x & y; }); }
+		inline Bytes Xor(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x ^ y; }); }
+		inline Bytes ShiftRight(const Bytes a) { return Map(a, a, [](const uint8_t x, const uint8_t) { return x >> 1; }); }
+		inline Bytes ShiftLeft(const Bytes a) { return Map(a, a, [](const uint8_t x, const uint8_t) { return x << 1; }); }
+		inline Bytes LowBit(const Bytes a) { return Map(a, a, [](const uint8_t x, const uint8_t) { return x & 0x1; }); }
+		inline Bytes HighBit(const Bytes a) { return Map(a, a, [](const uint8_t x, const uint8_t) { return x >> 7; }); }
+		inline Bytes Carry(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x + y > 255 ? 1 : 0; }); }
+		inline Bytes Greater(const Bytes a, const Bytes b) { return Map(a, b, [](const uint8_t x, const uint8_t y) { return x > y ? 1 : 0; }); }
+
+		inline LaneMask Equal(const Bytes a, const Bytes b)
+		{
+			LaneMask mask = 0;
+			for (size_t lane = 0; lane < Stride; ++lane)
+			{
+				mask |= static_cast<LaneMask>(a.Lane[lane] == b.Lane[lane]) << lane;
+			}
+			return mask;
+		}
+
+		inline void AddWords(uint16_t* words, const uint16_t value, const LaneMask mask)
+		{
+			for (size_t lane = 0; lane < Stride; ++lane)
+			{
+				words[lane] += ((mask >> lane) & 1) * value;
+			}
+		}
+
+		inline void SetWords(uint16_t* words, const uint16_t value, const LaneMask mask)
+		{
+			for (size_t lane = 0; lane < Stride; ++lane)
+			{
+				words[lane] = (mask >> lane) & 1 ? value : words[lane];
+			}
+		}
+
+		inline LaneMask EqualWords(const uint16_t* words, const uint16_t value)
+		{
+			LaneMask mask = 0;
+			for (size_t lane = 0; lane < Stride; ++lane)
+			{
+				mask |= static_cast<LaneMask>(words[lane] == value) << lane;
+			}
+			return mask;
+		}
+
+		inline size_t LowestWord(const uint16_t* words, const LaneMask mask)
+		{
+			size_t lowest = static_cast<size_t>(std::countr_zero(mask));
+			for (size_t lane = lowest + 1; lane < Stride; ++lane)
+			{
+				if ((mask >> lane) & 1 && words[lane] < words[lowest])
+				{
+					lowest = lane;
+				}
+			}
+			return lowest;
+		}
+
+		inline void DecrementCounters(uint32_t* counters, const LaneMask mask, const size_t lanes)
+		{
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				counters[lane] -= (mask >> lane) & 1;
+			}
+		}
+
+		inline LaneMask EqualCounters(const uint32_t* a, const uint32_t* b, const size_t lanes)
+		{
+			LaneMask mask = 0;
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				mask |= static_cast<LaneMask>(a[lane] == b[lane]) << lane;
+			}
+			return mask;
+		}
+
+		inline LaneMask ZeroCounters(const uint32_t* counters, const size_t lanes)
+		{
+			LaneMask mask = 0;
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				mask |= static_cast<LaneMask>(counters[lane] == 0) << lane;
+			}
+			return mask;
+		}
+#endif
+
+		// the lanes of mask one at a time, lowest first
+		template<typename Function>
+		inline void ForEachLane(LaneMask mask, Function function)
+		{
+			while (mask != 0)
+			{
+				function(static_cast<size_t>(std::countr_zero(mask)));
+				mask &= mask - 1;
+			}
+		}
+
+		inline uint16_t ReadOpcode(const std::array<uint8_t, 0x1000>& memory, const uint16_t address)
+		{
+			return static_cast<uint16_t>((memory[address & 0xFFF] << 8) | memory[(address + 1) & 0xFFF]);
+		}
+
+		inline uint64_t RotateRight(const uint64_t value, const int shift)
+		{
+			return shift == 0 ? value : (value >> shift) | (value << (64 - shift));
+		}
+
+#pragma endregion
+	}
+
+	template<size_t Lanes>
+	LockstepEmulator<Lanes>::LockstepEmulator(const std::array<IRandomGenerator*, Lanes>& random_generators)
+		: Memory(Lanes)
+	{
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			RandomGenerators[lane].reset(random_generators[lane]);
+		}
+		HardReset();
+	}
+
+	template<size_t Lanes>
+	LockstepEmulator<Lanes>::~LockstepEmulator() = default;
+
+	template<size_t Lanes>
+	bool LockstepEmulator<Lanes>::Load(const Gamefile* gamefile)
+	{
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			const uint16_t start = PC[lane] & 0xFFF;
+			memcpy(Memory[lane].data() + start, gamefile->bytecode, std::min<size_t>(gamefile->size, Memory[lane].size() - start));
+		}
+		return true;
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::HardReset()
+	{
+		for (auto& registers : Registers)
+		{
+			registers.fill(0);
+		}
+		I.fill(0);
+		PC.fill(0);
+		DelayTimer.fill(0);
+		SoundTimer.fill(0);
+		Remaining.fill(0);
+		TimerStepAt.fill(0);
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			PC[lane] = 0x200;
+			Memory[lane].fill(0);
+			memcpy(Memory[lane].data(), FontSprites.data(), FontSprites.size());
+		}
+		SP.fill(0xFF);
+		for (auto& stack : Stacks)
+		{
+			stack.fill(0);
+		}
+		WaitRegister.fill(0);
+		CyclesSinceTimerStep.fill(0);
+		Cycles.fill(0);
+		Suspended = 0;
+		Failed = 0;
+		for (auto& rows : Framebuffers)
+		{
+			rows.fill(0);
+		}
+		WrittenPages.fill(0);
+		KeysDown.fill(0);
+		PendingPress.fill(EmuKey::K_NONE);
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::SetQuirkProfile(const QuirkProfile profile)
+	{
+		Profile = profile;
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::SetInstructionsPerFrame(const uint32_t instructions_per_frame)
+	{
+		InstructionsPerFrame = std::max(instructions_per_frame, 1u);
+		for (uint32_t& since_step : CyclesSinceTimerStep)
+		{
+			since_step = std::min(since_step, InstructionsPerFrame - 1);
+		}
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::KeyDown(const size_t lane, const EmuKey key)
+	{
+		if (KEY_AS_INT(key) >= KEY_AS_INT(EmuKey::K_NONE))
+			return;
+		KeysDown[lane] |= 1 << KEY_AS_INT(key);
+		if (PendingPress[lane] == EmuKey::K_NONE)
+		{
+			PendingPress[lane] = key;
+		}
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::KeyUp(const size_t lane, const EmuKey key)
+	{
+		if (KEY_AS_INT(key) >= KEY_AS_INT(EmuKey::K_NONE))
+			return;
+		KeysDown[lane] &= ~(1 << KEY_AS_INT(key));
+	}
+
+	template<size_t Lanes>
+	typename LockstepEmulator<Lanes>::LaneMask LockstepEmulator<Lanes>::RunFrame()
+	{
+		// a press completes a waiting FX0A before the frame runs, like EmulatorImpl::PollInput
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			if (PendingPress[lane] != EmuKey::K_NONE && (Suspended >> lane) & 1)
+			{
+				Registers[WaitRegister[lane]][lane] = static_cast<uint8_t>(PendingPress[lane]);
+				PC[lane] += 2;
+				Suspended &= ~(LaneMask(1) << lane);
+			}
+			PendingPress[lane] = EmuKey::K_NONE;
+			Remaining[lane] = InstructionsPerFrame;
+			// the instruction that ends a timer period leaves exactly CyclesSinceTimerStep instructions in the frame
+			TimerStepAt[lane] = CyclesSinceTimerStep[lane];
+		}
+		Failed = 0;
+		ConsumeSuspended(Suspended);
+
+		WithQuirkPolicy(Profile, [&]<typename Quirks>() { RunSteps<Quirks>(); });
+
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			// a lane that failed stops with the rest of its budget unspent
+			const uint32_t executed = InstructionsPerFrame - Remaining[lane];
+			Cycles[lane] += executed;
+			CyclesSinceTimerStep[lane] = (CyclesSinceTimerStep[lane] + executed) % InstructionsPerFrame;
+		}
+		return Failed;
+	}
+
+	template<size_t Lanes>
+	template<typename Quirks>
+	void LockstepEmulator<Lanes>::RunSteps()
+	{
+		LaneMask active = AllLanes & ~Suspended;
+		LaneMask group = 0;
+		while (active != 0)
+		{
+			uint16_t opcode = 0;
+			group = PickGroup(active, group == active, opcode);
+			const LaneMask failed = Execute<Quirks>(opcode, group);
+
+			DecrementCounters(Remaining.data(), group, Lanes);
+			const LaneMask stepping = EqualCounters(Remaining.data(), TimerStepAt.data(), Lanes) & group;
+			if (stepping != 0)
+			{
+				StepTimers(stepping);
+			}
+			LaneInstructions += std::popcount(group);
+			++Steps;
+
+			Failed |= failed;
+			if (Suspended & group)
+			{
+				ConsumeSuspended(Suspended & group);
+			}
+			active &= ~ZeroCounters(Remaining.data(), Lanes) & ~Suspended & ~Failed;
+		}
+	}
+
+	template<size_t Lanes>
+	typename LockstepEmulator<Lanes>::LaneMask LockstepEmulator<Lanes>::PickGroup(const LaneMask active, const bool converged, uint16_t& out_opcode)
+	{
+		// the lane with the lowest PC leads: lanes that skipped ahead inside a loop body wait there for the others,
+		// which is where forward branches join again; while every active lane ran the last step together any of them can lead
+		const size_t leader = converged ? static_cast<size_t>(std::countr_zero(active)) : LowestWord(PC.data(), active);
+
+		const uint16_t pc = PC[leader];
+		out_opcode = ReadOpcode(Memory[leader], pc);
+		LaneMask group = EqualWords(PC.data(), pc) & active;
+
+		// lanes that wrote the memory under the instruction may hold different code there
+		const LaneMask rewritten = (WrittenPages[(pc & 0xFFF) >> 6] | WrittenPages[((pc + 1) & 0xFFF) >> 6]) & group;
+		ForEachLane(rewritten, [&](const size_t lane)
+		{
+			if (ReadOpcode(Memory[lane], pc) != out_opcode)
+			{
+				group &= ~(LaneMask(1) << lane);
+			}
+		});
+		return group;
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::ConsumeSuspended(const LaneMask lanes)
+	{
+		// a waiting lane idles through the rest of the frame, the timers still step
+		ForEachLane(lanes, [&](const size_t lane)
+		{
+			if (TimerStepAt[lane] < Remaining[lane])
+			{
+				StepTimers(LaneMask(1) << lane);
+			}
+			Remaining[lane] = 0;
+		});
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::StepTimers(const LaneMask lanes)
+	{
+		ForEachLane(lanes, [&](const size_t lane)
+		{
+			if (DelayTimer[lane] > 0)
+			{
+				DelayTimer[lane]--;
+			}
+			if (SoundTimer[lane] > 0)
+			{
+				SoundTimer[lane]--;
+			}
+		});
+	}
+
+	template<size_t Lanes>
+	void LockstepEmulator<Lanes>::MarkWritten(const size_t lane, const uint16_t first, const uint16_t last)
+	{
+		for (uint32_t address = first; address <= last; ++address)
+		{
+			WrittenPages[(address & 0xFFF) >> 6] |= LaneMask(1) << lane;
+		}
+	}
+
+	template<size_t Lanes>
+	template<typename Quirks>
+	typename LockstepEmulator<Lanes>::LaneMask LockstepEmulator<Lanes>::Execute(const uint16_t opcode, const LaneMask group)
+	{
+		const uint8_t x = (opcode >> 8) & 0xF;
+		const uint8_t y = (opcode >> 4) & 0xF;
+		const uint8_t n = opcode & 0xF;
+		const uint8_t nn = opcode & 0xFF;
+		const uint16_t nnn = opcode & 0xFFF;
+
+		// the lanes that move past the instruction, and the lanes it failed on
+		LaneMask advance = group;
+		LaneMask failed = 0;
+
+		switch (opcode >> 12)
+		{
+		case 0x0:
+			if (opcode == 0x00E0)
+			{
+				ForEachLane(group, [&](const size_t lane) { Framebuffers[lane].fill(0); });
+			}
+			else if (opcode == 0x00EE)
+			{
+				ForEachLane(group, [&](const size_t lane)
+				{
+					if (SP[lane] > 0xF && SP[lane] < 0xFF)
+					{
+						failed |= LaneMask(1) << lane;
+						return;
+					}
+					PC[lane] = Stacks[lane][SP[lane] & 0xF];
+					SP[lane] -= 1;
+				});
+			}
+			else
+			{
+				failed = group;
+			}
+			break;
+		case 0x1:
+			SetWords(PC.data(), nnn, group);
+			advance = 0;
+			break;
+		case 0x2:
+			ForEachLane(group, [&](const size_t lane)
+			{
+				if (SP[lane] > 0xF)
+				{
+					SP[lane] = 0;
+				}
+				else if (SP[lane] < 0xF)
+				{
+					SP[lane] += 1;
+				}
+				else
+				{
+					failed |= LaneMask(1) << lane;
+					return;
+				}
+				Stacks[lane][SP[lane]] = PC[lane];
+				PC[lane] = nnn;
+			});
+			advance = 0;
+			break;
+		case 0x3:
+			AddWords(PC.data(), 2, Equal(LoadBytes(Registers[x].data()), Broadcast(nn)) & group);
+			break;
+		case 0x4:
+			AddWords(PC.data(), 2, ~Equal(LoadBytes(Registers[x].data()), Broadcast(nn)) & group);
+			break;
+		case 0x5:
+			AddWords(PC.data(), 2, Equal(LoadBytes(Registers[x].data()), LoadBytes(Registers[y].data())) & group);
+			break;
+		case 0x6:
+			Blend(Registers[x].data(), Broadcast(nn), group);
+			break;
+		case 0x7:
+			Blend(Registers[x].data(), Add(LoadBytes(Registers[x].data()), Broadcast(nn)), group);
+			break;
+		case 0x8:
+		{
+			// VF is written before the result, so an instruction with X or Y = F sees the flag like EmulatorImpl does
+			uint8_t* vx = Registers[x].data();
+			const uint8_t* vy = Registers[y].data();
+			uint8_t* vf = Registers[0xF].data();
+			const uint8_t* vs = Quirks::ShiftReadsVy ? vy : vx;
+			switch (n)
+			{
+			case 0x0:
+				Blend(vx, LoadBytes(vy), group);
+				break;
+			case 0x1:
+				Blend(vx, Or(LoadBytes(vx), LoadBytes(vy)), group);
+				break;
+			case 0x2:
+				Blend(vx, And(LoadBytes(vx), LoadBytes(vy)), group);
+				break;
+			case 0x3:
+				Blend(vx, Xor(LoadBytes(vx), LoadBytes(vy)), group);
+				break;
+			case 0x4:
+				Blend(vf, Carry(LoadBytes(vx), LoadBytes(vy)), group);
+				Blend(vx, Add(LoadBytes(vx), LoadBytes(vy)), group);
+				break;
+			case 0x5:
+				Blend(vf, Greater(LoadBytes(vx), LoadBytes(vy)), group);
+				Blend(vx, Sub(LoadBytes(vx), LoadBytes(vy)), group);
+				break;
+			case 0x6:
+				Blend(vf, LowBit(LoadBytes(vs)), group);
+				Blend(vx, ShiftRight(LoadBytes(vs)), group);
+				break;
+			case 0x7:
+				Blend(vf, Greater(LoadBytes(vy), LoadBytes(vx)), group);
+				Blend(vx, Sub(LoadBytes(vy), LoadBytes(vx)), group);
+				break;
+			case 0xE:
+				Blend(vf, HighBit(LoadBytes(vs)), group);
+				Blend(vx, ShiftLeft(LoadBytes(vs)), group);
+				break;
+			default:
+				failed = group;
+				break;
+			}
+			break;
+		}
+		case 0x9:
+			AddWords(PC.data(), 2, ~Equal(LoadBytes(Registers[x].data()), LoadBytes(Registers[y].data())) & group);
+			break;
+		case 0xA:
+			SetWords(I.data(), nnn, group);
+			break;
+		case 0xB:
+		{
+			const uint8_t offset_register = Quirks::JumpReadsVx ? x : 0x0;
+			ForEachLane(group, [&](const size_t lane) { PC[lane] = nnn + Registers[offset_register][lane]; });
+			break;
+		}
+		case 0xC:
+			ForEachLane(group, [&](const size_t lane) { Registers[x][lane] = RandomGenerators[lane]->GetRandomByte() & nn; });
+			break;
+		case 0xD:
+			ForEachLane(group, [&](const size_t lane)
+			{
+				// the same rows and collision rule as EmulatorImpl
+				const uint8_t x_coord = Registers[x][lane] % 64;
+				const uint8_t y_coord = Registers[y][lane] % 32;
+				const uint64_t columns = Quirks::WrapSprites ? RotateRight(0xFFull << 56, x_coord) : (0xFFull << 56) >> x_coord;
+				bool collision = false;
+				for (int row_index = 0; row_index < n; ++row_index)
+				{
+					int row = row_index + y_coord;
+					if (row >= 32)
+					{
+						if (!Quirks::WrapSprites)
+							break;
+						row %= 32;
+					}
+					const uint64_t sprite_row = static_cast<uint64_t>(Memory[lane][(I[lane] + row_index) & 0xFFF]) << 56;
+					const uint64_t bits = Quirks::WrapSprites ? RotateRight(sprite_row, x_coord) : sprite_row >> x_coord;
+					if (Framebuffers[lane][row] & ~bits & columns)
+					{
+						collision = true;
+					}
+					Framebuffers[lane][row] ^= bits;
+				}
+				if (collision)
+				{
+					Registers[0xF][lane] = 0x1;
+				}
+			});
+			break;
+		case 0xE:
+		{
+			if (nn != 0x9E && nn != 0xA1)
+			{
+				failed = group;
+				break;
+			}
+			LaneMask pressed = 0;
+			ForEachLane(group, [&](const size_t lane)
+			{
+				const uint8_t key = Registers[x][lane];
+				if (key < 0x10 && (KeysDown[lane] >> key) & 1)
+				{
+					pressed |= LaneMask(1) << lane;
+				}
+			});
+			AddWords(PC.data(), 2, (nn == 0x9E ? pressed : ~pressed) & group);
+			break;
+		}
+		case 0xF:
+			switch (nn)
+			{
+			case 0x07:
+				Blend(Registers[x].data(), LoadBytes(DelayTimer.data()), group);
+				break;
+			case 0x0A:
+				ForEachLane(group, [&](const size_t lane) { WaitRegister[lane] = x; });
+				Suspended |= group;
+				advance = 0;
+				break;
+			case 0x15:
+				Blend(DelayTimer.data(), LoadBytes(Registers[x].data()), group);
+				break;
+			case 0x18:
+				Blend(SoundTimer.data(), LoadBytes(Registers[x].data()), group);
+				break;
+			case 0x1E:
+				ForEachLane(group, [&](const size_t lane) { I[lane] += Registers[x][lane]; });
+				break;
+			case 0x29:
+				ForEachLane(group, [&](const size_t lane) { I[lane] = 5 * Registers[x][lane]; });
+				break;
+			case 0x33:
+				ForEachLane(group, [&](const size_t lane)
+				{
+					const uint8_t value = Registers[x][lane];
+					Memory[lane][I[lane] & 0xFFF] = value / 100;
+					Memory[lane][(I[lane] + 1) & 0xFFF] = (value / 10) % 10;
+					Memory[lane][(I[lane] + 2) & 0xFFF] = value % 10;
+					MarkWritten(lane, I[lane], I[lane] + 2);
+				});
+				break;
+			case 0x55:
+				ForEachLane(group, [&](const size_t lane)
+				{
+					for (uint8_t i = 0; i <= x; ++i)
+					{
+						Memory[lane][(I[lane] + i) & 0xFFF] = Registers[i][lane];
+					}
+					MarkWritten(lane, I[lane], I[lane] + x);
+					if constexpr (Quirks::LoadStoreAdvancesI)
+					{
+						I[lane] += x + 1;
+					}
+				});
+				break;
+			case 0x65:
+				ForEachLane(group, [&](const size_t lane)
+				{
+					for (uint8_t i = 0; i <= x; ++i)
+					{
+						Registers[i][lane] = Memory[lane][(I[lane] + i) & 0xFFF];
+					}
+					if constexpr (Quirks::LoadStoreAdvancesI)
+					{
+						I[lane] += x + 1;
+					}
+				});
+				break;
+			default:
+				failed = group;
+				break;
+			}
+			break;
+		}
+
+		AddWords(PC.data(), 2, advance & ~failed);
+		return failed;
+	}
+
+	template<size_t Lanes>
+	RunStatus LockstepEmulator<Lanes>::GetStatus(const size_t lane) const
+	{
+		if ((Failed >> lane) & 1)
+			return RunStatus::Error;
+		return (Suspended >> lane) & 1 ? RunStatus::WaitingForKey : RunStatus::FrameDone;
+	}
+
+	template<size_t Lanes>
+	MachineState LockstepEmulator<Lanes>::GetMachineState(const size_t lane) const
+	{
+		MachineState state;
+		for (size_t index = 0; index < 0x10; ++index)
+		{
+			state.Registers[index] = Registers[index][lane];
+		}
+		state.I = I[lane];
+		state.PC = PC[lane];
+		state.SP = SP[lane];
+		state.DelayTimer = DelayTimer[lane];
+		state.SoundTimer = SoundTimer[lane];
+		state.Suspended = (Suspended >> lane) & 1;
+		state.WaitForKeyboardRegister_Index = WaitRegister[lane];
+		state.CyclesSinceTimerStep = CyclesSinceTimerStep[lane];
+		state.Cycles = Cycles[lane];
+		return state;
+	}
+
+	template<size_t Lanes>
+	bool LockstepEmulator<Lanes>::UsesAvx2()
+	{
+#if defined(__AVX2__)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	template class CHIP8_API LockstepEmulator<8>;
+	template class CHIP8_API LockstepEmulator<16>;
+	template class CHIP8_API LockstepEmulator<32>;
+}
@@ -2,12 +2,19 @@
 #include <SDL.h>
 #include "emulator.h"
 #include "sdl/loader.h"
-#include "sdl/sdl_emu_renderer.h"
+#include "sdl/sdl_render_thread.h"
 #include "sdl/sdl_input.h"
 #include "sdl/emulator_random_generator.h"
+#include "sdl/frame_pacer.h"
 
+#include <cstring>
 #include <iostream>
 
+#ifdef CHIP8_AOT_TICTAC
+#include "aot/static_program.h"
+CHIP8_DECLARE_STATIC_PROGRAM(TICTAC)
+#endif // CHIP8_AOT_TICTAC
+
 int main(int argc, char** argv)
 {
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0)
@@ -15,43 +22,89 @@ int main(int argc, char** argv)
 		SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
 		return -1;
 	}
-	float last_tick = SDL_GetTicks64();
-
-	chipotto::SDLEmuRenderer* renderer = new chipotto::SDLEmuRenderer(64, 32);
+	chipotto::FramePacer pacer;
+	// fast-forward: --turbo runs unthrottled for the whole session, holding Tab does it on demand
+	const bool turbo_requested = argc > 1 && strcmp(argv[1], "--turbo") == 0;
+	bool turbo = false;
 
-	if (!renderer->IsValid())
+	// the emulator owns the render thread, leaving the block joins it and closes the window before SDL_Quit
 	{
-		SDL_Quit();
-		return -1;
-	}
+		// presents from its own thread at the display rate, the frames below only hand their screen over
+		chipotto::SDLRenderThread* renderer = new chipotto::SDLRenderThread(64, 32);
 
-	chipotto::SDLInput* input_class = new chipotto::SDLInput();
-	chipotto::EmulatorRandomGenerator* random_generator = new chipotto::EmulatorRandomGenerator();
+		if (!renderer->IsValid())
+		{
+			delete renderer;
+			SDL_Quit();
+			return -1;
+		}
 
-	chipotto::Emulator emulator(renderer, input_class, random_generator);
+		chipotto::SDLInput* input_class = new chipotto::SDLInput();
+		chipotto::EmulatorRandomGenerator* random_generator = new chipotto::EmulatorRandomGenerator();
 
-	chipotto::Gamefile* gamefile;
-	if (!chipotto::Loader::ReadFromFile("resources\\TICTAC", &gamefile))
-	{
-		goto quit_on_error;	// panicking
-	}
+		chipotto::Emulator emulator(renderer, input_class, random_generator);
+
+		chipotto::Gamefile* gamefile;
+		if (!chipotto::Loader::ReadFromFile("resources\\TICTAC", &gamefile))
+		{
+			goto quit_on_error;	// panicking
+		}
 
-	emulator.Load(gamefile);
+		emulator.Load(gamefile);
 
-	while (true)
-	{
-		float deltatime = SDL_GetTicks64() - last_tick;
-		deltatime *= 0.001f;
-		last_tick = SDL_GetTicks64();
+	#ifdef CHIP8_AOT_TICTAC
+		// only takes effect while the loaded rom is the one translated at build time
+		emulator.SetStaticProgram(&chipotto::aot::TICTAC);
+		emulator.SetDispatchMode(chipotto::DispatchMode::Static);
+	#endif // CHIP8_AOT_TICTAC
 
-		if (!emulator.Tick(deltatime))
+		// one emulated frame every 1/60 s, the instruction rate is set by the frame budget rather than by the host
+		pacer.Restart();
+		while (true)
 		{
-			break;
+			const bool turbo_wanted = turbo_requested || SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_TAB];
+			if (turbo_wanted != turbo)
+			{
+				turbo = turbo_wanted;
+				pacer.Resync();
+			}
+
+			const chipotto::RunStatus status = emulator.RunFrame();
+			renderer->PublishFrame();
+			if (status == chipotto::RunStatus::Quit || status == chipotto::RunStatus::Error)
+			{
+				break;
+			}
+			if (status == chipotto::RunStatus::WaitingForKey && emulator.IsBlockedOnKey())
+			{
+				// nothing but a key can change the machine, sleep in the event queue instead of pacing empty frames
+				input_class->WaitForInput(250);
+				pacer.Resync();
+				continue;
+			}
+			if (turbo)
+			{
+				// no pacing, the timers follow emulated time and fast-forward with the rest of the machine;
+				// the render thread keeps presenting the newest frame once per refresh
+				continue;
+			}
+			pacer.WaitForNextFrame();
 		}
-	}
 
-cleanup:				// jump here if quitting with cleanup is needed
-		delete gamefile;
+		{
+			const chipotto::FramePacerStats& stats = pacer.GetStats();
+			SDL_Log("%llu frames, %llu late, frame start jitter mean %.1f us, max %.1f us",
+				static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.late_frames),
+				stats.mean_jitter_us, stats.max_jitter_us);
+			const chipotto::SDLRenderThreadStats render_stats = renderer->GetStats();
+			SDL_Log("%llu frames published, %llu presented, %llu skipped by the render thread",
+				static_cast<unsigned long long>(render_stats.published), static_cast<unsigned long long>(render_stats.presented),
+				static_cast<unsigned long long>(render_stats.dropped));
+		}
+
+	cleanup:				// jump here if quitting with cleanup is needed
+			delete gamefile;
+	}
 
 quit:
 	SDL_Quit();
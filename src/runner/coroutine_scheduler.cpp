@@ -0,0 +1,139 @@
+#include "runner/coroutine_scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+#include "gamefile.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+
+namespace chipotto
+{
+	// the coroutine of an instance, created suspended and resumed only by Tick
+	struct CoroutineScheduler::Task
+	{
+		struct promise_type
+		{
+			inline Task get_return_object() { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+			inline std::suspend_always initial_suspend() noexcept { return {}; }
+			// the scheduler destroys the frame, a finished instance just stays suspended at the end
+			inline std::suspend_always final_suspend() noexcept { return {}; }
+			inline void return_void() {}
+			inline void unhandled_exception() { std::terminate(); }
+		};
+
+		std::coroutine_handle<promise_type> Handle;
+	};
+
+	CoroutineScheduler::~CoroutineScheduler()
+	{
+		for (Instance& instance : Instances)
+		{
+			instance.Handle.destroy();
+		}
+	}
+
+	uint32_t CoroutineScheduler::Spawn(const Gamefile* gamefile, IRandomGenerator* random_generator)
+	{
+		const uint32_t id = static_cast<uint32_t>(Instances.size());
+		Instance& instance = Instances.emplace_back();
+		instance.Keys = new RunnerInput();
+		instance.Core = std::make_unique<EmulatorImpl>(new HeadlessRenderer(), instance.Keys, random_generator);
+		instance.Core->Load(gamefile);
+		instance.Handle = Run(id).Handle;
+		NextReady.push_back(id);
+		return id;
+	}
+
+	size_t CoroutineScheduler::Tick()
+	{
+		Ready.swap(NextReady);
+		std::vector<uint32_t>& waking = Wheel[Frame % WheelSize];
+		Ready.insert(Ready.end(), waking.begin(), waking.end());
+		waking.clear();
+
+		for (const uint32_t id : Ready)
+		{
+			Instances[id].State = InstanceState::Ready;
+			Instances[id].Handle.resume();
+		}
+
+		const size_t resumed = Ready.size();
+		Ready.clear();
+		++Frame;
+		return resumed;
+	}
+
+	void CoroutineScheduler::KeyDown(const uint32_t id, const EmuKey key)
+	{
+		Instance& instance = Instances[id];
+		instance.Keys->SetKey(key, true);
+		if (instance.State == InstanceState::WaitingForKey)
+		{
+			instance.State = InstanceState::Ready;
+			NextReady.push_back(id);
+		}
+	}
+
+	void CoroutineScheduler::KeyUp(const uint32_t id, const EmuKey key)
+	{
+		Instances[id].Keys->SetKey(key, false);
+	}
+
+	CoroutineScheduler::Task CoroutineScheduler::Run(const uint32_t id)
+	{
+		while (true)
+		{
+			// Spawn may have moved the instances since the last frame
+			EmulatorImpl& core = *Instances[id].Core;
+			if (Instances[id].SleptFrames > 0)
+			{
+				core.RunCycles(Instances[id].SleptFrames * core.GetInstructionsPerFrame());
+				Instances[id].SleptFrames = 0;
+			}
+
+			const RunStatus status = core.RunFrame();
+			if (status == RunStatus::Error || status == RunStatus::Quit)
+			{
+				Instances[id].State = InstanceState::Stopped;
+				co_return;
+			}
+			if (status == RunStatus::WaitingForKey && core.IsBlockedOnKey())
+			{
+				co_await Yield{ *this, id, InstanceState::WaitingForKey };
+				continue;
+			}
+
+			const uint32_t idle_frames = core.GetIdleFrames();
+			if (idle_frames == EmulatorImpl::IdleForever)
+			{
+				Instances[id].State = InstanceState::Halted;
+				co_return;
+			}
+			co_await Yield{ *this, id, idle_frames > 0 ? InstanceState::Sleeping : InstanceState::Ready, idle_frames };
+		}
+	}
+
+	void CoroutineScheduler::Park(const uint32_t id, const InstanceState state, const uint32_t frames)
+	{
+		Instance& instance = Instances[id];
+		instance.State = state;
+		switch (state)
+		{
+		case InstanceState::Ready:
+			NextReady.push_back(id);
+			break;
+		case InstanceState::Sleeping:
+		{
+			// skips the next frames and wakes on the one after them
+			const uint32_t skipped = std::min<uint32_t>(frames, WheelSize - 2);
+			instance.SleptFrames = skipped;
+			Wheel[(Frame + skipped + 1) % WheelSize].push_back(id);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
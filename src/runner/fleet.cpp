@@ -0,0 +1,251 @@
+#include "runner/fleet.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+
+#include "emulator_impl.h"
+#include "gamefile.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+#include "runner/seeded_random.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace chipotto
+{
+	namespace
+	{
+		uint64_t HashRows(const std::array<uint64_t, 32>& rows)
+		{
+			uint64_t hash = 0xCBF29CE484222325ull;
+			for (uint64_t row : rows)
+			{
+				for (int byte = 0; byte < 8; ++byte)
+				{
+					hash = (hash ^ (row & 0xFF)) * 0x100000001B3ull;
+					row >>= 8;
+				}
+			}
+			return hash;
+		}
+
+		void PinCurrentThread(const uint32_t index)
+		{
+			const uint32_t core_count = std::max(std::thread::hardware_concurrency(), 1u);
+#if defined(__linux__)
+			cpu_set_t cores;
+			CPU_ZERO(&cores);
+			CPU_SET(index % core_count, &cores);
+			pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#elif defined(_WIN32)
+			SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (index % std::min(core_count, 64u)));
+#endif
+		}
+	}
+
+	struct Chip8Fleet::Worker
+	{
+		// the owner takes from the back, thieves from the front
+		std::mutex Mutex;
+		std::deque<uint32_t> Queue;
+
+		// the instance pool of the worker, created on its own thread and reset for every job
+		std::unique_ptr<EmulatorImpl> Core;
+		HeadlessRenderer* Screen = nullptr;
+		RunnerInput* Keys = nullptr;
+		SeededRandom* Random = nullptr;
+
+		std::thread Thread;
+	};
+
+	Chip8Fleet::Chip8Fleet(const FleetOptions& options)
+	{
+		const uint32_t worker_count = options.WorkerCount > 0 ? options.WorkerCount : std::max(std::thread::hardware_concurrency(), 1u);
+		for (uint32_t index = 0; index < worker_count; ++index)
+		{
+			Workers.push_back(std::make_unique<Worker>());
+		}
+		for (uint32_t index = 0; index < worker_count; ++index)
+		{
+			Workers[index]->Thread = std::thread([this, index, pin = options.PinWorkers]()
+			{
+				if (pin)
+				{
+					PinCurrentThread(index);
+				}
+				WorkerMain(index);
+			});
+		}
+	}
+
+	Chip8Fleet::~Chip8Fleet()
+	{
+		{
+			std::lock_guard<std::mutex> lock(BatchMutex);
+			StopRequested = true;
+		}
+		BatchStarted.notify_all();
+		for (std::unique_ptr<Worker>& worker : Workers)
+		{
+			worker->Thread.join();
+		}
+	}
+
+	std::vector<FleetResult> Chip8Fleet::Run(const std::vector<FleetJob>& jobs)
+	{
+		std::vector<FleetResult> results(jobs.size());
+		if (jobs.empty())
+		{
+			return results;
+		}
+
+		std::unique_lock<std::mutex> lock(BatchMutex);
+		// every worker is idle here, so the deques can be filled without racing a thief
+		for (uint32_t job = 0; job < jobs.size(); ++job)
+		{
+			Workers[job % Workers.size()]->Queue.push_back(job);
+		}
+		Jobs = &jobs;
+		Results = &results;
+		WorkersDone = 0;
+		++Batch;
+		BatchStarted.notify_all();
+
+		// every worker acknowledges this batch once it is out of jobs, so none of them can still be waking up for it
+		// when the next batch fills the deques, and the last job is done by the time the last worker reports
+		BatchDone.wait(lock, [this]() { return WorkersDone == Workers.size(); });
+		Jobs = nullptr;
+		Results = nullptr;
+		return results;
+	}
+
+	void Chip8Fleet::WorkerMain(const uint32_t index)
+	{
+		uint64_t batch = 0;
+		while (true)
+		{
+			const std::vector<FleetJob>* jobs = nullptr;
+			std::vector<FleetResult>* results = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(BatchMutex);
+				BatchStarted.wait(lock, [this, batch]() { return StopRequested || Batch != batch; });
+				if (StopRequested)
+				{
+					return;
+				}
+				batch = Batch;
+				jobs = Jobs;
+				results = Results;
+			}
+
+			// a worker leaves the batch once no deque has a job left, the jobs still running belong to the others
+			uint32_t job = 0;
+			while (PopJob(index, job) || StealJobs(index, job))
+			{
+				RunJob(*Workers[index], index, (*jobs)[job], (*results)[job]);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(BatchMutex);
+				++WorkersDone;
+			}
+			BatchDone.notify_all();
+		}
+	}
+
+	bool Chip8Fleet::PopJob(const uint32_t index, uint32_t& out_job)
+	{
+		Worker& worker = *Workers[index];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		if (worker.Queue.empty())
+		{
+			return false;
+		}
+		out_job = worker.Queue.back();
+		worker.Queue.pop_back();
+		return true;
+	}
+
+	bool Chip8Fleet::StealJobs(const uint32_t index, uint32_t& out_job)
+	{
+		std::vector<uint32_t> stolen;
+		for (size_t offset = 1; offset < Workers.size() && stolen.empty(); ++offset)
+		{
+			Worker& victim = *Workers[(index + offset) % Workers.size()];
+			std::lock_guard<std::mutex> lock(victim.Mutex);
+			// half of the oldest jobs, rounded up so a single job can be stolen too
+			const size_t count = (victim.Queue.size() + 1) / 2;
+			stolen.assign(victim.Queue.begin(), victim.Queue.begin() + count);
+			victim.Queue.erase(victim.Queue.begin(), victim.Queue.begin() + count);
+		}
+		if (stolen.empty())
+		{
+			return false;
+		}
+
+		StolenJobs.fetch_add(stolen.size(), std::memory_order_relaxed);
+		out_job = stolen.front();
+		if (stolen.size() > 1)
+		{
+			// never holds two deques at once, so two thieves robbing each other cannot deadlock
+			Worker& worker = *Workers[index];
+			std::lock_guard<std::mutex> lock(worker.Mutex);
+			worker.Queue.insert(worker.Queue.end(), stolen.begin() + 1, stolen.end());
+		}
+		return true;
+	}
+
+	void Chip8Fleet::RunJob(Worker& worker, const uint32_t index, const FleetJob& job, FleetResult& out_result)
+	{
+		if (!worker.Core)
+		{
+			worker.Screen = new HeadlessRenderer();
+			worker.Keys = new RunnerInput();
+			worker.Random = new SeededRandom();
+			worker.Core = std::make_unique<EmulatorImpl>(worker.Screen, worker.Keys, worker.Random);
+		}
+		EmulatorImpl& core = *worker.Core;
+		core.HardResetEmulator();
+		worker.Keys->Clear();
+		// reseeded for every job, so a result never depends on the jobs the worker ran before
+		worker.Random->Seed(job.Seed);
+		core.SetQuirkProfile(job.Profile);
+		core.SetInstructionsPerFrame(job.InstructionsPerFrame);
+
+		out_result = {};
+		out_result.Worker = index;
+		if (!job.Game || !core.Load(job.Game))
+		{
+			out_result.Status = RunStatus::Error;
+			return;
+		}
+
+		size_t next_event = 0;
+		for (uint32_t frame = 0; frame < job.Frames; ++frame)
+		{
+			while (next_event < job.Script.size() && job.Script[next_event].Frame <= frame)
+			{
+				worker.Keys->SetKey(job.Script[next_event].Key, job.Script[next_event].Pressed);
+				++next_event;
+			}
+
+			out_result.Status = core.RunFrame();
+			++out_result.FramesRun;
+			if (out_result.Status == RunStatus::Error || out_result.Status == RunStatus::Quit)
+			{
+				break;
+			}
+		}
+
+		out_result.FramebufferHash = HashRows(worker.Screen->GetFrame());
+		out_result.Cycles = core.GetCycles();
+	}
+}
@@ -0,0 +1,14 @@
+#include "runner/headless_renderer.h"
+
+namespace chipotto
+{
+	namespace
+	{
+		const Framebuffer BlankFrame{};
+	}
+
+	HeadlessRenderer::HeadlessRenderer()
+		: EmuRenderer(64, 32), Frame(&BlankFrame)
+	{
+	}
+}
@@ -0,0 +1,134 @@
+#include "runner/rgba_expander.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define CHIP8_EXPAND_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace chipotto
+{
+	namespace
+	{
+		// one line of the scaled image, bit 63 of the first word is the leftmost pixel
+		using ScaledBits = std::array<uint64_t, RgbaExpander::MaxScale>;
+
+		// every pixel of row repeated scale times, in scale words
+		void ScaleBits(const uint64_t row, const uint32_t scale, ScaledBits& out_bits)
+		{
+			std::fill_n(out_bits.begin(), scale, 0);
+			const uint64_t run = (~0ull) << (64 - scale);
+			for (uint64_t lit = row; lit != 0; lit &= lit - 1)
+			{
+				// the scaled run of the pixel may straddle two words
+				const uint32_t first = (63 - std::countr_zero(lit)) * scale;
+				const uint32_t offset = first % 64;
+				out_bits[first / 64] |= run >> offset;
+				if (offset + scale > 64)
+				{
+					out_bits[first / 64 + 1] |= run << (64 - offset);
+				}
+			}
+		}
+
+		// 64 pixels per word of bits, from the most significant bit down
+		void ExpandBits(const uint64_t* words, const uint32_t word_count, const uint32_t on, const uint32_t off, uint32_t* pixels)
+		{
+#if defined(__AVX2__)
+			const __m256i on_pixels = _mm256_set1_epi32(static_cast<int>(on));
+			const __m256i off_pixels = _mm256_set1_epi32(static_cast<int>(off));
+			const __m256i select = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+			for (uint32_t word = 0; word < word_count; ++word)
+			{
+				for (int byte = 0; byte < 8; ++byte)
+				{
+					const __m256i bits = _mm256_set1_epi32(static_cast<int>((words[word] >> (56 - byte * 8)) & 0xFF));
+					const __m256i lit = _mm256_cmpeq_epi32(_mm256_and_si256(bits, select), select);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), _mm256_blendv_epi8(off_pixels, on_pixels, lit));
+					pixels += 8;
+				}
+			}
+#elif defined(CHIP8_EXPAND_SSE2)
+			const __m128i on_pixels = _mm_set1_epi32(static_cast<int>(on));
+			const __m128i off_pixels = _mm_set1_epi32(static_cast<int>(off));
+			const __m128i select = _mm_setr_epi32(0x8, 0x4, 0x2, 0x1);
+			for (uint32_t word = 0; word < word_count; ++word)
+			{
+				for (int nibble = 0; nibble < 16; ++nibble)
+				{
+					const __m128i bits = _mm_set1_epi32(static_cast<int>((words[word] >> (60 - nibble * 4)) & 0xF));
+					const __m128i lit = _mm_cmpeq_epi32(_mm_and_si128(bits, select), select);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_or_si128(_mm_and_si128(lit, on_pixels), _mm_andnot_si128(lit, off_pixels)));
+					pixels += 4;
+				}
+			}
+#else
+			for (uint32_t word = 0; word < word_count; ++word)
+			{
+				for (int bit = 63; bit >= 0; --bit)
+				{
+					*pixels++ = (words[word] >> bit) & 1 ? on : off;
+				}
+			}
+#endif
+		}
+	}
+
+	RgbaExpander::RgbaExpander(const uint32_t on_color, const uint32_t off_color, const uint32_t scale)
+		: OnColor(on_color), OffColor(off_color)
+	{
+		SetScale(scale);
+	}
+
+	void RgbaExpander::SetColors(const uint32_t on_color, const uint32_t off_color)
+	{
+		OnColor = on_color;
+		OffColor = off_color;
+	}
+
+	void RgbaExpander::SetScale(const uint32_t scale)
+	{
+		Scale = std::clamp(scale, 1u, MaxScale);
+	}
+
+	void RgbaExpander::ExpandRows(const Framebuffer& rows, const uint32_t first_row, const uint32_t row_count, uint32_t* pixels, const size_t pitch) const
+	{
+		const uint32_t last_row = std::min<uint32_t>(first_row + row_count, static_cast<uint32_t>(rows.size()));
+		uint8_t* line = reinterpret_cast<uint8_t*>(pixels);
+		ScaledBits bits;
+		for (uint32_t row = first_row; row < last_row; ++row)
+		{
+			if (Scale == 1)
+			{
+				ExpandBits(&rows[row], 1, OnColor, OffColor, reinterpret_cast<uint32_t*>(line));
+				line += pitch;
+				continue;
+			}
+
+			// the first line of the row is expanded, the others are copies of it
+			ScaleBits(rows[row], Scale, bits);
+			ExpandBits(bits.data(), Scale, OnColor, OffColor, reinterpret_cast<uint32_t*>(line));
+			for (uint32_t copy = 1; copy < Scale; ++copy)
+			{
+				memcpy(line + pitch * copy, line, size_t(GetWidth()) * 4);
+			}
+			line += pitch * Scale;
+		}
+	}
+
+	const char* RgbaExpander::GetInstructionSet()
+	{
+#if defined(__AVX2__)
+		return "AVX2";
+#elif defined(CHIP8_EXPAND_SSE2)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+}
@@ -0,0 +1,171 @@
+#include "runner/threaded_runner.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "gamefile.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+
+namespace chipotto
+{
+	ThreadedRunner::ThreadedRunner(IRandomGenerator* random_generator)
+	{
+		Screen = new HeadlessRenderer();
+		Keys = new RunnerInput();
+		Core = std::make_unique<EmulatorImpl>(Screen, Keys, random_generator);
+		Publish();
+		Thread = std::thread(&ThreadedRunner::Run, this);
+	}
+
+	ThreadedRunner::~ThreadedRunner()
+	{
+		StopRequested.store(true, std::memory_order_release);
+		Thread.join();
+
+		// games still in the queue were never handed over to the core
+		RunnerCommand command;
+		while (Commands.TryPop(command))
+		{
+			delete command.Game;
+		}
+	}
+
+	bool ThreadedRunner::Pause()
+	{
+		return Commands.TryPush({ RunnerCommandType::Pause });
+	}
+
+	bool ThreadedRunner::Resume()
+	{
+		return Commands.TryPush({ RunnerCommandType::Resume });
+	}
+
+	bool ThreadedRunner::Load(Gamefile* gamefile)
+	{
+		RunnerCommand command{ RunnerCommandType::Load };
+		command.Game = gamefile;
+		return Commands.TryPush(command);
+	}
+
+	bool ThreadedRunner::Reset()
+	{
+		return Commands.TryPush({ RunnerCommandType::Reset });
+	}
+
+	bool ThreadedRunner::KeyDown(const EmuKey key)
+	{
+		return Commands.TryPush({ RunnerCommandType::KeyDown, key });
+	}
+
+	bool ThreadedRunner::KeyUp(const EmuKey key)
+	{
+		return Commands.TryPush({ RunnerCommandType::KeyUp, key });
+	}
+
+	bool ThreadedRunner::SetSpeed(const float speed)
+	{
+		RunnerCommand command{ RunnerCommandType::SetSpeed };
+		command.Speed = speed;
+		return Commands.TryPush(command);
+	}
+
+	void ThreadedRunner::Run()
+	{
+		using Clock = std::chrono::steady_clock;
+		const Clock::duration frame_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / 60.0));
+		Clock::time_point deadline = Clock::now();
+
+		while (!StopRequested.load(std::memory_order_acquire))
+		{
+			RunnerCommand command;
+			while (Commands.TryPop(command))
+			{
+				ApplyCommand(command);
+			}
+
+			if (!Paused)
+			{
+				LastStatus = Core->RunFrame();
+				++Frames;
+				// a broken ROM stays on screen as it failed, the UI can still reset or load another one
+				if (LastStatus == RunStatus::Error || LastStatus == RunStatus::Quit)
+				{
+					Paused = true;
+				}
+			}
+			Publish();
+
+			const Clock::time_point now = Clock::now();
+			if (Paused)
+			{
+				// only commands can wake a paused machine, checking for them every millisecond costs next to nothing
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				deadline = Clock::now();
+				continue;
+			}
+			if (Speed <= 0.0f)
+			{
+				deadline = now;
+				continue;
+			}
+
+			deadline += std::chrono::duration_cast<Clock::duration>(frame_period / Speed);
+			// after a stall the missed frames are dropped rather than run in a burst
+			if (now - deadline > frame_period)
+			{
+				deadline = now;
+			}
+			std::this_thread::sleep_until(deadline);
+		}
+	}
+
+	void ThreadedRunner::ApplyCommand(const RunnerCommand& command)
+	{
+		switch (command.Type)
+		{
+		case RunnerCommandType::Pause:
+			Paused = true;
+			break;
+		case RunnerCommandType::Resume:
+			Paused = false;
+			break;
+		case RunnerCommandType::Load:
+			Rom.assign(command.Game->bytecode, command.Game->bytecode + command.Game->size);
+			delete command.Game;
+			[[fallthrough]];
+		case RunnerCommandType::Reset:
+		{
+			Core->HardResetEmulator();
+			Keys->Clear();
+			Gamefile gamefile(Rom.size());
+			memcpy(gamefile.bytecode, Rom.data(), Rom.size());
+			Core->Load(&gamefile);
+			LastStatus = RunStatus::FrameDone;
+			break;
+		}
+		case RunnerCommandType::KeyDown:
+			Keys->SetKey(command.Key, true);
+			break;
+		case RunnerCommandType::KeyUp:
+			Keys->SetKey(command.Key, false);
+			break;
+		case RunnerCommandType::SetSpeed:
+			Speed = command.Speed;
+			break;
+		default:
+			break;
+		}
+	}
+
+	void ThreadedRunner::Publish()
+	{
+		RunnerSnapshot snapshot;
+		snapshot.State = Core->GetMachineState();
+		snapshot.Framebuffer = Screen->GetFrame();
+		snapshot.Frames = Frames;
+		snapshot.Status = LastStatus;
+		snapshot.Paused = Paused;
+		Snapshot.Store(snapshot);
+	}
+}
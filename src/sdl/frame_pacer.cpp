@@ -0,0 +1,79 @@
+#include "sdl/frame_pacer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+#if defined(__linux__)
+#include <time.h>
+#endif // __linux__
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define CHIP8_SPIN_PAUSE() _mm_pause()
+#else
+#define CHIP8_SPIN_PAUSE() std::this_thread::yield()
+#endif // x86
+
+namespace chipotto
+{
+	FramePacer::FramePacer(const double frame_rate, const std::chrono::microseconds spin_margin)
+		: Period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frame_rate))),
+		SpinMargin(spin_margin),
+		Deadline(Clock::now())
+	{
+	}
+
+	void FramePacer::WaitForNextFrame()
+	{
+		Deadline += Period;
+
+		Clock::time_point now = Clock::now();
+		if (now < Deadline - SpinMargin)
+		{
+			SleepUntil(Deadline - SpinMargin);
+		}
+		now = Clock::now();
+		while (now < Deadline)
+		{
+			CHIP8_SPIN_PAUSE();
+			now = Clock::now();
+		}
+
+		const double jitter_us = std::chrono::duration<double, std::micro>(now - Deadline).count();
+		++Stats.frames;
+		TotalJitterUs += jitter_us;
+		Stats.mean_jitter_us = TotalJitterUs / Stats.frames;
+		Stats.max_jitter_us = std::max(Stats.max_jitter_us, jitter_us);
+
+		// after a stall the missed frames are dropped, a burst of catch-up frames would only look worse
+		if (now - Deadline > Period)
+		{
+			++Stats.late_frames;
+			Deadline = now;
+		}
+	}
+
+	void FramePacer::Restart()
+	{
+		Resync();
+		Stats = {};
+		TotalJitterUs = 0;
+	}
+
+	void FramePacer::SleepUntil(const Clock::time_point deadline) const
+	{
+#if defined(__linux__)
+		// steady_clock is CLOCK_MONOTONIC here, an absolute wake-up is not pushed back by the time it takes to get here
+		const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+		timespec wake_up;
+		wake_up.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+		wake_up.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_up, nullptr) == EINTR)
+		{
+		}
+#else
+		std::this_thread::sleep_until(deadline);
+#endif // __linux__
+	}
+}
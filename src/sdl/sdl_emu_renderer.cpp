@@ -1,12 +1,12 @@
 #include "sdl/sdl_emu_renderer.h"
 
-#include <cstring>
+#include <algorithm>
 #include <SDL2/SDL.h>
 
 namespace chipotto
 {
 	SDLEmuRenderer::SDLEmuRenderer(const int width, const int height) 
-		: EmuRenderer(width, height)
+		: EmuRenderer(width, height), TexelPitch(std::max(width, 64)), Texels(size_t(TexelPitch) * height, 0)
 	{
 
 		window = SDL_CreateWindow("Chip-8", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width * 10, height * 10, 0);
@@ -15,82 +15,93 @@ namespace chipotto
 			SDL_Log("Unable to create window: %s", SDL_GetError());
 			return;
 		}
+		CreateRenderTarget();
+	}
+
+	SDLEmuRenderer::SDLEmuRenderer(SDL_Window* shared_window, const int width, const int height)
+		: EmuRenderer(width, height), window(shared_window), OwnsWindow(false), TexelPitch(std::max(width, 64)), Texels(size_t(TexelPitch) * height, 0)
+	{
+		if (window)
+		{
+			CreateRenderTarget();
+		}
+	}
+
+	void SDLEmuRenderer::CreateRenderTarget()
+	{
 		renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 		if (!renderer)
 		{
 			SDL_Log("Unable to create renderer: %s", SDL_GetError());
-			SDL_DestroyWindow(window);
 			return;
 		}
 		texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
 		if (!texture)
 		{
 			SDL_Log("Unable to create texture: %s", SDL_GetError());
-			SDL_DestroyRenderer(renderer);
-			SDL_DestroyWindow(window);
 			return;
 		}
 	}
-	void SDLEmuRenderer::ClearScreen()
-	{
-		uint8_t* pixels = nullptr;
-		int pitch;
-		int result = SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&pixels), &pitch);
-		memset(pixels, 0, size_t(pitch) * height);
-		SDL_UnlockTexture(texture);
-		SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-		SDL_RenderPresent(renderer);
-	}
 
-	int SDLEmuRenderer::Draw(uint8_t const x_coord, const uint8_t y_coord,
-		const uint8_t* raw_sprite_mono, const uint8_t sprite_height, bool do_wrap,
-		bool& out_collision)
+	void SDLEmuRenderer::DrawFrame(const Framebuffer& rows)
 	{
-		uint8_t* pixels = nullptr;
-		int pitch;
-		int result = SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&pixels), &pitch);
-		if (result != 0)
-		{
-			SDL_Log("Failed to lock texture");
-			return -1;
-		}
+		++Stats.frames;
+		const int visible_rows = std::min<int>(height, static_cast<int>(rows.size()));
+		const uint64_t row_bytes = uint64_t(width) * 4;
 
-		for (int y = 0; y < sprite_height; ++y)
+		// each run of changed rows goes up with one SDL_UpdateTexture, the rows in between stay as they are
+		int row = 0;
+		while (row < visible_rows)
 		{
-			if (!do_wrap && y + y_coord >= height)
-				break;
-			uint8_t row_byte = raw_sprite_mono[y];
-			for (int x = 0; x < 8; x++)
+			if (!UploadAll && rows[row] == Uploaded[row])
 			{
-				uint8_t pixel_color = (row_byte >> (7 - x)) & 0x1;
-				uint8_t color = 0;
-				if (pixel_color)
-				{
-					color = 0xFF;
-				}
-				if (!do_wrap && x + x_coord >= width)
-					break;
-				int pixel_index = ((x + x_coord) % width) * 4 + pitch * ((y + y_coord) % height);
-				uint8_t existing_pixel = pixels[pixel_index];
-				color ^= existing_pixel;
+				++row;
+				continue;
+			}
 
-				if (existing_pixel != 0 && color != 0)
-				{
-					out_collision = true;
-				}
+			const int first = row;
+			for (; row < visible_rows && (UploadAll || rows[row] != Uploaded[row]); ++row)
+			{
+				Uploaded[row] = rows[row];
+			}
+			Expander.ExpandRows(rows, first, row - first, Texels.data() + size_t(TexelPitch) * first, size_t(TexelPitch) * 4);
 
-				pixels[pixel_index + 0] = color;
-				pixels[pixel_index + 1] = color;
-				pixels[pixel_index + 2] = color;
-				pixels[pixel_index + 3] = color;
+			const SDL_Rect dirty{ 0, first, width, row - first };
+			if (SDL_UpdateTexture(texture, &dirty, Texels.data() + size_t(TexelPitch) * first, TexelPitch * 4) != 0)
+			{
+				SDL_Log("Failed to update texture: %s", SDL_GetError());
 			}
+			Stats.bytes_uploaded += row_bytes * (row - first);
+			FramePending = true;
 		}
+		UploadAll = false;
+		Stats.bytes_saved = Stats.frames * row_bytes * height - Stats.bytes_uploaded;
+	}
 
-		SDL_UnlockTexture(texture);
+	void SDLEmuRenderer::SetColors(const uint32_t on_color, const uint32_t off_color)
+	{
+		Expander.SetColors(on_color, off_color);
+		UploadAll = true;
+	}
 
+	bool SDLEmuRenderer::Present()
+	{
+		if (!FramePending)
+			return false;
 		SDL_RenderCopy(renderer, texture, nullptr, nullptr);
 		SDL_RenderPresent(renderer);
-		return 0;
+		FramePending = false;
+		++Stats.presents;
+		Stats.presents_saved = Stats.frames - Stats.presents;
+		return true;
+	}
+
+	void SDLEmuRenderer::SetVSync(const bool vsync)
+	{
+		if (SDL_RenderSetVSync(renderer, vsync ? 1 : 0) != 0)
+		{
+			SDL_Log("Unable to change vsync: %s", SDL_GetError());
+		}
 	}
 
 	SDLEmuRenderer::~SDLEmuRenderer()
@@ -103,7 +114,7 @@ namespace chipotto
 		{
 			SDL_DestroyRenderer(renderer);
 		}
-		if (window)
+		if (window && OwnsWindow)
 		{
 			SDL_DestroyWindow(window);
 		}
@@ -57,6 +57,11 @@ namespace chipotto
         return GetKeyboardState()[KeyboardValuesMap[key]];
     }
 
+	bool SDLInput::WaitForInput(const uint32_t timeout_ms)
+	{
+		return SDL_WaitEventTimeout(nullptr, static_cast<int>(timeout_ms)) != 0;
+	}
+
 	InputType SDLInput::GetInputEventType()
 	{
 		switch (Event.type)
@@ -0,0 +1,94 @@
+#include "sdl/sdl_render_thread.h"
+
+#include <future>
+#include <SDL2/SDL.h>
+
+#include "sdl/sdl_emu_renderer.h"
+
+namespace chipotto
+{
+	SDLRenderThread::SDLRenderThread(const int width, const int height)
+		: EmuRenderer(width, height)
+	{
+		window = SDL_CreateWindow("Chip-8", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width * 10, height * 10, 0);
+		if (!window)
+		{
+			SDL_Log("Unable to create window: %s", SDL_GetError());
+			return;
+		}
+
+		// the SDL renderer belongs to the thread that creates it, so the render thread sets it up itself
+		std::promise<bool> ready;
+		std::future<bool> ready_result = ready.get_future();
+		Thread = std::thread([this, &ready]() { Run(ready); });
+		RenderTargetReady = ready_result.get();
+	}
+
+	SDLRenderThread::~SDLRenderThread()
+	{
+		if (Thread.joinable())
+		{
+			StopRequested.store(true, std::memory_order_release);
+			Frames.Wake();
+			Thread.join();
+		}
+		if (window)
+		{
+			SDL_DestroyWindow(window);
+		}
+	}
+
+	void SDLRenderThread::DrawFrame(const Framebuffer& rows)
+	{
+		// a frame that redraws the same screen is not worth a present
+		if (rows == Latest)
+			return;
+		Latest = rows;
+		LatestChanged = true;
+	}
+
+	void SDLRenderThread::PublishFrame()
+	{
+		if (!LatestChanged)
+			return;
+		Frames.GetWriteBuffer() = Latest;
+		Frames.Publish();
+		LatestChanged = false;
+		++Published;
+	}
+
+	SDLRenderThreadStats SDLRenderThread::GetStats() const
+	{
+		SDLRenderThreadStats stats;
+		stats.published = Published;
+		stats.presented = Presented.load(std::memory_order_relaxed);
+		stats.dropped = Frames.GetDroppedCount();
+		return stats;
+	}
+
+	void SDLRenderThread::Run(std::promise<bool>& ready)
+	{
+		SDLEmuRenderer target(window, width, height);
+		const bool valid = target.IsValid();
+		ready.set_value(valid);
+		if (!valid)
+			return;
+
+		while (!StopRequested.load(std::memory_order_acquire))
+		{
+			// read before Acquire, so a frame published in between ends the wait at once
+			const uint64_t version = Frames.GetVersion();
+			if (!Frames.Acquire())
+			{
+				Frames.WaitForVersion(version);
+				continue;
+			}
+			target.DrawFrame(Frames.GetReadBuffer());
+			// the vsync wait happens here, on this thread only
+			if (target.Present())
+			{
+				Presented.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+}
@@ -1,5 +1,13 @@
 #pragma once
 
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "gamefile.h"
 #include "irandom_generator.h"
 #include "iinput_command.h"
 #include "input_type.h"
@@ -24,3 +32,64 @@ class MockRandomGenerator : public chipotto::IRandomGenerator
 public:
     virtual uint8_t GetRandomByte() override { return 0xFF; }
 };
+
+// class used to give every instance its own reproducible random sequence
+class MockSeededRandomGenerator : public chipotto::IRandomGenerator
+{
+public:
+    explicit MockSeededRandomGenerator(const uint32_t seed) : State(seed) {}
+    virtual uint8_t GetRandomByte() override
+    {
+        State = State * 1664525u + 1013904223u;
+        return static_cast<uint8_t>(State >> 24);
+    }
+
+private:
+    uint32_t State;
+};
+
+// class used to feed a sequence of input events, each one read once
+class MockEventInputCommand : public chipotto::IInputCommand
+{
+public:
+    virtual const uint8_t* GetKeyboardState() override { return nullptr; };
+    virtual bool IsInputPending() override { return !Events.empty(); };
+    virtual chipotto::EmuKey GetKey() override { return CurrentKey; };
+    virtual bool IsKeyPressed(const chipotto::EmuKey /*key*/) override { return false; };
+    virtual chipotto::InputType GetInputEventType() override
+    {
+        chipotto::InputType type;
+        std::tie(type, CurrentKey) = Events.front();
+        Events.pop_front();
+        return type;
+    };
+
+    std::deque<std::pair<chipotto::InputType, chipotto::EmuKey>> Events;
+    chipotto::EmuKey CurrentKey = chipotto::EmuKey::K_NONE;
+};
+
+// a gamefile holding a copy of the rom
+inline std::unique_ptr<chipotto::Gamefile> MakeGamefile(const uint8_t* rom, const size_t size)
+{
+    auto gamefile = std::make_unique<chipotto::Gamefile>(size);
+    memcpy(gamefile->bytecode, rom, size);
+    return gamefile;
+}
+
+inline std::unique_ptr<chipotto::Gamefile> MakeGamefile(const std::vector<uint8_t>& rom)
+{
+    return MakeGamefile(rom.data(), rom.size());
+}
+
+// loads the rom into any core with a Load(const Gamefile*), the core copies it so the gamefile is freed right away
+template<typename Emulator>
+inline bool LoadRom(Emulator* emulator, const uint8_t* rom, const size_t size)
+{
+    return emulator->Load(MakeGamefile(rom, size).get());
+}
+
+template<typename Emulator>
+inline bool LoadRom(Emulator* emulator, const std::vector<uint8_t>& rom)
+{
+    return LoadRom(emulator, rom.data(), rom.size());
+}
@@ -0,0 +1,90 @@
+#include "clove-unit.h"
+
+#include "aot/static_program.h"
+#include "emulator_impl.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestAot
+
+CHIP8_DECLARE_STATIC_PROGRAM(TICTAC)
+
+static chipotto::EmulatorImpl* static_emulator = nullptr;
+static chipotto::EmulatorImpl* reference_emulator = nullptr;
+
+CLOVE_SUITE_SETUP_ONCE()
+{
+    static_emulator = new chipotto::EmulatorImpl(new chipotto::HeadlessRenderer(), new MockKeyboardStateInputCommand(), new MockRandomGenerator());
+    reference_emulator = new chipotto::EmulatorImpl(new chipotto::HeadlessRenderer(), new MockKeyboardStateInputCommand(), new MockRandomGenerator());
+}
+
+CLOVE_SUITE_SETUP()
+{
+    static_emulator->SetStaticProgram(&chipotto::aot::TICTAC);
+    static_emulator->SetDispatchMode(chipotto::DispatchMode::Static);
+    reference_emulator->SetDispatchMode(chipotto::DispatchMode::Block);
+}
+
+CLOVE_SUITE_TEARDOWN()
+{
+    static_emulator->SetStaticProgram(nullptr);
+    static_emulator->HardResetEmulator();
+    reference_emulator->HardResetEmulator();
+}
+
+CLOVE_SUITE_TEARDOWN_ONCE()
+{
+    delete static_emulator;
+    delete reference_emulator;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(STATIC_PROGRAM_MATCHES_BLOCK_ENGINE)
+{
+    LoadRom(static_emulator, chipotto::aot::TICTAC.rom, chipotto::aot::TICTAC.rom_size);
+    LoadRom(reference_emulator, chipotto::aot::TICTAC.rom, chipotto::aot::TICTAC.rom_size);
+    CLOVE_IS_TRUE(static_emulator->GetStaticBlocks()[0x100] != nullptr);
+
+    // both engines retire a whole block per step, so the machines match after every step
+    const uint64_t static_start = static_emulator->GetInstructionCount();
+    const uint64_t reference_start = reference_emulator->GetInstructionCount();
+    for (int step = 0; step < 5000 && !static_emulator->GetIsSuspended(); ++step)
+    {
+        CLOVE_IS_TRUE(static_emulator->RunInstructions(1));
+        CLOVE_IS_TRUE(reference_emulator->RunInstructions(1));
+
+        CLOVE_ULLONG_EQ(reference_emulator->GetInstructionCount() - reference_start, static_emulator->GetInstructionCount() - static_start);
+        CLOVE_UINT_EQ(reference_emulator->GetPC(), static_emulator->GetPC());
+        CLOVE_UINT_EQ(reference_emulator->GetI(), static_emulator->GetI());
+        CLOVE_UINT_EQ(reference_emulator->GetSP(), static_emulator->GetSP());
+        for (int i = 0; i < 0x10; ++i)
+        {
+            CLOVE_UINT_EQ(reference_emulator->GetRegisters()[i], static_emulator->GetRegisters()[i]);
+        }
+    }
+    CLOVE_IS_TRUE(reference_emulator->GetIsSuspended());
+}
+
+CLOVE_TEST(STATIC_PROGRAM_IGNORED_FOR_OTHER_ROM)
+{
+    const uint8_t rom[] = { 0x60, 0x05, 0x12, 0x02 };
+    LoadRom(static_emulator, rom, sizeof(rom));
+
+    CLOVE_IS_TRUE(static_emulator->GetStaticBlocks().empty());
+    CLOVE_IS_TRUE(static_emulator->RunInstructions(10));
+    CLOVE_UINT_EQ(0x05, static_emulator->GetRegisters()[0x0]);
+}
+
+CLOVE_TEST(STATIC_BLOCKS_DROPPED_ON_WRITE)
+{
+    LoadRom(static_emulator, chipotto::aot::TICTAC.rom, chipotto::aot::TICTAC.rom_size);
+    CLOVE_IS_TRUE(static_emulator->GetStaticBlocks()[0x100] != nullptr);
+
+    // handing out the memory counts as a write to all of it
+    static_emulator->GetMemoryMapping();
+
+    CLOVE_IS_TRUE(static_emulator->GetStaticBlocks()[0x100] == nullptr);
+}
+
+#pragma endregion //TESTS
@@ -0,0 +1,147 @@
+#include "clove-unit.h"
+
+#include <vector>
+
+#include "basic_emulator.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestBackends
+
+namespace
+{
+    // backends without any virtual interface, they only have the members BasicEmulator calls
+    struct CountingRenderer
+    {
+        void DrawFrame(const chipotto::Framebuffer& rows)
+        {
+            ++Frames;
+            LastFrame = rows;
+        }
+
+        int Frames = 0;
+        chipotto::Framebuffer LastFrame{};
+    };
+
+    struct IdleInput
+    {
+        bool IsInputPending() { return false; }
+        chipotto::InputType GetInputEventType() { return chipotto::InputType::NONE; }
+        chipotto::EmuKey GetKey() { return chipotto::EmuKey::K_NONE; }
+        bool IsKeyPressed(const chipotto::EmuKey /*key*/) { return false; }
+    };
+
+    // same bytes as MockRandomGenerator
+    struct ConstantRandom
+    {
+        uint8_t GetRandomByte() { return 0xFF; }
+    };
+
+    using StaticEmulator = chipotto::BasicEmulator<CountingRenderer, IdleInput, ConstantRandom>;
+}
+
+static chipotto::EmulatorImpl* dynamic_emulator = nullptr;
+static StaticEmulator* static_emulator = nullptr;
+static CountingRenderer* counting_renderer = nullptr;
+
+// the screen is cleared before every draw, so no renderer reports a collision
+static const std::vector<uint8_t> backends_rom =
+{
+    0xC0, 0x3F,     // 0x200: RND V0, 0x3F
+    0xC1, 0x1F,     // 0x202: RND V1, 0x1F
+    0xE0, 0x9E,     // 0x204: SKP V0
+    0xE1, 0xA1,     // 0x206: SKNP V1
+    0x72, 0x01,     // 0x208: ADD V2, 0x01 (skipped)
+    0x73, 0x01,     // 0x20A: ADD V3, 0x01
+    0x00, 0xE0,     // 0x20C: CLS
+    0xA3, 0x00,     // 0x20E: LD I, 0x300
+    0xD0, 0x15,     // 0x210: DRW V0, V1, 5
+    0x12, 0x00,     // 0x212: JP 0x200
+};
+
+CLOVE_SUITE_SETUP_ONCE()
+{
+    dynamic_emulator = new chipotto::EmulatorImpl(new chipotto::HeadlessRenderer(), new MockKeyboardStateInputCommand(), new MockRandomGenerator());
+    counting_renderer = new CountingRenderer();
+    static_emulator = new StaticEmulator(counting_renderer, new IdleInput(), new ConstantRandom());
+}
+
+CLOVE_SUITE_SETUP()
+{
+    dynamic_emulator->HardResetEmulator();
+    static_emulator->HardResetEmulator();
+    counting_renderer->Frames = 0;
+}
+
+CLOVE_SUITE_TEARDOWN_ONCE()
+{
+    delete dynamic_emulator;
+    delete static_emulator;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(STATIC_BACKENDS_MATCH_VIRTUAL)
+{
+    const chipotto::DispatchMode modes[] =
+    {
+        chipotto::DispatchMode::Table,
+        chipotto::DispatchMode::Switch,
+        chipotto::DispatchMode::Threaded,
+        chipotto::DispatchMode::Block
+    };
+
+    for (const chipotto::DispatchMode mode : modes)
+    {
+        dynamic_emulator->HardResetEmulator();
+        static_emulator->HardResetEmulator();
+        dynamic_emulator->SetDispatchMode(mode);
+        static_emulator->SetDispatchMode(mode);
+        LoadRom(dynamic_emulator, backends_rom);
+        LoadRom(static_emulator, backends_rom);
+
+        // fused and block dispatches retire several instructions at once, so both stop on the same loop count
+        while (dynamic_emulator->GetRegisters()[0x3] < 100)
+        {
+            CLOVE_IS_TRUE(dynamic_emulator->RunInstructions(1));
+        }
+        while (static_emulator->GetRegisters()[0x3] < 100)
+        {
+            CLOVE_IS_TRUE(static_emulator->RunInstructions(1));
+        }
+
+        CLOVE_UINT_EQ(dynamic_emulator->GetPC(), static_emulator->GetPC());
+        CLOVE_UINT_EQ(dynamic_emulator->GetI(), static_emulator->GetI());
+        for (int i = 0; i < 0x10; ++i)
+        {
+            CLOVE_UINT_EQ(dynamic_emulator->GetRegisters()[i], static_emulator->GetRegisters()[i]);
+        }
+        CLOVE_UINT_EQ(0, static_emulator->GetRegisters()[0x2]);
+        CLOVE_UINT_EQ(100, static_emulator->GetRegisters()[0x3]);
+    }
+}
+
+CLOVE_TEST(STATIC_BACKENDS_RECEIVE_CALLS)
+{
+    // the block engine retires every instruction on its own, ten loops are exactly 90 of them
+    static_emulator->SetDispatchMode(chipotto::DispatchMode::Block);
+    LoadRom(static_emulator, backends_rom);
+    CLOVE_IS_TRUE(static_emulator->RunInstructions(9 * 10));
+
+    // every CLS and every DRW hands over a finished frame
+    CLOVE_INT_EQ(20, counting_renderer->Frames);
+    CLOVE_IS_TRUE(counting_renderer->LastFrame == static_emulator->GetFramebuffer());
+}
+
+CLOVE_TEST(STATIC_BACKENDS_SKIP_NATIVE_MODES)
+{
+    static_emulator->SetDispatchMode(chipotto::DispatchMode::Jit);
+    CLOVE_IS_TRUE(static_emulator->GetDispatchMode() == chipotto::DispatchMode::Block);
+    static_emulator->SetDispatchMode(chipotto::DispatchMode::Static);
+    CLOVE_IS_TRUE(static_emulator->GetDispatchMode() == chipotto::DispatchMode::Block);
+    static_emulator->SetDispatchMode(chipotto::DispatchMode::Specialized);
+    CLOVE_IS_TRUE(static_emulator->GetDispatchMode() == chipotto::DispatchMode::Switch);
+    CLOVE_UINT_EQ(0, StaticEmulator::GetSpecializedTableSize());
+}
+
+#pragma endregion //TESTS
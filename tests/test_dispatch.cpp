@@ -0,0 +1,344 @@
+#include "clove-unit.h"
+
+#include <vector>
+
+#include "emulator_impl.h"
+#include "gamefile.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestDispatch
+
+static chipotto::EmulatorImpl* dispatch_emulator = nullptr;
+
+// ALU, skips, calls and I arithmetic looping forever, no drawing involved
+static const std::vector<uint8_t> compute_loop_rom =
+{
+    0x6A, 0x00,     // 0x200: LD VA, 0x00
+    0x6B, 0x01,     // 0x202: LD VB, 0x01
+    0xA3, 0x00,     // 0x204: LD I, 0x300
+    0x7A, 0x01,     // 0x206: ADD VA, 0x01
+    0x8A, 0xB4,     // 0x208: ADD VA, VB
+    0x8C, 0xA0,     // 0x20A: LD VC, VA
+    0x8C, 0x06,     // 0x20C: SHR VC
+    0x8C, 0xB5,     // 0x20E: SUB VC, VB
+    0x8D, 0xC3,     // 0x210: XOR VD, VC
+    0x3D, 0x00,     // 0x212: SE VD, 0x00
+    0x8D, 0xA1,     // 0x214: OR VD, VA
+    0x22, 0x20,     // 0x216: CALL 0x220
+    0xFB, 0x1E,     // 0x218: ADD I, VB
+    0x4A, 0x00,     // 0x21A: SNE VA, 0x00
+    0xA3, 0x00,     // 0x21C: LD I, 0x300
+    0x12, 0x06,     // 0x21E: JP 0x206
+    0x8E, 0xA2,     // 0x220: AND VE, VA
+    0x8E, 0x0E,     // 0x222: SHL VE
+    0x9A, 0xB0,     // 0x224: SNE VA, VB
+    0x6E, 0x00,     // 0x226: LD VE, 0x00
+    0xF3, 0x33,     // 0x228: LD B, V3
+    0x00, 0xEE,     // 0x22A: RET
+};
+
+CLOVE_SUITE_SETUP_ONCE()
+{
+    auto* renderer = new chipotto::HeadlessRenderer();
+    auto* input_class = new MockKeyboardStateInputCommand();
+    auto* random_generator = new MockRandomGenerator();
+    dispatch_emulator = new chipotto::EmulatorImpl(renderer, input_class, random_generator);
+}
+
+CLOVE_SUITE_TEARDOWN()
+{
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Threaded);
+    dispatch_emulator->HardResetEmulator();
+}
+
+CLOVE_SUITE_TEARDOWN_ONCE()
+{
+    delete dispatch_emulator;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(ALL_MODES_MATCH)
+{
+    const chipotto::DispatchMode modes[] =
+    {
+        chipotto::DispatchMode::Table,
+        chipotto::DispatchMode::Switch,
+        chipotto::DispatchMode::Threaded,
+        chipotto::DispatchMode::Block,
+        chipotto::DispatchMode::Jit,
+        chipotto::DispatchMode::Specialized
+    };
+
+    std::array<uint8_t, 0x10> expected_registers{};
+    uint16_t expected_pc = 0;
+    uint16_t expected_i = 0;
+    uint64_t expected_count = 0;
+
+    for (size_t mode_index = 0; mode_index < std::size(modes); ++mode_index)
+    {
+        dispatch_emulator->HardResetEmulator();
+        dispatch_emulator->SetDispatchMode(modes[mode_index]);
+        LoadRom(dispatch_emulator, compute_loop_rom);
+
+        // stop on the JP that closes the loop, so block execution ends on the same instruction
+        const uint64_t start_count = dispatch_emulator->GetInstructionCount();
+        while (dispatch_emulator->GetInstructionCount() - start_count < 10000 || dispatch_emulator->GetPC() != 0x206)
+        {
+            CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(1));
+        }
+        const uint64_t executed = dispatch_emulator->GetInstructionCount() - start_count;
+
+        if (mode_index == 0)
+        {
+            expected_registers = dispatch_emulator->GetRegisters();
+            expected_pc = dispatch_emulator->GetPC();
+            expected_i = dispatch_emulator->GetI();
+            expected_count = executed;
+            continue;
+        }
+
+        CLOVE_ULLONG_EQ(expected_count, executed);
+        for (int i = 0; i < 0x10; ++i)
+        {
+            CLOVE_UINT_EQ(expected_registers[i], dispatch_emulator->GetRegisters()[i]);
+        }
+        CLOVE_UINT_EQ(expected_pc, dispatch_emulator->GetPC());
+        CLOVE_UINT_EQ(expected_i, dispatch_emulator->GetI());
+    }
+}
+
+CLOVE_TEST(RUN_STOPS_ON_KEY_WAIT)
+{
+    LoadRom(dispatch_emulator, { 0x60, 0x05, 0xF1, 0x0A, 0x70, 0x01 });
+
+    CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(100));
+
+    CLOVE_IS_TRUE(dispatch_emulator->GetIsSuspended());
+    CLOVE_UINT_EQ(0x202, dispatch_emulator->GetPC());
+    CLOVE_UINT_EQ(0x05, dispatch_emulator->GetRegisters()[0x0]);
+}
+
+CLOVE_TEST(RUN_STOPS_ON_ERROR)
+{
+    LoadRom(dispatch_emulator, { 0x60, 0x05, 0xE0, 0xFF, 0x70, 0x01 });
+
+    CLOVE_IS_FALSE(dispatch_emulator->RunInstructions(100));
+
+    CLOVE_UINT_EQ(0x202, dispatch_emulator->GetPC());
+    CLOVE_UINT_EQ(0x05, dispatch_emulator->GetRegisters()[0x0]);
+}
+
+CLOVE_TEST(DECODE_CACHE_FILLS_ON_EXECUTION)
+{
+    LoadRom(dispatch_emulator, { 0x60, 0x05, 0x81, 0x04 });
+
+    auto& decode_cache = dispatch_emulator->GetDecodeCache();
+    CLOVE_INT_EQ(static_cast<int>(chipotto::Instruction::Undecoded), static_cast<int>(decode_cache[0x100].id));
+
+    dispatch_emulator->RunInstructions(2);
+
+    CLOVE_INT_EQ(static_cast<int>(chipotto::Instruction::LD_VX_BYTE), static_cast<int>(decode_cache[0x100].id));
+    CLOVE_UINT_EQ(0x05, decode_cache[0x100].nn);
+    CLOVE_INT_EQ(static_cast<int>(chipotto::Instruction::ADD_VX_VY), static_cast<int>(decode_cache[0x101].id));
+    CLOVE_UINT_EQ(0x1, decode_cache[0x101].x);
+    CLOVE_UINT_EQ(0x0, decode_cache[0x101].y);
+}
+
+CLOVE_TEST(SELF_MODIFYING_CODE)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x6A, 0x00,     // 0x200: LD VA, 0x00
+        0x12, 0x08,     // 0x202: JP 0x208
+        0x7A, 0x01,     // 0x204: ADD VA, 0x01  <- patched to ADD VA, 0x10
+        0x00, 0xEE,     // 0x206: RET
+        0x22, 0x04,     // 0x208: CALL 0x204
+        0x60, 0x7A,     // 0x20A: LD V0, 0x7A
+        0x61, 0x10,     // 0x20C: LD V1, 0x10
+        0xA2, 0x04,     // 0x20E: LD I, 0x204
+        0xF1, 0x55,     // 0x210: LD [I], V1
+        0x22, 0x04,     // 0x212: CALL 0x204
+        0x12, 0x14,     // 0x214: JP 0x214
+    };
+
+    const chipotto::DispatchMode modes[] =
+    {
+        chipotto::DispatchMode::Switch,
+        chipotto::DispatchMode::Threaded,
+        chipotto::DispatchMode::Block,
+        chipotto::DispatchMode::Jit,
+        chipotto::DispatchMode::Specialized
+    };
+    for (const auto mode : modes)
+    {
+        dispatch_emulator->HardResetEmulator();
+        dispatch_emulator->SetDispatchMode(mode);
+        LoadRom(dispatch_emulator, rom);
+
+        CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(50));
+
+        CLOVE_UINT_EQ(0x11, dispatch_emulator->GetRegisters()[0xA]);
+    }
+}
+
+CLOVE_TEST(BLOCK_TICK_RUNS_WHOLE_BLOCK)
+{
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Block);
+    LoadRom(dispatch_emulator, compute_loop_rom);
+
+    // LD VA, LD VB, LD I, ADD VA, ADD VA VB, LD VC, SHR, SUB, XOR and SE VD end the first block
+    CLOVE_IS_TRUE(dispatch_emulator->Tick(0.0f));
+
+    CLOVE_UINT_EQ(10, dispatch_emulator->GetBlockCache()[0x100].length);
+    // VD is still zero, so SE skips the OR
+    CLOVE_UINT_EQ(0x216, dispatch_emulator->GetPC());
+
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Threaded);
+}
+
+CLOVE_TEST(BLOCK_INVALIDATED_BY_LOAD)
+{
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Block);
+    LoadRom(dispatch_emulator, { 0x60, 0x01, 0x70, 0x01, 0x12, 0x00 });
+
+    dispatch_emulator->Tick(0.0f);
+    CLOVE_UINT_EQ(3, dispatch_emulator->GetBlockCache()[0x100].length);
+    CLOVE_UINT_EQ(0x02, dispatch_emulator->GetRegisters()[0x0]);
+
+    LoadRom(dispatch_emulator, { 0x60, 0x01, 0x12, 0x00 });
+    CLOVE_UINT_EQ(0, dispatch_emulator->GetBlockCache()[0x100].length);
+
+    dispatch_emulator->Tick(0.0f);
+    CLOVE_UINT_EQ(2, dispatch_emulator->GetBlockCache()[0x100].length);
+    CLOVE_UINT_EQ(0x01, dispatch_emulator->GetRegisters()[0x0]);
+
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Threaded);
+}
+
+// every fusible idiom, with both outcomes of the fused skips
+static const std::vector<uint8_t> fusion_rom =
+{
+    0x63, 0x02,     // 0x200: LD V3, 0x02
+    0xF3, 0x1E,     // 0x202: ADD I, V3         <- fused with the load
+    0xA3, 0x00,     // 0x204: LD I, 0x300
+    0xD0, 0x15,     // 0x206: DRW V0, V1, 5     <- fused with LD I
+    0xF5, 0x15,     // 0x208: LD DT, V5
+    0xF4, 0x07,     // 0x20A: LD V4, DT
+    0x34, 0x00,     // 0x20C: SE V4, 0x00
+    0x12, 0x1E,     // 0x20E: JP 0x21E          <- clears DT and polls again
+    0x75, 0x01,     // 0x210: ADD V5, 0x01
+    0x45, 0x03,     // 0x212: SNE V5, 0x03
+    0x12, 0x00,     // 0x214: JP 0x200
+    0x35, 0x06,     // 0x216: SE V5, 0x06
+    0x12, 0x00,     // 0x218: JP 0x200
+    0x65, 0x00,     // 0x21A: LD V5, 0x00
+    0x12, 0x00,     // 0x21C: JP 0x200
+    0xF6, 0x15,     // 0x21E: LD DT, V6
+    0x12, 0x0A,     // 0x220: JP 0x20A
+};
+
+CLOVE_TEST(FUSION_MATCHES_SEPARATE_INSTRUCTIONS)
+{
+    const chipotto::DispatchMode modes[] =
+    {
+        chipotto::DispatchMode::Table,
+        chipotto::DispatchMode::Switch,
+        chipotto::DispatchMode::Threaded
+    };
+
+    std::array<uint8_t, 0x10> expected_registers{};
+    uint16_t expected_i = 0;
+    uint64_t expected_count = 0;
+
+    for (size_t mode_index = 0; mode_index < std::size(modes); ++mode_index)
+    {
+        dispatch_emulator->HardResetEmulator();
+        dispatch_emulator->SetDispatchMode(modes[mode_index]);
+        LoadRom(dispatch_emulator, fusion_rom);
+
+        // the delay timer never ticks here, a non zero poll clears it through V6 instead
+        const uint64_t start_count = dispatch_emulator->GetInstructionCount();
+        while (dispatch_emulator->GetInstructionCount() - start_count < 2000 || dispatch_emulator->GetPC() != 0x200)
+        {
+            CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(1));
+        }
+        const uint64_t executed = dispatch_emulator->GetInstructionCount() - start_count;
+
+        if (mode_index == 0)
+        {
+            expected_registers = dispatch_emulator->GetRegisters();
+            expected_i = dispatch_emulator->GetI();
+            expected_count = executed;
+            continue;
+        }
+
+        CLOVE_ULLONG_EQ(expected_count, executed);
+        for (int i = 0; i < 0x10; ++i)
+        {
+            CLOVE_UINT_EQ(expected_registers[i], dispatch_emulator->GetRegisters()[i]);
+        }
+        CLOVE_UINT_EQ(expected_i, dispatch_emulator->GetI());
+    }
+}
+
+CLOVE_TEST(FUSION_HITS_PER_ROM)
+{
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Switch);
+    LoadRom(dispatch_emulator, fusion_rom);
+
+    // one pass through the rom, V5 goes from 0 to 1 so SNE skips the jump back
+    while (dispatch_emulator->GetPC() != 0x216)
+    {
+        CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(1));
+    }
+
+    CLOVE_ULLONG_EQ(1, dispatch_emulator->GetFusionHits(chipotto::Instruction::LD_VX_BYTE_ADD_I_VY));
+    CLOVE_ULLONG_EQ(1, dispatch_emulator->GetFusionHits(chipotto::Instruction::LD_I_ADDR_DRW));
+    CLOVE_ULLONG_EQ(1, dispatch_emulator->GetFusionHits(chipotto::Instruction::LD_VX_DT_SE_JP));
+    CLOVE_ULLONG_EQ(1, dispatch_emulator->GetFusionHits(chipotto::Instruction::SNE_VX_BYTE_JP));
+    CLOVE_ULLONG_EQ(0, dispatch_emulator->GetFusionHits(chipotto::Instruction::SE_VX_BYTE_JP));
+    // LD V3, ADD I, LD I, DRW, LD DT, LD V4 DT, SE, ADD V5, SNE
+    CLOVE_UINT_EQ(0x216, dispatch_emulator->GetPC());
+
+    LoadRom(dispatch_emulator, fusion_rom);
+    CLOVE_ULLONG_EQ(0, dispatch_emulator->GetFusionHits(chipotto::Instruction::LD_I_ADDR_DRW));
+}
+
+CLOVE_TEST(FUSION_DISABLED)
+{
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Switch);
+    dispatch_emulator->SetFusionEnabled(false);
+    LoadRom(dispatch_emulator, fusion_rom);
+
+    CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(100));
+
+    CLOVE_ULLONG_EQ(0, dispatch_emulator->GetFusionHits(chipotto::Instruction::LD_I_ADDR_DRW));
+    CLOVE_INT_EQ(static_cast<int>(chipotto::Instruction::LD_I_ADDR), static_cast<int>(dispatch_emulator->GetDecodeCache()[0x102].id));
+
+    dispatch_emulator->SetFusionEnabled(true);
+}
+
+CLOVE_TEST(FUSION_UNDONE_BY_WRITE)
+{
+    dispatch_emulator->SetDispatchMode(chipotto::DispatchMode::Switch);
+    LoadRom(dispatch_emulator, { 0xA3, 0x00, 0xD0, 0x15, 0x12, 0x00 });
+
+    CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(1));
+    CLOVE_INT_EQ(static_cast<int>(chipotto::Instruction::LD_I_ADDR_DRW), static_cast<int>(dispatch_emulator->GetDecodeCache()[0x100].id));
+
+    // overwriting only the DRW still drops the superinstruction cached one entry earlier
+    chipotto::Gamefile patch(2);
+    patch.bytecode[0] = 0x60;
+    patch.bytecode[1] = 0x07;
+    dispatch_emulator->SetPC(0x202);
+    dispatch_emulator->Load(&patch);
+    dispatch_emulator->SetPC(0x200);
+
+    CLOVE_INT_EQ(static_cast<int>(chipotto::Instruction::Undecoded), static_cast<int>(dispatch_emulator->GetDecodeCache()[0x100].id));
+    CLOVE_IS_TRUE(dispatch_emulator->RunInstructions(2));
+    CLOVE_UINT_EQ(0x07, dispatch_emulator->GetRegisters()[0x0]);
+}
+
+#pragma endregion //TESTS
@@ -1,7 +1,11 @@
 #include "clove-unit.h"
 
+#include <chrono>
+#include <thread>
+
 #include "emulator_impl.h"
 #include "sdl/sdl_emu_renderer.h"
+#include "sdl/sdl_render_thread.h"
 #include "sdl/sdl_input.h"
 #include "sdl/emulator_random_generator.h"
 #include "mocks.h"
@@ -45,6 +49,7 @@ CLOVE_TEST(CLS)
     }
     memset(pixels, 0xFF, pitch * height);    // texture is not clean
     SDL_UnlockTexture(texture);
+    renderer->Invalidate();
 
     uint8_t* pixels_zeros = new uint8_t[pitch * height];
     memset(pixels_zeros, 0, pitch * height);
@@ -794,6 +799,136 @@ CLOVE_TEST(DRW_VX_VY_NIBBLE_NO_WRAP_VERTICAL)
     CLOVE_INT_EQ(0, comp_res_row_down_1);
 }
 
+CLOVE_TEST(DRW_WITHOUT_PRESENT)
+{
+    // a frame goes into the texture at once and waits there for the frontend to present it
+    emulator->SetI(0x00);   // "0" location
+    auto& registers = emulator->GetRegisters();
+    registers[0x1] = 0x0;
+
+    emulator->OpcodeD(0xD115);
+
+    auto texture = renderer->GetTexture();
+    int pitch;
+    uint8_t* pixels;
+    if(SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&pixels), &pitch) != 0)
+    {
+        CLOVE_FAIL();
+    }
+    const uint8_t top_left = pixels[0];
+    const uint8_t inside = pixels[pitch + 4];
+    SDL_UnlockTexture(texture);
+
+    CLOVE_UINT_EQ(0xFF, top_left);
+    CLOVE_UINT_EQ(0x00, inside);
+}
+
+CLOVE_TEST(PRESENTS_ONCE_PER_FRAME)
+{
+    // shows whatever the reset left pending
+    renderer->Present();
+    const chipotto::SDLRendererStats before = renderer->GetStats();
+    emulator->SetI(0x00);   // "0" location
+    auto& registers = emulator->GetRegisters();
+    registers[0x1] = 0x0;
+    registers[0x2] = 0x8;
+
+    // three draws of 5 rows each, then the frame ends
+    emulator->OpcodeD(0xD115);
+    emulator->OpcodeD(0xD125);
+    emulator->OpcodeD(0xD215);
+    CLOVE_IS_TRUE(renderer->Present());
+    CLOVE_IS_FALSE(renderer->Present());
+
+    const chipotto::SDLRendererStats& after = renderer->GetStats();
+    CLOVE_ULLONG_EQ(3, after.frames - before.frames);
+    CLOVE_ULLONG_EQ(1, after.presents - before.presents);
+    CLOVE_ULLONG_EQ(2, after.presents_saved - before.presents_saved);
+    CLOVE_ULLONG_EQ(3 * 5 * 64 * 4, after.bytes_uploaded - before.bytes_uploaded);
+    CLOVE_ULLONG_EQ(3 * (32 - 5) * 64 * 4, after.bytes_saved - before.bytes_saved);
+}
+
+CLOVE_TEST(RENDER_THREAD_PRESENTS_PUBLISHED_FRAMES)
+{
+    chipotto::SDLRenderThread render_thread(64, 32);
+    CLOVE_IS_TRUE(render_thread.IsValid());
+
+    // frames only leave on PublishFrame, and an unchanged screen is not published again
+    chipotto::Framebuffer rows{};
+    for (uint64_t frame = 1; frame <= 100; ++frame)
+    {
+        rows[frame % 32] ^= frame;
+        render_thread.DrawFrame(rows);
+        render_thread.PublishFrame();
+        render_thread.PublishFrame();
+    }
+
+    // every published frame is either presented or replaced by a newer one before the render thread got to it
+    const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    chipotto::SDLRenderThreadStats stats = render_thread.GetStats();
+    while (stats.presented + stats.dropped < stats.published && std::chrono::steady_clock::now() < give_up)
+    {
+        std::this_thread::yield();
+        stats = render_thread.GetStats();
+    }
+    CLOVE_ULLONG_EQ(100, stats.published);
+    CLOVE_ULLONG_EQ(100, stats.presented + stats.dropped);
+    CLOVE_IS_TRUE(stats.presented > 0);
+}
+
+CLOVE_TEST(DRW_INTO_FRAMEBUFFER)
+{
+    // "0" across the right edge and the bottom, wrapped, then again on top of itself to erase it
+    emulator->SetDoWrap(true);
+    emulator->SetI(0x00);
+    auto& registers = emulator->GetRegisters();
+    registers[0x1] = 62;
+    registers[0x2] = 30;
+
+    emulator->OpcodeD(0xD125);
+    const chipotto::Framebuffer& rows = emulator->GetFramebuffer();
+    CLOVE_ULLONG_EQ(0xC000000000000003ull, rows[30]);
+    CLOVE_ULLONG_EQ(0x4000000000000002ull, rows[31]);
+    CLOVE_ULLONG_EQ(0x4000000000000002ull, rows[0]);
+    CLOVE_ULLONG_EQ(0x4000000000000002ull, rows[1]);
+    CLOVE_ULLONG_EQ(0xC000000000000003ull, rows[2]);
+    CLOVE_ULLONG_EQ(0, rows[3]);
+    CLOVE_UINT_EQ(0, registers[0xF]);
+
+    // the SDL texture shows the same frame
+    auto texture = renderer->GetTexture();
+    int pitch;
+    uint8_t* pixels;
+    if(SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&pixels), &pitch) != 0)
+    {
+        CLOVE_FAIL();
+    }
+    const uint8_t wrapped = pixels[pitch * 30];
+    const uint8_t unlit = pixels[pitch * 30 + 8];
+    SDL_UnlockTexture(texture);
+    CLOVE_UINT_EQ(0xFF, wrapped);
+    CLOVE_UINT_EQ(0x00, unlit);
+
+    emulator->OpcodeD(0xD125);
+    emulator->SetDoWrap(false);
+    CLOVE_ULLONG_EQ(0, rows[30]);
+    CLOVE_ULLONG_EQ(0, rows[0]);
+}
+
+CLOVE_TEST(RUNS_WITHOUT_RENDERER)
+{
+    // headless: the core keeps drawing into its own framebuffer
+    chipotto::EmulatorImpl headless(nullptr, new MockKeyboardStateInputCommand(), new MockRandomGenerator());
+    headless.SetI(0x05);   // "1" location
+    headless.GetRegisters()[0x1] = 0x8;
+    headless.OpcodeD(0xD115);
+    CLOVE_ULLONG_EQ(0x20ull << 48, headless.GetFramebuffer()[8]);
+    CLOVE_ULLONG_EQ(0x70ull << 48, headless.GetFramebuffer()[12]);
+
+    headless.Opcode0(0x00E0);
+    CLOVE_ULLONG_EQ(0, headless.GetFramebuffer()[8]);
+}
+
 CLOVE_TEST(SKP_VX_PRESSED)
 {
     auto& registers = emulator->GetRegisters();
@@ -905,7 +1040,7 @@ CLOVE_TEST(LD_VX_K)
     event.type = SDL_KEYDOWN;
     event.key.keysym.sym = SDLK_4;
     SDL_PushEvent(&event);
-    emulator->Tick(SIXTYHERTZ_S);
+    emulator->Tick(0.0f);
 
     CLOVE_INT_EQ(0xC, registers[0x4]);
 }
@@ -1051,5 +1186,28 @@ CLOVE_TEST(LD_VX_I)
     CLOVE_UINT_EQ(I, emulator->GetI());
 }
 
+CLOVE_TEST(MACHINE_STATE_SNAPSHOT)
+{
+    // the hot state starts the object, so all of it shares one cache line
+    CLOVE_INT_EQ(0, static_cast<int>(reinterpret_cast<uintptr_t>(&emulator->GetMachineState()) % 64));
+
+    emulator->GetRegisters()[0x3] = 0x33;
+    emulator->SetI(0x321);
+    emulator->SetPC(0x246);
+    emulator->OpcodeF(0xF315);    // LD DT, V3
+    const chipotto::MachineState snapshot = emulator->GetMachineState();
+
+    emulator->GetRegisters()[0x3] = 0x00;
+    emulator->SetI(0x000);
+    emulator->SetPC(0x200);
+    emulator->OpcodeF(0xF315);
+    emulator->SetMachineState(snapshot);
+
+    CLOVE_UINT_EQ(0x33, emulator->GetRegisters()[0x3]);
+    CLOVE_UINT_EQ(0x321, emulator->GetI());
+    CLOVE_UINT_EQ(0x246, emulator->GetPC());
+    CLOVE_UINT_EQ(0x33, emulator->GetDelayTimer());
+}
+
 
 #pragma endregion //TESTS
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "clove-unit.h"
+
+#include <vector>
+
+#include "runner/rgba_expander.h"
+
+#define CLOVE_SUITE_NAME TestRgbaExpander
+
+// a frame with every kind of row: empty, full, single pixels at both edges and noise
+static chipotto::Framebuffer MakeExpanderFrame()
+{
+    chipotto::Framebuffer rows{};
+    rows[1] = ~0ull;
+    rows[2] = 1ull << 63;
+    rows[3] = 1;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t row = 4; row < rows.size(); ++row)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        rows[row] = state;
+    }
+    return rows;
+}
+
+// the pixel the image should hold at x, y of a frame scaled by scale
+static uint32_t ExpectedPixel(const chipotto::Framebuffer& rows, const uint32_t scale, const uint32_t x, const uint32_t y, const uint32_t on, const uint32_t off)
+{
+    return (rows[y / scale] >> (63 - x / scale)) & 1 ? on : off;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(PACK_RGBA_BYTE_ORDER)
+{
+    const uint32_t pixel = chipotto::PackRgba(0x11, 0x22, 0x33, 0x44);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&pixel);
+    CLOVE_UINT_EQ(0x11, bytes[0]);
+    CLOVE_UINT_EQ(0x22, bytes[1]);
+    CLOVE_UINT_EQ(0x33, bytes[2]);
+    CLOVE_UINT_EQ(0x44, bytes[3]);
+}
+
+CLOVE_TEST(EXPANDS_EVERY_SCALE)
+{
+    const chipotto::Framebuffer rows = MakeExpanderFrame();
+    const uint32_t on = chipotto::PackRgba(0x33, 0xFF, 0x66, 0xFF);
+    const uint32_t off = chipotto::PackRgba(0x10, 0x20, 0x30, 0xFF);
+    for (const uint32_t scale : { 1u, 2u, 3u, 5u, 7u, 10u, 16u })
+    {
+        chipotto::RgbaExpander expander(on, off, scale);
+        CLOVE_UINT_EQ(64 * scale, expander.GetWidth());
+        CLOVE_UINT_EQ(32 * scale, expander.GetHeight());
+
+        std::vector<uint32_t> pixels(size_t(expander.GetWidth()) * expander.GetHeight(), 0);
+        expander.Expand(rows, pixels.data(), size_t(expander.GetWidth()) * 4);
+        size_t mismatches = 0;
+        for (uint32_t y = 0; y < expander.GetHeight(); ++y)
+        {
+            for (uint32_t x = 0; x < expander.GetWidth(); ++x)
+            {
+                mismatches += pixels[size_t(y) * expander.GetWidth() + x] != ExpectedPixel(rows, scale, x, y, on, off);
+            }
+        }
+        CLOVE_ULLONG_EQ(0, mismatches);
+    }
+}
+
+CLOVE_TEST(EXPANDS_ROWS_WITHIN_THE_PITCH)
+{
+    const chipotto::Framebuffer rows = MakeExpanderFrame();
+    chipotto::RgbaExpander expander(0xFFFFFFFFu, 0, 3);
+    // lines wider than the image, rows 4 to 9 only, the rest has to stay untouched
+    const size_t line_pixels = expander.GetWidth() + 5;
+    const uint32_t canary = 0xDEADBEEFu;
+    std::vector<uint32_t> pixels(line_pixels * expander.GetHeight(), canary);
+    expander.ExpandRows(rows, 4, 6, pixels.data() + line_pixels * 4 * 3, line_pixels * 4);
+
+    size_t mismatches = 0;
+    for (uint32_t y = 0; y < expander.GetHeight(); ++y)
+    {
+        for (uint32_t x = 0; x < line_pixels; ++x)
+        {
+            const bool written = y >= 4 * 3 && y < 10 * 3 && x < expander.GetWidth();
+            const uint32_t expected = written ? ExpectedPixel(rows, 3, x, y, 0xFFFFFFFFu, 0) : canary;
+            mismatches += pixels[y * line_pixels + x] != expected;
+        }
+    }
+    CLOVE_ULLONG_EQ(0, mismatches);
+
+    // rows past the end of the frame are ignored
+    expander.ExpandRows(rows, 30, 10, pixels.data() + line_pixels * 30 * 3, line_pixels * 4);
+    CLOVE_UINT_EQ(canary, pixels[line_pixels * expander.GetHeight() - 1]);
+}
+
+CLOVE_TEST(SCALE_IS_CLAMPED)
+{
+    chipotto::RgbaExpander expander;
+    CLOVE_UINT_EQ(1, expander.GetScale());
+    expander.SetScale(0);
+    CLOVE_UINT_EQ(1, expander.GetScale());
+    expander.SetScale(100);
+    CLOVE_UINT_EQ(chipotto::RgbaExpander::MaxScale, expander.GetScale());
+}
+
+#pragma endregion //TESTS
@@ -0,0 +1,171 @@
+#include "clove-unit.h"
+
+#include <memory>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "runner/fleet.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestFleet
+
+// draws the font digit of the key it waits for, then a random byte of sprite, every frame
+static const std::vector<uint8_t> fleet_rom =
+{
+    0xF3, 0x0A,     // 0x200: LD V3, K
+    0xF3, 0x29,     // 0x202: LD F, V3
+    0xD0, 0x05,     // 0x204: DRW V0, V0, 5
+    0xC4, 0xFF,     // 0x206: RND V4, 0xFF
+    0xA3, 0x00,     // 0x208: LD I, 0x300
+    0xF4, 0x55,     // 0x20A: LD [I], V4
+    0x61, 0x10,     // 0x20C: LD V1, 0x10
+    0xD1, 0x11,     // 0x20E: DRW V1, V1, 1
+    0x62, 0x01,     // 0x210: LD V2, 0x01
+    0xF2, 0x15,     // 0x212: LD DT, V2
+    0xF2, 0x07,     // 0x214: LD V2, DT
+    0x32, 0x00,     // 0x216: SE V2, 0x00
+    0x12, 0x14,     // 0x218: JP 0x214
+    0x12, 0x06,     // 0x21A: JP 0x206
+};
+
+#pragma region TESTS
+
+CLOVE_TEST(SCRIPT_MATCHES_A_SINGLE_RUN)
+{
+    // the ROM without its random part, so a plain emulator can replay the job
+    std::vector<uint8_t> rom(fleet_rom.begin(), fleet_rom.begin() + 6);
+    rom.insert(rom.end(), { 0x12, 0x06 });     // 0x206: JP 0x206
+    auto gamefile = MakeGamefile(rom);
+
+    chipotto::FleetJob job;
+    job.Game = gamefile.get();
+    job.Frames = 30;
+    job.Script = { { 10, chipotto::EmuKey::K_7, true }, { 12, chipotto::EmuKey::K_7, false } };
+    chipotto::FleetJob no_keys = job;
+    no_keys.Script.clear();
+
+    chipotto::Chip8Fleet fleet({ 2 });
+    const std::vector<chipotto::FleetResult> results = fleet.Run({ job, no_keys });
+    CLOVE_ULLONG_EQ(2, results.size());
+
+    auto* screen = new chipotto::HeadlessRenderer();
+    auto* keys = new chipotto::RunnerInput();
+    chipotto::EmulatorImpl reference(screen, keys, new MockRandomGenerator());
+    reference.Load(gamefile.get());
+    for (uint32_t frame = 0; frame < 30; ++frame)
+    {
+        if (frame == 10 || frame == 12)
+        {
+            keys->SetKey(chipotto::EmuKey::K_7, frame == 10);
+        }
+        reference.RunFrame();
+    }
+
+    // the sprite of 7 ends up at the top left, drawn on frame 10
+    CLOVE_ULLONG_EQ(0xF0ull << 56, screen->GetFrame()[0]);
+    CLOVE_ULLONG_EQ(reference.GetCycles(), results[0].Cycles);
+    CLOVE_UINT_EQ(30, results[0].FramesRun);
+    CLOVE_INT_EQ(static_cast<int>(chipotto::RunStatus::FrameDone), static_cast<int>(results[0].Status));
+
+    CLOVE_INT_EQ(static_cast<int>(chipotto::RunStatus::WaitingForKey), static_cast<int>(results[1].Status));
+    CLOVE_IS_TRUE(results[0].FramebufferHash != results[1].FramebufferHash);
+    CLOVE_ULLONG_EQ(30 * 10, results[1].Cycles);
+}
+
+CLOVE_TEST(RESULTS_DO_NOT_DEPEND_ON_THE_WORKERS)
+{
+    auto gamefile = MakeGamefile(fleet_rom);
+    std::vector<chipotto::FleetJob> jobs;
+    for (uint32_t i = 0; i < 40; ++i)
+    {
+        chipotto::FleetJob job;
+        job.Game = gamefile.get();
+        job.Frames = 20 + (i % 7) * 10;
+        job.InstructionsPerFrame = 10 + i;
+        job.Seed = i % 5;
+        job.Script = { { i % 4, static_cast<chipotto::EmuKey>(i % 16), true } };
+        jobs.push_back(job);
+    }
+
+    chipotto::Chip8Fleet single({ 1 });
+    chipotto::Chip8Fleet several({ 3, true });
+    CLOVE_UINT_EQ(3, several.GetWorkerCount());
+    const std::vector<chipotto::FleetResult> expected = single.Run(jobs);
+    // twice, so the reused instances and the second batch are covered too
+    for (int run = 0; run < 2; ++run)
+    {
+        const std::vector<chipotto::FleetResult> results = several.Run(jobs);
+        CLOVE_ULLONG_EQ(jobs.size(), results.size());
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            CLOVE_ULLONG_EQ(expected[i].FramebufferHash, results[i].FramebufferHash);
+            CLOVE_ULLONG_EQ(expected[i].Cycles, results[i].Cycles);
+            CLOVE_UINT_EQ(jobs[i].Frames, results[i].FramesRun);
+            CLOVE_IS_TRUE(results[i].Worker < 3);
+        }
+    }
+
+    // jobs that differ only by their seed draw different random sprites
+    CLOVE_IS_TRUE(expected[0].FramebufferHash != expected[20].FramebufferHash || expected[1].FramebufferHash != expected[21].FramebufferHash);
+    CLOVE_ULLONG_EQ(0, single.Run({}).size());
+}
+
+CLOVE_TEST(IDLE_WORKERS_STEAL)
+{
+    // worker 0 gets every long job, worker 1 only short ones and runs out first
+    const std::vector<uint8_t> rom =
+    {
+        0x71, 0x01,     // 0x200: ADD V1, 0x01
+        0x82, 0x14,     // 0x202: ADD V2, V1
+        0x12, 0x00,     // 0x204: JP 0x200
+    };
+    auto gamefile = MakeGamefile(rom);
+    std::vector<chipotto::FleetJob> jobs;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        chipotto::FleetJob job;
+        job.Game = gamefile.get();
+        job.Frames = i % 2 == 0 ? 200 : 1;
+        job.InstructionsPerFrame = 5000;
+        jobs.push_back(job);
+    }
+
+    chipotto::Chip8Fleet fleet({ 2 });
+    const std::vector<chipotto::FleetResult> results = fleet.Run(jobs);
+    bool long_job_stolen = false;
+    for (size_t i = 0; i < jobs.size(); i += 2)
+    {
+        long_job_stolen = long_job_stolen || results[i].Worker == 1;
+        CLOVE_ULLONG_EQ(200 * 5000, results[i].Cycles);
+    }
+    CLOVE_IS_TRUE(long_job_stolen);
+    CLOVE_IS_TRUE(fleet.GetStolenJobs() > 0);
+}
+
+CLOVE_TEST(BACK_TO_BACK_BATCHES)
+{
+    // tiny batches, so workers are still waking for one batch when the next is filled
+    auto gamefile = MakeGamefile(fleet_rom);
+    chipotto::FleetJob job;
+    job.Game = gamefile.get();
+    job.Frames = 1;
+    job.Script = { { 0, chipotto::EmuKey::K_1, true } };
+
+    chipotto::Chip8Fleet fleet({ 4 });
+    const std::vector<chipotto::FleetResult> expected = fleet.Run({ job });
+    for (uint32_t batch = 0; batch < 2000; ++batch)
+    {
+        const std::vector<chipotto::FleetJob> jobs(1 + batch % 3, job);
+        const std::vector<chipotto::FleetResult> results = fleet.Run(jobs);
+        CLOVE_ULLONG_EQ(jobs.size(), results.size());
+        for (const chipotto::FleetResult& result : results)
+        {
+            CLOVE_UINT_EQ(1, result.FramesRun);
+            CLOVE_ULLONG_EQ(expected[0].FramebufferHash, result.FramebufferHash);
+        }
+    }
+}
+
+#pragma endregion //TESTS
@@ -0,0 +1,45 @@
+#include "clove-unit.h"
+
+#include <chrono>
+
+#include "sdl/frame_pacer.h"
+
+#define CLOVE_SUITE_NAME TestFramePacer
+
+#pragma region TESTS
+
+CLOVE_TEST(KEEPS_THE_FRAME_RATE)
+{
+    chipotto::FramePacer pacer(200.0);
+    const auto start = chipotto::FramePacer::Clock::now();
+    pacer.Restart();
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        pacer.WaitForNextFrame();
+    }
+    const auto elapsed = chipotto::FramePacer::Clock::now() - start;
+
+    // never early, the upper bound is left to the scheduler of the machine running the tests
+    CLOVE_IS_TRUE(elapsed >= std::chrono::milliseconds(50));
+    CLOVE_ULLONG_EQ(10, pacer.GetStats().frames);
+    CLOVE_IS_TRUE(pacer.GetStats().max_jitter_us >= pacer.GetStats().mean_jitter_us);
+}
+
+CLOVE_TEST(LATE_FRAME_MOVES_THE_DEADLINE)
+{
+    chipotto::FramePacer pacer(1000.0);
+    pacer.Restart();
+    const auto stall_end = chipotto::FramePacer::Clock::now() + std::chrono::milliseconds(20);
+    while (chipotto::FramePacer::Clock::now() < stall_end)
+    {
+    }
+    pacer.WaitForNextFrame();
+    CLOVE_ULLONG_EQ(1, pacer.GetStats().late_frames);
+
+    // the next deadline is a period after the stall, not a run of frames already due
+    const auto start = chipotto::FramePacer::Clock::now();
+    pacer.WaitForNextFrame();
+    CLOVE_IS_TRUE(chipotto::FramePacer::Clock::now() - start >= std::chrono::microseconds(500));
+}
+
+#pragma endregion //TESTS
@@ -0,0 +1,308 @@
+#include "clove-unit.h"
+
+#include <vector>
+
+#include "emulator_impl.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestFrames
+
+static chipotto::EmulatorImpl* frames_emulator = nullptr;
+static MockEventInputCommand* frames_input = nullptr;
+
+// field by field, the padding of MachineState is not copied by an assignment and may differ
+static bool SameMachineState(const chipotto::MachineState& a, const chipotto::MachineState& b)
+{
+    return a.Registers == b.Registers && a.I == b.I && a.PC == b.PC && a.SP == b.SP && a.DelayTimer == b.DelayTimer &&
+        a.SoundTimer == b.SoundTimer && a.Suspended == b.Suspended && a.WaitForKeyboardRegister_Index == b.WaitForKeyboardRegister_Index &&
+        a.CyclesSinceTimerStep == b.CyclesSinceTimerStep && a.OverrunCycles == b.OverrunCycles && a.Cycles == b.Cycles;
+}
+
+CLOVE_SUITE_SETUP_ONCE()
+{
+    frames_input = new MockEventInputCommand();
+    frames_emulator = new chipotto::EmulatorImpl(new chipotto::HeadlessRenderer(), frames_input, new MockRandomGenerator());
+}
+
+CLOVE_SUITE_SETUP()
+{
+    frames_emulator->SetDispatchMode(chipotto::DispatchMode::Switch);
+}
+
+CLOVE_SUITE_TEARDOWN()
+{
+    frames_input->Events.clear();
+    frames_emulator->SetInstructionsPerFrame(10);
+    frames_emulator->SetIdleSkipEnabled(true);
+    frames_emulator->SetFusionEnabled(true);
+    frames_emulator->SetDispatchMode(chipotto::DispatchMode::Threaded);
+    frames_emulator->HardResetEmulator();
+}
+
+CLOVE_SUITE_TEARDOWN_ONCE()
+{
+    delete frames_emulator;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(RUN_FRAME_BUDGET)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x05,     // 0x200: LD V0, 0x05
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0xF0, 0x18,     // 0x204: LD ST, V0
+        0x71, 0x01,     // 0x206: ADD V1, 0x01
+        0x12, 0x06,     // 0x208: JP 0x206
+    };
+    LoadRom(frames_emulator, rom);
+    frames_emulator->SetInstructionsPerFrame(13);
+
+    const uint64_t start_count = frames_emulator->GetInstructionCount();
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(13, frames_emulator->GetInstructionCount() - start_count);
+    // 3 setup instructions, then 5 loops of ADD and JP
+    CLOVE_UINT_EQ(5, frames_emulator->GetRegisters()[0x1]);
+    CLOVE_UINT_EQ(4, frames_emulator->GetDelayTimer());
+    CLOVE_UINT_EQ(4, frames_emulator->GetSoundTimer());
+
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(3, frames_emulator->GetDelayTimer());
+}
+
+CLOVE_TEST(TIMERS_STEP_EVERY_FRAME_OF_CYCLES)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x05,     // 0x200: LD V0, 0x05
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0x12, 0x04,     // 0x204: JP 0x204
+    };
+    LoadRom(frames_emulator, rom);
+
+    // steps at cycles 10 and 20, however the budget is split
+    CLOVE_IS_TRUE(frames_emulator->RunCycles(9) == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(5, frames_emulator->GetDelayTimer());
+    CLOVE_IS_TRUE(frames_emulator->RunCycles(1) == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(4, frames_emulator->GetDelayTimer());
+    for (int i = 0; i < 5; ++i)
+    {
+        CLOVE_IS_TRUE(frames_emulator->Tick(0.0f));
+    }
+    CLOVE_IS_TRUE(frames_emulator->RunCycles(14) == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(3, frames_emulator->GetDelayTimer());
+    CLOVE_UINT_EQ(29, frames_emulator->GetCycles());
+
+    frames_emulator->SetInstructionsPerFrame(1);
+    CLOVE_IS_TRUE(frames_emulator->RunCycles(2) == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(1, frames_emulator->GetDelayTimer());
+}
+
+CLOVE_TEST(RUNS_ARE_DETERMINISTIC)
+{
+    // counts frames with the delay timer, so the result depends on where every timer step lands
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x03,     // 0x200: LD V0, 0x03
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0xF1, 0x07,     // 0x204: LD V1, DT
+        0x72, 0x01,     // 0x206: ADD V2, 0x01
+        0x31, 0x00,     // 0x208: SE V1, 0x00
+        0x12, 0x04,     // 0x20A: JP 0x204
+        0x73, 0x01,     // 0x20C: ADD V3, 0x01
+        0xC4, 0x0F,     // 0x20E: RND V4, 0x0F
+        0x12, 0x00,     // 0x210: JP 0x200
+    };
+    const uint32_t budgets[] = { 7, 1, 13, 64, 3 };
+
+    chipotto::MachineState first_run;
+    for (int run = 0; run < 2; ++run)
+    {
+        frames_emulator->HardResetEmulator();
+        frames_emulator->SetInstructionsPerFrame(11);
+        LoadRom(frames_emulator, rom);
+        for (int i = 0; i < 200; ++i)
+        {
+            CLOVE_IS_TRUE(frames_emulator->RunCycles(budgets[i % 5]) == chipotto::RunStatus::FrameDone);
+        }
+
+        if (run == 0)
+        {
+            first_run = frames_emulator->GetMachineState();
+            continue;
+        }
+        CLOVE_IS_TRUE(SameMachineState(first_run, frames_emulator->GetMachineState()));
+    }
+    // the fused skip and jump may finish a budget one instruction late, the same way on every run
+    CLOVE_IS_TRUE(frames_emulator->GetCycles() >= (7 + 1 + 13 + 64 + 3) * 40);
+    CLOVE_IS_TRUE(frames_emulator->GetRegisters()[0x3] > 0);
+}
+
+CLOVE_TEST(RUN_FRAME_WAITS_FOR_KEY)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x02,     // 0x200: LD V0, 0x02
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0xF3, 0x0A,     // 0x204: LD V3, K
+        0x74, 0x01,     // 0x206: ADD V4, 0x01
+        0x12, 0x06,     // 0x208: JP 0x206
+    };
+    LoadRom(frames_emulator, rom);
+
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::WaitingForKey);
+    CLOVE_UINT_EQ(0x204, frames_emulator->GetPC());
+    // the delay timer keeps running while the machine waits
+    CLOVE_UINT_EQ(1, frames_emulator->GetDelayTimer());
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::WaitingForKey);
+    CLOVE_UINT_EQ(0, frames_emulator->GetDelayTimer());
+
+    frames_input->Events.push_back({ chipotto::InputType::KEYDOWN, chipotto::EmuKey::K_7 });
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(0x7, frames_emulator->GetRegisters()[0x3]);
+    CLOVE_UINT_EQ(5, frames_emulator->GetRegisters()[0x4]);
+}
+
+CLOVE_TEST(BLOCKED_ON_KEY_ONCE_TIMERS_STOP)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x02,     // 0x200: LD V0, 0x02
+        0xF0, 0x18,     // 0x202: LD ST, V0
+        0xF3, 0x0A,     // 0x204: LD V3, K
+        0x12, 0x06,     // 0x206: JP 0x206
+    };
+    LoadRom(frames_emulator, rom);
+
+    CLOVE_IS_FALSE(frames_emulator->IsBlockedOnKey());
+    // the sound timer still has a step to go, the host has to keep running frames
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::WaitingForKey);
+    CLOVE_IS_FALSE(frames_emulator->IsBlockedOnKey());
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::WaitingForKey);
+    CLOVE_IS_TRUE(frames_emulator->IsBlockedOnKey());
+
+    frames_input->Events.push_back({ chipotto::InputType::KEYDOWN, chipotto::EmuKey::K_2 });
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::FrameDone);
+    CLOVE_IS_FALSE(frames_emulator->IsBlockedOnKey());
+}
+
+CLOVE_TEST(KEY_WHILE_RUNNING_IS_IGNORED)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x74, 0x01,     // 0x200: ADD V4, 0x01
+        0x12, 0x00,     // 0x202: JP 0x200
+    };
+    LoadRom(frames_emulator, rom);
+
+    frames_input->Events.push_back({ chipotto::InputType::KEYDOWN, chipotto::EmuKey::K_7 });
+    CLOVE_IS_TRUE(frames_emulator->RunCycles(4) == chipotto::RunStatus::FrameDone);
+    CLOVE_UINT_EQ(0x200, frames_emulator->GetPC());
+    CLOVE_UINT_EQ(2, frames_emulator->GetRegisters()[0x4]);
+    CLOVE_UINT_EQ(0, frames_emulator->GetRegisters()[0x0]);
+}
+
+CLOVE_TEST(SELF_JUMP_IS_SKIPPED)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x05,     // 0x200: LD V0, 0x05
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0x12, 0x04,     // 0x204: JP 0x204
+    };
+    LoadRom(frames_emulator, rom);
+
+    const uint64_t start_count = frames_emulator->GetInstructionCount();
+    CLOVE_IS_TRUE(frames_emulator->RunCycles(1000000) == chipotto::RunStatus::FrameDone);
+    // only the first slice is interpreted
+    CLOVE_IS_TRUE(frames_emulator->GetInstructionCount() - start_count <= 10);
+    CLOVE_UINT_EQ(1000000, frames_emulator->GetCycles());
+    CLOVE_UINT_EQ(0, frames_emulator->GetDelayTimer());
+    CLOVE_UINT_EQ(0x204, frames_emulator->GetPC());
+}
+
+CLOVE_TEST(IDLE_SKIP_MATCHES_INTERPRETED)
+{
+    // waits for the delay timer to read 2, then for it to run out
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x07,     // 0x200: LD V0, 0x07
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0xF1, 0x07,     // 0x204: LD V1, DT
+        0x31, 0x02,     // 0x206: SE V1, 0x02
+        0x12, 0x04,     // 0x208: JP 0x204
+        0x72, 0x01,     // 0x20A: ADD V2, 0x01
+        0xF1, 0x07,     // 0x20C: LD V1, DT
+        0x31, 0x00,     // 0x20E: SE V1, 0x00
+        0x12, 0x0C,     // 0x210: JP 0x20C
+        0x73, 0x01,     // 0x212: ADD V3, 0x01
+        0x12, 0x00,     // 0x214: JP 0x200
+    };
+    const uint32_t budgets[] = { 7, 1, 13, 64, 3, 1000 };
+
+    // at one instruction per frame the timer moves 3 per loop and can pass 2 unseen, the second wait then never ends
+    for (const uint32_t instructions_per_frame : { 7u, 1u })
+    {
+        chipotto::MachineState interpreted;
+        for (const bool skip : { false, true })
+        {
+            frames_emulator->HardResetEmulator();
+            frames_emulator->SetFusionEnabled(false);
+            frames_emulator->SetIdleSkipEnabled(skip);
+            frames_emulator->SetInstructionsPerFrame(instructions_per_frame);
+            LoadRom(frames_emulator, rom);
+
+            const uint64_t start_idle = frames_emulator->GetIdleCycles();
+            for (int i = 0; i < 300; ++i)
+            {
+                CLOVE_IS_TRUE(frames_emulator->RunCycles(budgets[i % 6]) == chipotto::RunStatus::FrameDone);
+            }
+
+            if (!skip)
+            {
+                CLOVE_UINT_EQ(start_idle, frames_emulator->GetIdleCycles());
+                interpreted = frames_emulator->GetMachineState();
+                continue;
+            }
+            CLOVE_IS_TRUE(frames_emulator->GetIdleCycles() > start_idle);
+            if (instructions_per_frame == 7)
+            {
+                CLOVE_IS_TRUE(frames_emulator->GetRegisters()[0x3] > 0);
+            }
+            CLOVE_IS_TRUE(SameMachineState(interpreted, frames_emulator->GetMachineState()));
+        }
+    }
+}
+
+CLOVE_TEST(RUN_FRAME_ERROR)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x05,     // 0x200: LD V0, 0x05
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0xFF, 0xFF,     // 0x204: not an opcode
+    };
+    LoadRom(frames_emulator, rom);
+
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::Error);
+    CLOVE_UINT_EQ(0x204, frames_emulator->GetPC());
+    CLOVE_UINT_EQ(5, frames_emulator->GetDelayTimer());
+}
+
+CLOVE_TEST(RUN_FRAME_QUIT)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x74, 0x01,     // 0x200: ADD V4, 0x01
+        0x12, 0x00,     // 0x202: JP 0x200
+    };
+    LoadRom(frames_emulator, rom);
+
+    frames_input->Events.push_back({ chipotto::InputType::QUIT, chipotto::EmuKey::K_NONE });
+    CLOVE_IS_TRUE(frames_emulator->RunFrame() == chipotto::RunStatus::Quit);
+    CLOVE_UINT_EQ(0, frames_emulator->GetRegisters()[0x4]);
+}
+
+#pragma endregion //TESTS
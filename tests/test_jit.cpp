@@ -0,0 +1,250 @@
+#include "clove-unit.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestJit
+
+static chipotto::EmulatorImpl* jit_emulator = nullptr;
+static MockKeyboardStateInputCommand* jit_input = nullptr;
+
+static void PushOpcode(std::vector<uint8_t>& rom, const uint16_t opcode)
+{
+    rom.push_back(opcode >> 8);
+    rom.push_back(opcode & 0xFF);
+}
+
+// straight-line code looping back to 0x200, every memory access goes to 0x600 and up so the code is never touched
+static std::vector<uint8_t> RandomRom(const uint32_t seed, const int length)
+{
+    std::mt19937 rng(seed);
+    auto random = [&rng](const int max) { return static_cast<uint16_t>(std::uniform_int_distribution<int>(0, max)(rng)); };
+    // VF shows up as an operand more often than chance, it is where the flag ordering matters
+    auto random_register = [&]() { return random(3) == 0 ? static_cast<uint16_t>(0xF) : random(0xF); };
+
+    std::vector<uint8_t> rom;
+    while (rom.size() / 2 < static_cast<size_t>(length))
+    {
+        const uint16_t x = random_register() << 8;
+        const uint16_t y = random_register() << 4;
+        const uint16_t nn = random(0xFF);
+        // skips are kept away from the closing jump
+        const bool can_skip = rom.size() / 2 + 2 < static_cast<size_t>(length);
+        switch (random(can_skip ? 12 : 9))
+        {
+        case 0: PushOpcode(rom, 0x6000 | x | nn); break;
+        case 1: PushOpcode(rom, 0x7000 | x | nn); break;
+        case 2:
+        case 3:
+        {
+            static const uint16_t alu[] = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE };
+            PushOpcode(rom, 0x8000 | x | y | alu[random(8)]);
+            break;
+        }
+        case 4: PushOpcode(rom, 0xA600 | nn); break;
+        case 5: PushOpcode(rom, random(1) ? 0xF01E | x : 0xF029 | x); break;
+        case 6: PushOpcode(rom, random(1) ? 0xF007 | x : 0xF015 | x); break;
+        case 7: PushOpcode(rom, 0xC000 | x | nn); break;
+        case 8:
+        case 9:
+        {
+            static const uint16_t memory_ops[] = { 0xF033, 0xF055, 0xF065 };
+            PushOpcode(rom, 0xA600 | nn);
+            PushOpcode(rom, memory_ops[random(2)] | x);
+            break;
+        }
+        case 10: PushOpcode(rom, 0x3000 | x | (nn & 0x3)); break;
+        case 11: PushOpcode(rom, 0x4000 | x | (nn & 0x3)); break;
+        default: PushOpcode(rom, (random(1) ? 0x5000 : 0x9000) | x | y); break;
+        }
+    }
+    PushOpcode(rom, 0x1200);
+    return rom;
+}
+
+struct MachineSnapshot
+{
+    std::array<uint8_t, 0x10> registers{};
+    std::array<uint8_t, 0x200> data{};
+    uint16_t pc = 0;
+    uint16_t i = 0;
+    uint64_t executed = 0;
+};
+
+static MachineSnapshot RunRom(const std::vector<uint8_t>& rom, const chipotto::DispatchMode mode, const uint64_t min_instructions)
+{
+    jit_emulator->HardResetEmulator();
+    jit_emulator->SetDispatchMode(mode);
+    LoadRom(jit_emulator, rom);
+
+    MachineSnapshot snapshot;
+    const uint64_t start_count = jit_emulator->GetInstructionCount();
+    while (jit_emulator->GetInstructionCount() - start_count < min_instructions || jit_emulator->GetPC() != 0x200)
+    {
+        if (!jit_emulator->RunInstructions(1))
+            break;
+    }
+    snapshot.executed = jit_emulator->GetInstructionCount() - start_count;
+    snapshot.registers = jit_emulator->GetRegisters();
+    memcpy(snapshot.data.data(), jit_emulator->GetMemoryMapping().data() + 0x600, snapshot.data.size());
+    snapshot.pc = jit_emulator->GetPC();
+    snapshot.i = jit_emulator->GetI();
+    return snapshot;
+}
+
+static void ExpectSameMachine(const MachineSnapshot& expected, const MachineSnapshot& actual)
+{
+    CLOVE_ULLONG_EQ(expected.executed, actual.executed);
+    for (int i = 0; i < 0x10; ++i)
+    {
+        CLOVE_UINT_EQ(expected.registers[i], actual.registers[i]);
+    }
+    for (size_t i = 0; i < expected.data.size(); ++i)
+    {
+        CLOVE_UINT_EQ(expected.data[i], actual.data[i]);
+    }
+    CLOVE_UINT_EQ(expected.pc, actual.pc);
+    CLOVE_UINT_EQ(expected.i, actual.i);
+}
+
+CLOVE_SUITE_SETUP_ONCE()
+{
+    auto* renderer = new chipotto::HeadlessRenderer();
+    jit_input = new MockKeyboardStateInputCommand();
+    auto* random_generator = new MockRandomGenerator();
+    jit_emulator = new chipotto::EmulatorImpl(renderer, jit_input, random_generator);
+}
+
+CLOVE_SUITE_TEARDOWN()
+{
+    jit_input->FakeIsKeyPressed = false;
+    jit_emulator->SetJitThreshold(8);
+    jit_emulator->SetDispatchMode(chipotto::DispatchMode::Threaded);
+    jit_emulator->HardResetEmulator();
+}
+
+CLOVE_SUITE_TEARDOWN_ONCE()
+{
+    delete jit_emulator;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(RANDOM_PROGRAMS_MATCH_INTERPRETER)
+{
+    jit_emulator->SetJitThreshold(1);
+    for (uint32_t seed = 1; seed <= 40; ++seed)
+    {
+        const std::vector<uint8_t> rom = RandomRom(seed, 8 + seed % 48);
+        const MachineSnapshot expected = RunRom(rom, chipotto::DispatchMode::Switch, 2000);
+        const MachineSnapshot actual = RunRom(rom, chipotto::DispatchMode::Jit, 2000);
+        ExpectSameMachine(expected, actual);
+    }
+}
+
+CLOVE_TEST(FLAGS_WITH_VF_OPERANDS)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x6F, 0xF0,     // 0x200: LD VF, 0xF0
+        0x61, 0x20,     // 0x202: LD V1, 0x20
+        0x8F, 0x14,     // 0x204: ADD VF, V1
+        0x62, 0x90,     // 0x206: LD V2, 0x90
+        0x82, 0xF4,     // 0x208: ADD V2, VF
+        0x6F, 0x81,     // 0x20A: LD VF, 0x81
+        0x8F, 0xF4,     // 0x20C: ADD VF, VF
+        0x6F, 0x05,     // 0x20E: LD VF, 0x05
+        0x83, 0xF5,     // 0x210: SUB V3, VF
+        0x8F, 0x35,     // 0x212: SUB VF, V3
+        0x8F, 0x07,     // 0x214: SUBN VF, V0
+        0x8F, 0x06,     // 0x216: SHR VF
+        0x6F, 0x83,     // 0x218: LD VF, 0x83
+        0x8F, 0x0E,     // 0x21A: SHL VF
+        0x84, 0xF7,     // 0x21C: SUBN V4, VF
+        0x12, 0x00,     // 0x21E: JP 0x200
+    };
+
+    jit_emulator->SetJitThreshold(1);
+    const MachineSnapshot expected = RunRom(rom, chipotto::DispatchMode::Switch, 100);
+    const MachineSnapshot actual = RunRom(rom, chipotto::DispatchMode::Jit, 100);
+    ExpectSameMachine(expected, actual);
+}
+
+CLOVE_TEST(KEY_SKIPS_MATCH_INTERPRETER)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x65, 0x07,     // 0x200: LD V5, 0x07
+        0xE5, 0x9E,     // 0x202: SKP V5
+        0x76, 0x01,     // 0x204: ADD V6, 0x01
+        0xE5, 0xA1,     // 0x206: SKNP V5
+        0x77, 0x01,     // 0x208: ADD V7, 0x01
+        0x12, 0x00,     // 0x20A: JP 0x200
+    };
+
+    jit_emulator->SetJitThreshold(1);
+    for (const bool pressed : { false, true })
+    {
+        jit_input->FakeIsKeyPressed = pressed;
+        const MachineSnapshot expected = RunRom(rom, chipotto::DispatchMode::Switch, 60);
+        const MachineSnapshot actual = RunRom(rom, chipotto::DispatchMode::Jit, 60);
+        ExpectSameMachine(expected, actual);
+    }
+}
+
+CLOVE_TEST(BLOCKS_COMPILED_WHEN_HOT)
+{
+    jit_emulator->SetJitThreshold(3);
+    jit_emulator->SetDispatchMode(chipotto::DispatchMode::Jit);
+    LoadRom(jit_emulator, { 0x70, 0x01, 0x71, 0x02, 0x12, 0x00 });
+
+    CLOVE_IS_TRUE(jit_emulator->RunInstructions(6));
+#if CHIP8_HAS_JIT
+    CLOVE_INT_EQ(static_cast<int>(chipotto::DispatchMode::Jit), static_cast<int>(jit_emulator->GetDispatchMode()));
+    CLOVE_IS_TRUE(jit_emulator->GetBlockCache()[0x100].native == nullptr);
+
+    CLOVE_IS_TRUE(jit_emulator->RunInstructions(3));
+    CLOVE_IS_TRUE(jit_emulator->GetBlockCache()[0x100].native != nullptr);
+#else
+    CLOVE_INT_EQ(static_cast<int>(chipotto::DispatchMode::Block), static_cast<int>(jit_emulator->GetDispatchMode()));
+#endif // CHIP8_HAS_JIT
+
+    CLOVE_IS_TRUE(jit_emulator->RunInstructions(30));
+    CLOVE_UINT_EQ(13, jit_emulator->GetRegisters()[0x0]);
+    CLOVE_UINT_EQ(26, jit_emulator->GetRegisters()[0x1]);
+}
+
+CLOVE_TEST(COMPILED_BLOCK_INVALIDATED_BY_LOAD)
+{
+    jit_emulator->SetJitThreshold(1);
+    jit_emulator->SetDispatchMode(chipotto::DispatchMode::Jit);
+    LoadRom(jit_emulator, { 0x70, 0x01, 0x12, 0x00 });
+
+    CLOVE_IS_TRUE(jit_emulator->RunInstructions(4));
+    CLOVE_UINT_EQ(0x02, jit_emulator->GetRegisters()[0x0]);
+
+    LoadRom(jit_emulator, { 0x70, 0x10, 0x12, 0x00 });
+    CLOVE_IS_TRUE(jit_emulator->GetBlockCache()[0x100].native == nullptr);
+
+    CLOVE_IS_TRUE(jit_emulator->RunInstructions(4));
+    CLOVE_UINT_EQ(0x22, jit_emulator->GetRegisters()[0x0]);
+}
+
+CLOVE_TEST(COMPILED_BLOCK_STOPS_ON_ERROR)
+{
+    jit_emulator->SetJitThreshold(1);
+    jit_emulator->SetDispatchMode(chipotto::DispatchMode::Jit);
+    LoadRom(jit_emulator, { 0x60, 0x05, 0xE0, 0xFF, 0x70, 0x01 });
+
+    CLOVE_IS_FALSE(jit_emulator->RunInstructions(100));
+
+    CLOVE_UINT_EQ(0x202, jit_emulator->GetPC());
+    CLOVE_UINT_EQ(0x05, jit_emulator->GetRegisters()[0x0]);
+}
+
+#pragma endregion //TESTS
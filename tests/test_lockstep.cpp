@@ -0,0 +1,229 @@
+#include "clove-unit.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "lockstep/lockstep_emulator.h"
+#include "runner/headless_renderer.h"
+#include "runner/runner_input.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestLockstep
+
+// random branches, calls, BCD, load/store, draws, key checks, an FX0A and a delay timer wait; lanes whose
+// subroutine ran exactly 7 times by the 48th loop end up on an invalid opcode
+static const std::vector<uint8_t> lockstep_rom =
+{
+    0x6A, 0x00,     // 0x200: LD VA, 0x00
+    0xC0, 0x07,     // 0x202: RND V0, 0x07
+    0x30, 0x03,     // 0x204: SE V0, 0x03
+    0x12, 0x0C,     // 0x206: JP 0x20C
+    0x22, 0x50,     // 0x208: CALL 0x250
+    0x12, 0x10,     // 0x20A: JP 0x210
+    0x81, 0x04,     // 0x20C: ADD V1, V0
+    0x81, 0x0E,     // 0x20E: SHL V1
+    0xE0, 0x9E,     // 0x210: SKP V0
+    0x12, 0x16,     // 0x212: JP 0x216
+    0x72, 0x05,     // 0x214: ADD V2, 0x05
+    0xA3, 0x00,     // 0x216: LD I, 0x300
+    0xF1, 0x33,     // 0x218: LD B, V1
+    0xF2, 0x65,     // 0x21A: LD V2, [I]
+    0x83, 0x15,     // 0x21C: SUB V3, V1
+    0x84, 0x37,     // 0x21E: SUBN V4, V3
+    0x85, 0x46,     // 0x220: SHR V5, V4
+    0x86, 0xF4,     // 0x222: ADD V6, VF
+    0xD3, 0x45,     // 0x224: DRW V3, V4, 5
+    0x7A, 0x01,     // 0x226: ADD VA, 0x01
+    0x4A, 0x30,     // 0x228: SNE VA, 0x30
+    0x12, 0x40,     // 0x22A: JP 0x240
+    0x3A, 0x40,     // 0x22C: SE VA, 0x40
+    0x12, 0x02,     // 0x22E: JP 0x202
+    0xF7, 0x0A,     // 0x230: LD V7, K
+    0x6A, 0x00,     // 0x232: LD VA, 0x00
+    0x6B, 0x03,     // 0x234: LD VB, 0x03
+    0xFB, 0x15,     // 0x236: LD DT, VB
+    0xFB, 0x07,     // 0x238: LD VB, DT
+    0x3B, 0x00,     // 0x23A: SE VB, 0x00
+    0x12, 0x38,     // 0x23C: JP 0x238
+    0x12, 0x02,     // 0x23E: JP 0x202
+    0x3C, 0x07,     // 0x240: SE VC, 0x07
+    0x12, 0x02,     // 0x242: JP 0x202
+    0x00, 0x00,     // 0x244: invalid
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x7C, 0x01,     // 0x250: ADD VC, 0x01
+    0xFC, 0x29,     // 0x252: LD F, VC
+    0xD5, 0x65,     // 0x254: DRW V5, V6, 5
+    0xFC, 0x1E,     // 0x256: ADD I, VC
+    0xF3, 0x55,     // 0x258: LD [I], V3
+    0x00, 0xEE,     // 0x25A: RET
+};
+
+struct ReferenceLane
+{
+    chipotto::HeadlessRenderer* Screen = nullptr;
+    chipotto::RunnerInput* Keys = nullptr;
+    std::unique_ptr<chipotto::EmulatorImpl> Core;
+};
+
+// runs the ROM on the lockstep lanes and on one EmulatorImpl per lane with the same seeds and keys, false on the first difference
+template<size_t Lanes>
+static bool LockstepMatchesEmulators(const chipotto::QuirkProfile profile, const uint32_t instructions_per_frame, const uint32_t frames)
+{
+    const auto gamefile = MakeGamefile(lockstep_rom);
+
+    std::array<chipotto::IRandomGenerator*, Lanes> generators;
+    std::vector<ReferenceLane> references(Lanes);
+    for (size_t lane = 0; lane < Lanes; ++lane)
+    {
+        generators[lane] = new MockSeededRandomGenerator(static_cast<uint32_t>(lane * 77 + 1));
+        references[lane].Screen = new chipotto::HeadlessRenderer();
+        references[lane].Keys = new chipotto::RunnerInput();
+        references[lane].Core = std::make_unique<chipotto::EmulatorImpl>(references[lane].Screen, references[lane].Keys,
+            new MockSeededRandomGenerator(static_cast<uint32_t>(lane * 77 + 1)));
+        // a fresh EmulatorImpl leaves the memory past the fonts as it found it, the lanes start zeroed
+        references[lane].Core->HardResetEmulator();
+        references[lane].Core->SetDispatchMode(chipotto::DispatchMode::Table);
+        references[lane].Core->SetQuirkProfile(profile);
+        references[lane].Core->SetInstructionsPerFrame(instructions_per_frame);
+        references[lane].Core->Load(gamefile.get());
+    }
+    auto lockstep = std::make_unique<chipotto::LockstepEmulator<Lanes>>(generators);
+    lockstep->SetQuirkProfile(profile);
+    lockstep->SetInstructionsPerFrame(instructions_per_frame);
+    lockstep->Load(gamefile.get());
+
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            // every lane presses its own key at its own pace
+            const chipotto::EmuKey key = static_cast<chipotto::EmuKey>((lane + frame / 16) % 8);
+            if ((frame + lane) % 16 == 0)
+            {
+                lockstep->KeyDown(lane, key);
+                references[lane].Keys->SetKey(key, true);
+            }
+            else if ((frame + lane) % 16 == 5)
+            {
+                lockstep->KeyUp(lane, key);
+                references[lane].Keys->SetKey(key, false);
+            }
+        }
+
+        const auto failed = lockstep->RunFrame();
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            const chipotto::RunStatus status = references[lane].Core->RunFrame();
+            const chipotto::MachineState expected = references[lane].Core->GetMachineState();
+            const chipotto::MachineState actual = lockstep->GetMachineState(lane);
+            if (status != lockstep->GetStatus(lane) || ((failed >> lane) & 1) != (status == chipotto::RunStatus::Error)
+                || expected.Registers != actual.Registers || expected.I != actual.I || expected.PC != actual.PC || expected.SP != actual.SP
+                || expected.DelayTimer != actual.DelayTimer || expected.SoundTimer != actual.SoundTimer || expected.Suspended != actual.Suspended
+                || expected.CyclesSinceTimerStep != actual.CyclesSinceTimerStep || expected.Cycles != actual.Cycles
+                || references[lane].Screen->GetFrame() != lockstep->GetFramebuffer(lane))
+            {
+                return false;
+            }
+        }
+    }
+    for (size_t lane = 0; lane < Lanes; ++lane)
+    {
+        if (references[lane].Core->GetMemoryMapping() != lockstep->GetMemory(lane))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(LANES_MATCH_EMULATOR_IMPL)
+{
+    CLOVE_IS_TRUE(LockstepMatchesEmulators<8>(chipotto::QuirkProfile::Default, 10, 300));
+    CLOVE_IS_TRUE(LockstepMatchesEmulators<16>(chipotto::QuirkProfile::Default, 7, 300));
+    CLOVE_IS_TRUE(LockstepMatchesEmulators<32>(chipotto::QuirkProfile::Default, 25, 300));
+}
+
+CLOVE_TEST(LANES_FOLLOW_PROFILE)
+{
+    CLOVE_IS_TRUE(LockstepMatchesEmulators<32>(chipotto::QuirkProfile::Chip8, 10, 200));
+    CLOVE_IS_TRUE(LockstepMatchesEmulators<32>(chipotto::QuirkProfile::SuperChip, 10, 200));
+    CLOVE_IS_TRUE(LockstepMatchesEmulators<32>(chipotto::QuirkProfile::XoChip, 10, 200));
+}
+
+CLOVE_TEST(CONVERGED_LANES_SHARE_STEPS)
+{
+    // no randomness and no input, so every lane runs every step together
+    const std::vector<uint8_t> rom =
+    {
+        0x71, 0x01,     // 0x200: ADD V1, 0x01
+        0x82, 0x14,     // 0x202: ADD V2, V1
+        0x12, 0x00,     // 0x204: JP 0x200
+    };
+    const auto gamefile = MakeGamefile(rom);
+
+    std::array<chipotto::IRandomGenerator*, 32> generators;
+    for (chipotto::IRandomGenerator*& generator : generators)
+    {
+        generator = new MockRandomGenerator();
+    }
+    auto lockstep = std::make_unique<chipotto::LockstepEmulator<32>>(generators);
+    lockstep->Load(gamefile.get());
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        CLOVE_UINT_EQ(0, lockstep->RunFrame());
+    }
+
+    CLOVE_ULLONG_EQ(100, lockstep->GetStepCount());
+    CLOVE_ULLONG_EQ(3200, lockstep->GetLaneInstructionCount());
+    for (size_t lane = 0; lane < 32; ++lane)
+    {
+        CLOVE_ULLONG_EQ(100, lockstep->GetMachineState(lane).Cycles);
+    }
+}
+
+CLOVE_TEST(DIVERGED_LANES_MERGE_AGAIN)
+{
+    // every lane picks its own side of the branch each loop, then waits at the join for the others
+    const std::vector<uint8_t> rom =
+    {
+        0xC0, 0x01,     // 0x200: RND V0, 0x01
+        0x30, 0x00,     // 0x202: SE V0, 0x00
+        0x71, 0x03,     // 0x204: ADD V1, 0x03
+        0x82, 0x14,     // 0x206: ADD V2, V1
+        0x12, 0x00,     // 0x208: JP 0x200
+    };
+    const auto gamefile = MakeGamefile(rom);
+
+    std::array<chipotto::IRandomGenerator*, 32> generators;
+    for (size_t lane = 0; lane < generators.size(); ++lane)
+    {
+        generators[lane] = new MockSeededRandomGenerator(static_cast<uint32_t>(lane));
+    }
+    auto lockstep = std::make_unique<chipotto::LockstepEmulator<32>>(generators);
+    lockstep->SetInstructionsPerFrame(100);
+    lockstep->Load(gamefile.get());
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        lockstep->RunFrame();
+    }
+
+    CLOVE_ULLONG_EQ(32 * 1000, lockstep->GetLaneInstructionCount());
+    // the lanes drift apart by one instruction at most per loop, they must not stay apart
+    CLOVE_IS_TRUE(lockstep->GetLaneInstructionCount() > 24 * lockstep->GetStepCount());
+    bool diverged = false;
+    for (size_t lane = 1; lane < 32; ++lane)
+    {
+        diverged = diverged || lockstep->GetMachineState(lane).Registers[1] != lockstep->GetMachineState(0).Registers[1];
+    }
+    CLOVE_IS_TRUE(diverged);
+}
+
+#pragma endregion //TESTS
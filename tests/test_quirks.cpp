@@ -0,0 +1,209 @@
+#include "clove-unit.h"
+
+#include <vector>
+
+#include "emulator_impl.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestQuirks
+
+static chipotto::EmulatorImpl* quirks_emulator = nullptr;
+
+static const chipotto::QuirkProfile all_profiles[] =
+{
+    chipotto::QuirkProfile::Default,
+    chipotto::QuirkProfile::Chip8,
+    chipotto::QuirkProfile::SuperChip,
+    chipotto::QuirkProfile::XoChip
+};
+
+CLOVE_SUITE_SETUP_ONCE()
+{
+    auto* renderer = new chipotto::HeadlessRenderer();
+    auto* input_class = new MockKeyboardStateInputCommand();
+    auto* random_generator = new MockRandomGenerator();
+    quirks_emulator = new chipotto::EmulatorImpl(renderer, input_class, random_generator);
+}
+
+CLOVE_SUITE_SETUP()
+{
+    quirks_emulator->SetDispatchMode(chipotto::DispatchMode::Switch);
+}
+
+CLOVE_SUITE_TEARDOWN()
+{
+    quirks_emulator->SetQuirkProfile(chipotto::QuirkProfile::Default);
+    quirks_emulator->SetDispatchMode(chipotto::DispatchMode::Threaded);
+    quirks_emulator->HardResetEmulator();
+}
+
+CLOVE_SUITE_TEARDOWN_ONCE()
+{
+    delete quirks_emulator;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(SHIFT_SOURCE)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x61, 0x81,     // 0x200: LD V1, 0x81
+        0x62, 0x03,     // 0x202: LD V2, 0x03
+        0x81, 0x26,     // 0x204: SHR V1, V2
+        0x63, 0x01,     // 0x206: LD V3, 0x01
+        0x64, 0x80,     // 0x208: LD V4, 0x80
+        0x83, 0x4E,     // 0x20A: SHL V3, V4
+    };
+
+    for (const chipotto::QuirkProfile profile : all_profiles)
+    {
+        quirks_emulator->HardResetEmulator();
+        quirks_emulator->SetQuirkProfile(profile);
+        LoadRom(quirks_emulator, rom);
+        CLOVE_IS_TRUE(quirks_emulator->RunInstructions(6));
+
+        const bool reads_vy = profile == chipotto::QuirkProfile::Chip8 || profile == chipotto::QuirkProfile::XoChip;
+        CLOVE_UINT_EQ(reads_vy ? 0x01 : 0x40, quirks_emulator->GetRegisters()[0x1]);
+        CLOVE_UINT_EQ(reads_vy ? 0x00 : 0x02, quirks_emulator->GetRegisters()[0x3]);
+        CLOVE_UINT_EQ(reads_vy ? 0x1 : 0x0, quirks_emulator->GetRegisters()[0xF]);
+    }
+}
+
+CLOVE_TEST(LOAD_STORE_ADVANCES_I)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0xA3, 0x00,     // 0x200: LD I, 0x300
+        0xF2, 0x55,     // 0x202: LD [I], V2
+        0xF1, 0x65,     // 0x204: LD V1, [I]
+    };
+
+    for (const chipotto::QuirkProfile profile : all_profiles)
+    {
+        quirks_emulator->HardResetEmulator();
+        quirks_emulator->SetQuirkProfile(profile);
+        LoadRom(quirks_emulator, rom);
+        CLOVE_IS_TRUE(quirks_emulator->RunInstructions(3));
+
+        const bool advances = profile == chipotto::QuirkProfile::Chip8 || profile == chipotto::QuirkProfile::XoChip;
+        CLOVE_UINT_EQ(advances ? 0x305 : 0x300, quirks_emulator->GetI());
+    }
+}
+
+CLOVE_TEST(JUMP_OFFSET_REGISTER)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x10,     // 0x200: LD V0, 0x10
+        0x63, 0x20,     // 0x202: LD V3, 0x20
+        0xB3, 0x00,     // 0x204: JP V0, 0x300
+    };
+
+    for (const chipotto::QuirkProfile profile : all_profiles)
+    {
+        quirks_emulator->HardResetEmulator();
+        quirks_emulator->SetQuirkProfile(profile);
+        LoadRom(quirks_emulator, rom);
+        CLOVE_IS_TRUE(quirks_emulator->RunInstructions(3));
+
+        const uint16_t expected = profile == chipotto::QuirkProfile::SuperChip ? 0x320 : 0x310;
+        CLOVE_UINT_EQ(expected + 2, quirks_emulator->GetPC());
+    }
+}
+
+CLOVE_TEST(PROFILE_SETS_WRAP)
+{
+    // a one row sprite at x = 60 runs over the right edge, only a wrapping profile lights x = 0
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x3C,     // 0x200: LD V0, 60
+        0x61, 0x00,     // 0x202: LD V1, 0
+        0xA2, 0x0A,     // 0x204: LD I, 0x20A
+        0xD0, 0x11,     // 0x206: DRW V0, V1, 1
+        0x12, 0x08,     // 0x208: JP 0x208
+        0xFF, 0x00,     // 0x20A: sprite
+    };
+
+    for (const chipotto::QuirkProfile profile : { chipotto::QuirkProfile::Default, chipotto::QuirkProfile::XoChip })
+    {
+        quirks_emulator->HardResetEmulator();
+        quirks_emulator->SetQuirkProfile(profile);
+        LoadRom(quirks_emulator, rom);
+        CLOVE_IS_TRUE(quirks_emulator->RunInstructions(4));
+
+        const auto* screen = static_cast<const chipotto::HeadlessRenderer*>(quirks_emulator->GetRenderer());
+        const bool left_pixel = screen->IsPixelSet(0, 0);
+        const bool right_pixel = screen->IsPixelSet(63, 0);
+
+        CLOVE_IS_TRUE(right_pixel);
+        CLOVE_IS_TRUE(left_pixel == (profile == chipotto::QuirkProfile::XoChip));
+    }
+}
+
+CLOVE_TEST(ALL_ENGINES_FOLLOW_PROFILE)
+{
+    // shifts, jumps and load/store in a loop, with the pointer reset so the writes stay below the code
+    const std::vector<uint8_t> rom =
+    {
+        0x6A, 0x00,     // 0x200: LD VA, 0x00
+        0x6B, 0x03,     // 0x202: LD VB, 0x03
+        0xA6, 0x00,     // 0x204: LD I, 0x600
+        0x7A, 0x05,     // 0x206: ADD VA, 0x05
+        0x8C, 0xA6,     // 0x208: SHR VC, VA
+        0x8D, 0xAE,     // 0x20A: SHL VD, VA
+        0x8E, 0xD6,     // 0x20C: SHR VE, VD
+        0xFE, 0x55,     // 0x20E: LD [I], VE
+        0xF3, 0x65,     // 0x210: LD V3, [I]
+        0x8B, 0xC4,     // 0x212: ADD VB, VC
+        0x60, 0x00,     // 0x214: LD V0, 0x00
+        0xB2, 0x18,     // 0x216: JP V0, 0x218 (lands on 0x21A, V2 is 0x00 here too)
+        0x00, 0x00,
+        0x12, 0x04,     // 0x21A: JP 0x204
+    };
+    const chipotto::DispatchMode modes[] =
+    {
+        chipotto::DispatchMode::Table,
+        chipotto::DispatchMode::Switch,
+        chipotto::DispatchMode::Threaded,
+        chipotto::DispatchMode::Block,
+        chipotto::DispatchMode::Jit,
+        chipotto::DispatchMode::Specialized
+    };
+
+    quirks_emulator->SetJitThreshold(1);
+    for (const chipotto::QuirkProfile profile : all_profiles)
+    {
+        std::array<uint8_t, 0x10> expected_registers{};
+        uint16_t expected_i = 0;
+        for (size_t mode_index = 0; mode_index < std::size(modes); ++mode_index)
+        {
+            quirks_emulator->HardResetEmulator();
+            quirks_emulator->SetDispatchMode(modes[mode_index]);
+            quirks_emulator->SetQuirkProfile(profile);
+            LoadRom(quirks_emulator, rom);
+
+            const uint64_t start_count = quirks_emulator->GetInstructionCount();
+            while (quirks_emulator->GetInstructionCount() - start_count < 1000 || quirks_emulator->GetPC() != 0x204)
+            {
+                CLOVE_IS_TRUE(quirks_emulator->RunInstructions(1));
+            }
+
+            if (mode_index == 0)
+            {
+                expected_registers = quirks_emulator->GetRegisters();
+                expected_i = quirks_emulator->GetI();
+                continue;
+            }
+            for (int i = 0; i < 0x10; ++i)
+            {
+                CLOVE_UINT_EQ(expected_registers[i], quirks_emulator->GetRegisters()[i]);
+            }
+            CLOVE_UINT_EQ(expected_i, quirks_emulator->GetI());
+        }
+    }
+    quirks_emulator->SetJitThreshold(8);
+}
+
+#pragma endregion //TESTS
@@ -0,0 +1,275 @@
+#include "clove-unit.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "emulator_impl.h"
+#include "gamefile.h"
+#include "runner/headless_renderer.h"
+#include "runner/threaded_runner.h"
+#include "runner/triple_buffer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestRunner
+
+// polls the snapshots until condition holds, false after two seconds
+static bool WaitForSnapshot(const chipotto::ThreadedRunner& runner, const std::function<bool(const chipotto::RunnerSnapshot&)>& condition)
+{
+    const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < give_up)
+    {
+        if (condition(runner.GetSnapshot()))
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+#pragma region TESTS
+
+CLOVE_TEST(SPSC_QUEUE_KEEPS_ORDER)
+{
+    chipotto::SpscQueue<uint32_t, 8> queue;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        CLOVE_IS_TRUE(queue.TryPush(i));
+    }
+    CLOVE_IS_FALSE(queue.TryPush(8));
+
+    // one producer thread, this thread consumes
+    std::thread producer([&queue]()
+    {
+        for (uint32_t i = 8; i < 100000; ++i)
+        {
+            while (!queue.TryPush(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    bool in_order = true;
+    for (uint32_t expected = 0; expected < 100000; ++expected)
+    {
+        uint32_t value;
+        while (!queue.TryPop(value))
+        {
+            std::this_thread::yield();
+        }
+        in_order = in_order && value == expected;
+    }
+    producer.join();
+
+    uint32_t value;
+    CLOVE_IS_TRUE(in_order);
+    CLOVE_IS_FALSE(queue.TryPop(value));
+}
+
+CLOVE_TEST(SEQLOCK_NEVER_TEARS)
+{
+    struct Pair
+    {
+        uint64_t value[8];
+    };
+    chipotto::SeqLock<Pair> lock;
+    std::atomic<bool> done{ false };
+
+    std::thread writer([&lock, &done]()
+    {
+        for (uint64_t i = 1; i <= 20000; ++i)
+        {
+            Pair pair;
+            for (uint64_t& word : pair.value)
+            {
+                word = i;
+            }
+            lock.Store(pair);
+        }
+        done.store(true);
+    });
+    bool whole = true;
+    while (!done.load())
+    {
+        const Pair pair = lock.Load();
+        for (const uint64_t word : pair.value)
+        {
+            whole = whole && word == pair.value[0];
+        }
+    }
+    writer.join();
+
+    CLOVE_IS_TRUE(whole);
+    CLOVE_ULLONG_EQ(20000, lock.Load().value[7]);
+    CLOVE_UINT_EQ(20000, lock.GetVersion());
+}
+
+CLOVE_TEST(TRIPLE_BUFFER_HANDS_OVER_THE_NEWEST)
+{
+    chipotto::TripleBuffer<uint32_t> buffer;
+    CLOVE_IS_FALSE(buffer.Acquire());
+
+    // the reader only ever sees the last of several values, the others are dropped
+    for (uint32_t value = 1; value <= 3; ++value)
+    {
+        buffer.GetWriteBuffer() = value;
+        buffer.Publish();
+    }
+    CLOVE_IS_TRUE(buffer.Acquire());
+    CLOVE_UINT_EQ(3, buffer.GetReadBuffer());
+    CLOVE_ULLONG_EQ(2, buffer.GetDroppedCount());
+    CLOVE_IS_FALSE(buffer.Acquire());
+    CLOVE_UINT_EQ(3, buffer.GetReadBuffer());
+
+    // the writer never touches the slot the reader holds
+    buffer.GetWriteBuffer() = 4;
+    CLOVE_UINT_EQ(3, buffer.GetReadBuffer());
+    buffer.Publish();
+    CLOVE_IS_TRUE(buffer.Acquire());
+    CLOVE_UINT_EQ(4, buffer.GetReadBuffer());
+    CLOVE_ULLONG_EQ(4, buffer.GetVersion());
+}
+
+CLOVE_TEST(TRIPLE_BUFFER_NEVER_TEARS)
+{
+    struct Frame
+    {
+        uint64_t rows[32];
+    };
+    chipotto::TripleBuffer<Frame> buffer;
+    std::atomic<bool> done{ false };
+
+    std::thread writer([&buffer, &done]()
+    {
+        for (uint64_t i = 1; i <= 20000; ++i)
+        {
+            for (uint64_t& row : buffer.GetWriteBuffer().rows)
+            {
+                row = i;
+            }
+            buffer.Publish();
+        }
+        done.store(true);
+    });
+    bool whole = true;
+    bool in_order = true;
+    uint64_t last = 0;
+    uint64_t taken = 0;
+    while (true)
+    {
+        // read before Acquire, so once the writer is done the last frame is still taken
+        const bool finished = done.load();
+        if (!buffer.Acquire())
+        {
+            if (finished)
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+        const Frame& frame = buffer.GetReadBuffer();
+        for (const uint64_t row : frame.rows)
+        {
+            whole = whole && row == frame.rows[0];
+        }
+        in_order = in_order && frame.rows[0] > last;
+        last = frame.rows[0];
+        ++taken;
+    }
+    writer.join();
+
+    CLOVE_IS_TRUE(whole);
+    CLOVE_IS_TRUE(in_order);
+    CLOVE_ULLONG_EQ(20000, last);
+    CLOVE_ULLONG_EQ(20000, taken + buffer.GetDroppedCount());
+}
+
+CLOVE_TEST(RUNNER_RUNS_ON_ITS_THREAD)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0x71, 0x01,     // 0x200: ADD V1, 0x01
+        0x12, 0x00,     // 0x202: JP 0x200
+    };
+    chipotto::ThreadedRunner runner(new MockRandomGenerator());
+    CLOVE_IS_TRUE(runner.GetSnapshot().Paused);
+
+    CLOVE_IS_TRUE(runner.Load(MakeGamefile(rom).release()));
+    CLOVE_IS_TRUE(runner.SetSpeed(0.0f));
+    CLOVE_IS_TRUE(runner.Resume());
+    CLOVE_IS_TRUE(WaitForSnapshot(runner, [](const chipotto::RunnerSnapshot& snapshot) { return snapshot.Frames >= 20; }));
+
+    CLOVE_IS_TRUE(runner.Pause());
+    CLOVE_IS_TRUE(WaitForSnapshot(runner, [](const chipotto::RunnerSnapshot& snapshot) { return snapshot.Paused; }));
+    const chipotto::RunnerSnapshot paused = runner.GetSnapshot();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CLOVE_ULLONG_EQ(paused.Frames, runner.GetSnapshot().Frames);
+    CLOVE_IS_TRUE(paused.State.Cycles >= 200);
+
+    // a reset keeps the game and starts it over
+    CLOVE_IS_TRUE(runner.Reset());
+    CLOVE_IS_TRUE(WaitForSnapshot(runner, [](const chipotto::RunnerSnapshot& snapshot) { return snapshot.State.Cycles == 0; }));
+    CLOVE_UINT_EQ(0x200, runner.GetSnapshot().State.PC);
+}
+
+CLOVE_TEST(RUNNER_KEYS_AND_FRAMEBUFFER)
+{
+    const std::vector<uint8_t> rom =
+    {
+        0xF3, 0x0A,     // 0x200: LD V3, K
+        0xF3, 0x29,     // 0x202: LD F, V3
+        0xD0, 0x05,     // 0x204: DRW V0, V0, 5
+        0x12, 0x06,     // 0x206: JP 0x206
+    };
+    chipotto::ThreadedRunner runner(new MockRandomGenerator());
+    CLOVE_IS_TRUE(runner.Load(MakeGamefile(rom).release()));
+    CLOVE_IS_TRUE(runner.Resume());
+    CLOVE_IS_TRUE(WaitForSnapshot(runner, [](const chipotto::RunnerSnapshot& snapshot) { return snapshot.Status == chipotto::RunStatus::WaitingForKey; }));
+
+    CLOVE_IS_TRUE(runner.KeyDown(chipotto::EmuKey::K_1));
+    CLOVE_IS_TRUE(runner.KeyUp(chipotto::EmuKey::K_1));
+    CLOVE_IS_TRUE(WaitForSnapshot(runner, [](const chipotto::RunnerSnapshot& snapshot) { return snapshot.State.PC == 0x206; }));
+
+    // the font sprite of 1 is 0x20, 0x60, 0x20, 0x20, 0x70 in the top left corner
+    const chipotto::RunnerSnapshot snapshot = runner.GetSnapshot();
+    CLOVE_UINT_EQ(1, snapshot.State.Registers[0x3]);
+    CLOVE_ULLONG_EQ(0x20ull << 56, snapshot.Framebuffer[0]);
+    CLOVE_ULLONG_EQ(0x60ull << 56, snapshot.Framebuffer[1]);
+    CLOVE_ULLONG_EQ(0x70ull << 56, snapshot.Framebuffer[4]);
+    CLOVE_ULLONG_EQ(0, snapshot.Framebuffer[5]);
+}
+
+CLOVE_TEST(HEADLESS_RENDERER_READS_THE_CORE_FRAMEBUFFER)
+{
+    auto* screen = new chipotto::HeadlessRenderer();
+    CLOVE_IS_TRUE(screen->IsValid());
+    CLOVE_ULLONG_EQ(0, screen->GetFrame()[0]);
+
+    chipotto::EmulatorImpl emulator(screen, new MockKeyboardStateInputCommand(), new MockRandomGenerator());
+    emulator.HardResetEmulator();
+    std::unique_ptr<chipotto::Gamefile> gamefile(MakeGamefile(
+    {
+        0x60, 0x3C,     // 0x200: LD V0, 60
+        0x61, 0x05,     // 0x202: LD V1, 5
+        0xA2, 0x0A,     // 0x204: LD I, 0x20A
+        0xD0, 0x11,     // 0x206: DRW V0, V1, 1
+        0x12, 0x08,     // 0x208: JP 0x208
+        0xF0, 0x00,     // 0x20A: sprite
+    }));
+    emulator.Load(gamefile.get());
+    const uint64_t frames_before = screen->GetFrameCount();
+    emulator.RunFrame();
+
+    // no copy: the frame is the screen of the core itself
+    CLOVE_IS_TRUE(&screen->GetFrame() == &emulator.GetFramebuffer());
+    CLOVE_ULLONG_EQ(0xFull, screen->GetFrame()[5]);
+    CLOVE_IS_TRUE(screen->IsPixelSet(60, 5));
+    CLOVE_IS_TRUE(screen->IsPixelSet(63, 5));
+    CLOVE_IS_FALSE(screen->IsPixelSet(59, 5));
+    CLOVE_ULLONG_EQ(frames_before + 1, screen->GetFrameCount());
+}
+
+#pragma endregion //TESTS
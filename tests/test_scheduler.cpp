@@ -0,0 +1,107 @@
+#include "clove-unit.h"
+
+#include <vector>
+
+#include "runner/coroutine_scheduler.h"
+#include "runner/headless_renderer.h"
+#include "mocks.h"
+
+#define CLOVE_SUITE_NAME TestScheduler
+
+#pragma region TESTS
+
+CLOVE_TEST(SLEEPING_MATCHES_EVERY_FRAME)
+{
+    // a game loop: count, then wait 5 frames on the delay timer
+    const std::vector<uint8_t> rom =
+    {
+        0x60, 0x05,     // 0x200: LD V0, 0x05
+        0xF0, 0x15,     // 0x202: LD DT, V0
+        0x72, 0x01,     // 0x204: ADD V2, 0x01
+        0xF1, 0x07,     // 0x206: LD V1, DT
+        0x31, 0x00,     // 0x208: SE V1, 0x00
+        0x12, 0x06,     // 0x20A: JP 0x206
+        0x12, 0x00,     // 0x20C: JP 0x200
+    };
+    const auto gamefile = MakeGamefile(rom);
+
+    chipotto::EmulatorImpl reference(new chipotto::HeadlessRenderer(), new MockEventInputCommand(), new MockRandomGenerator());
+    reference.Load(gamefile.get());
+    chipotto::CoroutineScheduler scheduler;
+    const uint32_t id = scheduler.Spawn(gamefile.get(), new MockRandomGenerator());
+
+    bool same_count = true;
+    size_t resumed = 0;
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        reference.RunFrame();
+        resumed += scheduler.Tick();
+        // V2 only changes once the wait is over, so a sleeping instance already shows the right value
+        same_count = same_count && reference.GetRegisters()[0x2] == scheduler.GetEmulator(id).GetMachineState().Registers[0x2];
+    }
+
+    CLOVE_IS_TRUE(same_count);
+    CLOVE_IS_TRUE(reference.GetRegisters()[0x2] >= 20);
+    CLOVE_IS_TRUE(resumed < 120);
+    CLOVE_UINT_EQ(120, scheduler.GetFrame());
+}
+
+CLOVE_TEST(KEY_WAITS_COST_NOTHING)
+{
+    const std::vector<uint8_t> waiting_rom =
+    {
+        0xF3, 0x0A,     // 0x200: LD V3, K
+        0x74, 0x01,     // 0x202: ADD V4, 0x01
+        0x12, 0x02,     // 0x204: JP 0x202
+    };
+    const std::vector<uint8_t> counting_rom =
+    {
+        0x74, 0x01,     // 0x200: ADD V4, 0x01
+        0x12, 0x00,     // 0x202: JP 0x200
+    };
+    const auto waiting_game = MakeGamefile(waiting_rom);
+    const auto counting_game = MakeGamefile(counting_rom);
+
+    chipotto::CoroutineScheduler scheduler;
+    const uint32_t waiting = scheduler.Spawn(waiting_game.get(), new MockRandomGenerator());
+    const uint32_t counting = scheduler.Spawn(counting_game.get(), new MockRandomGenerator());
+
+    CLOVE_UINT_EQ(2, scheduler.Tick());
+    CLOVE_IS_TRUE(scheduler.GetState(waiting) == chipotto::InstanceState::WaitingForKey);
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        CLOVE_UINT_EQ(1, scheduler.Tick());
+    }
+
+    scheduler.KeyDown(waiting, chipotto::EmuKey::K_5);
+    CLOVE_IS_TRUE(scheduler.GetState(waiting) == chipotto::InstanceState::Ready);
+    CLOVE_UINT_EQ(2, scheduler.Tick());
+    CLOVE_UINT_EQ(0x5, scheduler.GetEmulator(waiting).GetMachineState().Registers[0x3]);
+    CLOVE_IS_TRUE(scheduler.GetEmulator(waiting).GetMachineState().Registers[0x4] > 0);
+    CLOVE_IS_TRUE(scheduler.GetState(counting) == chipotto::InstanceState::Ready);
+}
+
+CLOVE_TEST(HALTED_AND_STOPPED_LEAVE)
+{
+    const std::vector<uint8_t> halting_rom =
+    {
+        0x12, 0x00,     // 0x200: JP 0x200
+    };
+    const std::vector<uint8_t> failing_rom =
+    {
+        0xFF, 0xFF,     // 0x200: not an opcode
+    };
+    const auto halting_game = MakeGamefile(halting_rom);
+    const auto failing_game = MakeGamefile(failing_rom);
+
+    chipotto::CoroutineScheduler scheduler;
+    const uint32_t halting = scheduler.Spawn(halting_game.get(), new MockRandomGenerator());
+    const uint32_t failing = scheduler.Spawn(failing_game.get(), new MockRandomGenerator());
+
+    CLOVE_UINT_EQ(2, scheduler.Tick());
+    CLOVE_IS_TRUE(scheduler.GetState(halting) == chipotto::InstanceState::Halted);
+    CLOVE_IS_TRUE(scheduler.GetState(failing) == chipotto::InstanceState::Stopped);
+    CLOVE_UINT_EQ(0, scheduler.Tick());
+}
+
+#pragma endregion //TESTS
@@ -0,0 +1,298 @@
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "aot/static_program.h"
+
+using namespace chipotto;
+
+namespace
+{
+	constexpr uint16_t RomStart = 0x200;
+
+	struct RecoveredBlock
+	{
+		uint16_t address = 0;
+		// opcodes of the block, the last one is the terminator unless the block was cut
+		std::vector<uint16_t> opcodes;
+		bool terminated = false;
+	};
+
+	class Translator
+	{
+	public:
+		Translator(const std::vector<uint8_t>& rom) : Rom(rom) {}
+
+		// recursive descent from the entry point, only code reachable through direct control flow is translated
+		void RecoverBlocks()
+		{
+			std::vector<uint16_t> worklist = { RomStart };
+			while (!worklist.empty())
+			{
+				const uint16_t start = worklist.back();
+				worklist.pop_back();
+				if (!IsTranslatable(start) || Blocks.count(start) > 0)
+					continue;
+
+				RecoveredBlock& block = Blocks[start];
+				block.address = start;
+				uint16_t address = start;
+				while (IsTranslatable(address) && block.opcodes.size() < StaticRuntime::MaxBlockLength)
+				{
+					const uint16_t opcode = ReadOpcode(address);
+					block.opcodes.push_back(opcode);
+					const DecodedInstruction instruction = StaticRuntime::Decode(opcode);
+					if (StaticRuntime::IsBlockTerminator(instruction.id))
+					{
+						block.terminated = true;
+						AddSuccessors(instruction, address, worklist);
+						break;
+					}
+					address += 2;
+				}
+
+				if (!block.terminated)
+				{
+					worklist.push_back(address);
+				}
+			}
+		}
+
+		std::string Emit(const std::string& name) const
+		{
+			std::string out;
+			out += "// Generated by Chip8Aot from " + name + ", do not edit.\n";
+			out += "#include \"aot/static_program.h\"\n\n";
+			out += "using namespace chipotto;\n\n";
+			out += "namespace\n{\n";
+
+			out += "\tconst uint8_t Rom[] =\n\t{";
+			for (size_t i = 0; i < Rom.size(); ++i)
+			{
+				out += i % 16 == 0 ? "\n\t\t" : " ";
+				out += Format("0x%02X,", Rom[i]);
+			}
+			out += "\n\t};\n";
+
+			for (const auto& [address, block] : Blocks)
+			{
+				EmitBlock(block, out);
+			}
+
+			out += "\n\tconst StaticBlock Blocks[] =\n\t{\n";
+			for (const auto& [address, block] : Blocks)
+			{
+				out += Format("\t\t{ 0x%03X, %u, &Block_%03X },\n", address, static_cast<unsigned>(block.opcodes.size()), address);
+			}
+			out += "\t};\n}\n\n";
+
+			out += "namespace chipotto::aot\n{\n";
+			out += "\textern const StaticProgram " + name + ";\n";
+			out += "\tconst StaticProgram " + name + " = { \"" + name + "\", Rom, sizeof(Rom), Blocks, sizeof(Blocks) / sizeof(Blocks[0]) };\n";
+			out += "}\n";
+			return out;
+		}
+
+		size_t GetBlockCount() const { return Blocks.size(); }
+
+		size_t GetInstructionCount() const
+		{
+			size_t count = 0;
+			for (const auto& [address, block] : Blocks)
+			{
+				count += block.opcodes.size();
+			}
+			return count;
+		}
+
+	private:
+		bool IsTranslatable(const uint16_t address) const
+		{
+			return (address & 0x1) == 0 && address >= RomStart && static_cast<size_t>(address) + 1 < RomStart + Rom.size();
+		}
+
+		uint16_t ReadOpcode(const uint16_t address) const
+		{
+			return (Rom[address - RomStart] << 8) | Rom[address - RomStart + 1];
+		}
+
+		static void AddSuccessors(const DecodedInstruction& instruction, const uint16_t address, std::vector<uint16_t>& worklist)
+		{
+			switch (instruction.id)
+			{
+			case Instruction::JP:
+				worklist.push_back(instruction.nnn);
+				break;
+			case Instruction::CALL:
+				// the return lands after the call
+				worklist.push_back(instruction.nnn);
+				worklist.push_back(address + 2);
+				break;
+			case Instruction::SE_VX_BYTE:
+			case Instruction::SNE_VX_BYTE:
+			case Instruction::SE_VX_VY:
+			case Instruction::SNE_VX_VY:
+			case Instruction::SKP_VX:
+			case Instruction::SKNP_VX:
+				worklist.push_back(address + 2);
+				worklist.push_back(address + 4);
+				break;
+			case Instruction::RET:
+			case Instruction::JP_V0_ADDR:
+			case Instruction::NotImplemented:
+				// indirect or invalid, whatever runs next is interpreted
+				break;
+			default:
+				worklist.push_back(address + 2);
+				break;
+			}
+		}
+
+		static std::string Format(const char* format, ...)
+		{
+			char buffer[256];
+			va_list args;
+			va_start(args, format);
+			vsnprintf(buffer, sizeof(buffer), format, args);
+			va_end(args);
+			return buffer;
+		}
+
+		static std::string EmitSkip(const char* condition, const uint16_t address)
+		{
+			return Format("\t\tm.PC = %s ? 0x%03X : 0x%03X;\n\t\treturn OpcodeStatus::NotIncrementPC;\n", condition, address + 4, address + 2);
+		}
+
+		static void EmitBlock(const RecoveredBlock& block, std::string& out)
+		{
+			out += Format("\n\tOpcodeStatus Block_%03X(StaticMachine& m)\n\t{\n", block.address);
+
+			uint16_t address = block.address;
+			for (const uint16_t opcode : block.opcodes)
+			{
+				const DecodedInstruction instruction = StaticRuntime::Decode(opcode);
+				const unsigned x = instruction.x;
+				const unsigned y = instruction.y;
+				const unsigned nn = instruction.nn;
+				const unsigned nnn = instruction.nnn;
+
+				out += Format("\t\t// 0x%03X: %04X\n", address, opcode);
+				switch (instruction.id)
+				{
+				case Instruction::LD_VX_BYTE: out += Format("\t\tm.V[0x%X] = 0x%02X;\n", x, nn); break;
+				case Instruction::ADD_VX_BYTE: out += Format("\t\tm.V[0x%X] += 0x%02X;\n", x, nn); break;
+				case Instruction::LD_VX_VY: out += Format("\t\tm.V[0x%X] = m.V[0x%X];\n", x, y); break;
+				case Instruction::OR_VX_VY: out += Format("\t\tm.V[0x%X] |= m.V[0x%X];\n", x, y); break;
+				case Instruction::AND_VX_VY: out += Format("\t\tm.V[0x%X] &= m.V[0x%X];\n", x, y); break;
+				case Instruction::XOR_VX_VY: out += Format("\t\tm.V[0x%X] ^= m.V[0x%X];\n", x, y); break;
+				// VF is written before the result, exactly like the interpreter, in case it is an operand
+				case Instruction::ADD_VX_VY:
+					out += Format("\t\tm.V[0xF] = m.V[0x%X] + m.V[0x%X] > 0xFF;\n\t\tm.V[0x%X] += m.V[0x%X];\n", x, y, x, y);
+					break;
+				case Instruction::SUB_VX_VY:
+					out += Format("\t\tm.V[0xF] = m.V[0x%X] > m.V[0x%X];\n\t\tm.V[0x%X] -= m.V[0x%X];\n", x, y, x, y);
+					break;
+				case Instruction::SUBN_VX_VY:
+					out += Format("\t\tm.V[0xF] = m.V[0x%X] > m.V[0x%X];\n\t\tm.V[0x%X] = m.V[0x%X] - m.V[0x%X];\n", y, x, x, y, x);
+					break;
+				case Instruction::LD_I_ADDR: out += Format("\t\tm.I = 0x%03X;\n", nnn); break;
+				case Instruction::ADD_I_VX: out += Format("\t\tm.I += m.V[0x%X];\n", x); break;
+				case Instruction::LD_F_VX: out += Format("\t\tm.I = 5 * m.V[0x%X];\n", x); break;
+				case Instruction::LD_VX_DT: out += Format("\t\tm.V[0x%X] = m.DelayTimer;\n", x); break;
+				case Instruction::RND_VX_BYTE: out += Format("\t\tm.V[0x%X] = StaticRuntime::RandomByte(m) & 0x%02X;\n", x, nn); break;
+				// the shift source depends on the quirk profile, which is only known when the ROM runs
+				case Instruction::SHR_VX_VY:
+				case Instruction::SHL_VX_VY:
+				case Instruction::CLS:
+				case Instruction::LD_DT_VX:
+				case Instruction::LD_ST_VX:
+				case Instruction::LD_VX_I:
+					out += Format("\t\tStaticRuntime::Execute(m, 0x%04X);\n", opcode);
+					break;
+
+				case Instruction::JP:
+					out += Format("\t\tm.PC = 0x%03X;\n\t\treturn OpcodeStatus::NotIncrementPC;\n", nnn);
+					break;
+				case Instruction::SE_VX_BYTE: out += EmitSkip(Format("m.V[0x%X] == 0x%02X", x, nn).c_str(), address); break;
+				case Instruction::SNE_VX_BYTE: out += EmitSkip(Format("m.V[0x%X] != 0x%02X", x, nn).c_str(), address); break;
+				case Instruction::SE_VX_VY: out += EmitSkip(Format("m.V[0x%X] == m.V[0x%X]", x, y).c_str(), address); break;
+				case Instruction::SNE_VX_VY: out += EmitSkip(Format("m.V[0x%X] != m.V[0x%X]", x, y).c_str(), address); break;
+				case Instruction::SKP_VX: out += EmitSkip(Format("StaticRuntime::IsKeyPressed(m, m.V[0x%X])", x).c_str(), address); break;
+				case Instruction::SKNP_VX: out += EmitSkip(Format("!StaticRuntime::IsKeyPressed(m, m.V[0x%X])", x).c_str(), address); break;
+				default:
+					// CALL, RET, JP V0, DRW, FX0A, the memory writes and invalid opcodes
+					out += Format("\t\treturn StaticRuntime::Terminate(m, 0x%03X, 0x%04X);\n", address, opcode);
+					break;
+				}
+				address += 2;
+			}
+
+			if (!block.terminated)
+			{
+				out += Format("\t\tm.PC = 0x%03X;\n\t\treturn OpcodeStatus::NotIncrementPC;\n", address);
+			}
+			out += "\t}\n";
+		}
+
+	private:
+		const std::vector<uint8_t>& Rom;
+		// ordered, so the output is stable between runs
+		std::map<uint16_t, RecoveredBlock> Blocks;
+	};
+
+	bool IsIdentifier(const std::string& name)
+	{
+		if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+			return false;
+		for (const char c : name)
+		{
+			if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+				return false;
+		}
+		return true;
+	}
+}
+
+// usage: Chip8Aot rom_path output_path name
+int main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		printf("usage: Chip8Aot rom_path output_path name\n");
+		return -1;
+	}
+
+	const std::string name = argv[3];
+	if (!IsIdentifier(name))
+	{
+		printf("%s is not a valid C++ identifier\n", name.c_str());
+		return -1;
+	}
+
+	std::ifstream rom_file(argv[1], std::ios::binary);
+	const std::vector<uint8_t> rom((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
+	if (rom.empty() || rom.size() > 0x1000 - RomStart)
+	{
+		printf("unable to read rom %s\n", argv[1]);
+		return -1;
+	}
+
+	Translator translator(rom);
+	translator.RecoverBlocks();
+
+	std::ofstream output(argv[2], std::ios::binary);
+	output << translator.Emit(name);
+	if (!output)
+	{
+		printf("unable to write %s\n", argv[2]);
+		return -1;
+	}
+
+	printf("%s: %zu blocks, %zu instructions translated\n", name.c_str(), translator.GetBlockCount(), translator.GetInstructionCount());
+	return 0;
+}